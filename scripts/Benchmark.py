@@ -12,10 +12,10 @@ MSampleRegex = re.compile(r"\# ([0-9.]+)\/([0-9.]+)\/([0-9.]+)", re.M)
 TempDir = None
 
 
-def bench_exe(exe_path, gpu, args):
+def bench_exe(exe_path, gpu, variant, args):
     tmp_path = os.path.join(TempDir, "_bench.exr")
     call_args = [exe_path, "--spp",
-                 str(args.spp), "--gpu" if gpu else "--cpu", "-o", tmp_path, args.scene]
+                 str(args.spp), "--gpu" if gpu else "--cpu", *variant.split(), "-o", tmp_path, args.scene]
 
     if args.verbose:
         print(call_args)
@@ -132,6 +132,8 @@ if __name__ == "__main__":
                         help="Make logging quiet")
     parser.add_argument('-e', '--executable', action='append',
                         type=str, help="Add executable to benchmark")
+    parser.add_argument('--variant', action='append', type=str,
+                        help="Add set of extra arguments to benchmark against each other, e.g., --variant=\"\" --variant=\"--cpu-wavefront\"")
 
     args = parser.parse_args()
 
@@ -158,6 +160,9 @@ if __name__ == "__main__":
         print("No scene to benchmark given")
         exit(-1)
 
+    if args.variant is None:
+        args.variant = [""]
+
     TempDir = tempfile.mkdtemp()
 
     if not args.quiet:
@@ -166,9 +171,9 @@ if __name__ == "__main__":
 
             count = 0
             if not args.no_cpu:
-                count += len(args.executable) * (args.w + args.n)
+                count += len(args.executable) * len(args.variant) * (args.w + args.n)
             if not args.no_gpu:
-                count += len(args.executable) * (args.w + args.n)
+                count += len(args.executable) * len(args.variant) * (args.w + args.n)
 
             progress = tqdm.tqdm(total=count)
         except ImportError:
@@ -186,23 +191,24 @@ if __name__ == "__main__":
             if gpu == 1 and args.no_gpu:
                 continue
 
-            for _ in range(args.w):
-                bench_exe(exe, gpu == 1, args)  # Ignore output
-                if progress is not None:
-                    progress.update()
+            for variant in args.variant:
+                for _ in range(args.w):
+                    bench_exe(exe, gpu == 1, variant, args)  # Ignore output
+                    if progress is not None:
+                        progress.update()
 
-            results = []
-            for _ in range(args.n):
-                results.append(bench_exe(exe, gpu == 1, args))
-                if progress is not None:
-                    progress.update()
+                results = []
+                for _ in range(args.n):
+                    results.append(bench_exe(exe, gpu == 1, variant, args))
+                    if progress is not None:
+                        progress.update()
 
-            avgs = reduce_avg(results)
+                avgs = reduce_avg(results)
 
-            if gpu == 0:
-                table[f"{exe} [CPU] "] = avgs
-            else:
-                table[f"{exe} [GPU] "] = avgs
+                name = f"{exe} [GPU]" if gpu == 1 else f"{exe} [CPU]"
+                if variant:
+                    name += f" {variant}"
+                table[name + " "] = avgs
 
     if progress is not None:
         progress.close
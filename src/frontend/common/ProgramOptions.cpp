@@ -9,6 +9,7 @@ namespace IG {
 static const std::map<std::string, LogLevel> LogLevelMap{ { "fatal", L_FATAL }, { "error", L_ERROR }, { "warning", L_WARNING }, { "info", L_INFO }, { "debug", L_DEBUG } };
 static const std::map<std::string, SPPMode> SPPModeMap{ { "fixed", SPPMode::Fixed }, { "capped", SPPMode::Capped }, { "continuous", SPPMode::Continuous } };
 static const std::map<std::string, RuntimeOptions::SpecializationMode> SpecializationModeMap{ { "default", RuntimeOptions::SpecializationMode::Default }, { "force", RuntimeOptions::SpecializationMode::Force }, { "disable", RuntimeOptions::SpecializationMode::Disable } };
+static const std::map<std::string, RuntimeOptions::BvhQuality> BvhQualityMap{ { "fast", RuntimeOptions::BvhQuality::Fast }, { "balanced", RuntimeOptions::BvhQuality::Balanced }, { "high", RuntimeOptions::BvhQuality::High } };
 
 class MyTransformer : public CLI::Validator {
 public:
@@ -105,11 +106,13 @@ ProgramOptions::ProgramOptions(int argc, char** argv, ApplicationType type, cons
 {
     bool useCPU        = false;
     bool useGPU        = false;
+    bool cpuWavefront  = false;
     uint32 threadCount = 0;
     uint32 vectorWidth = 0;
     uint32 device      = 0;
     std::string gpu_arch;
     std::string cpu_arch;
+    std::string cpu_sort;
 
     Type = type;
 
@@ -157,6 +160,8 @@ ProgramOptions::ProgramOptions(int argc, char** argv, ApplicationType type, cons
     app.add_option("--cpu-arch", cpu_arch, "Explicitly set CPU architecture to use. Only choose a host compatible architecture, else the application will crash")->check(CLI::IsMember(IG::Target::getAvailableCPUArchitectureNames(), CLI::ignore_case));
     app.add_option("--cpu-threads", threadCount, "Number of threads used on a CPU target. Set to 0 to detect automatically")->default_val(threadCount);
     app.add_option("--cpu-vectorwidth", vectorWidth, "Number of vector lanes used on a CPU target. Set to 0 to detect automatically")->default_val(vectorWidth);
+    app.add_option("--cpu-sort", cpu_sort, "Algorithm used to sort rays by material on a CPU target")->check(CLI::IsMember(IG::Target::getAvailableCPURaySortModeNames(), CLI::ignore_case))->default_str("Counting");
+    app.add_flag("--cpu-wavefront", cpuWavefront, "Keep a persistent ray stream per CPU thread which is refilled from the next tile instead of being drained at the end of each tile. Hits too few to fill a vector are shared between the threads via frame-wide material queues");
 
     app.add_option("--spp", SPP, "Number of samples per pixel a frame contains");
     app.add_option("--spi", SPI, "Number of samples per iteration. This is only considered a hint for the underlying technique");
@@ -187,6 +192,7 @@ ProgramOptions::ProgramOptions(int argc, char** argv, ApplicationType type, cons
     app.add_option("--script-dir", ScriptDir, "Override internal script standard library by '.art' files from the given directory");
 
     app.add_option("-O,--shader-optimization", ShaderOptimizationLevel, "Level of optimization applied to shaders. Range is [0, 3]. Level 0 will also add debug information")->default_val(ShaderOptimizationLevel);
+    app.add_flag("--lazy-shaders", LazyShaders, "Compile material shaders on demand the first time a material is hit. Interactive sessions use a generic material in the meantime");
 
     app.add_flag("--add-env-light", AddExtraEnvLight, "Add additional constant environment light. This is automatically done for glTF scenes without any lights");
     app.add_option("--specialization", Specialization, "Set the type of specialization. Force will increase compile time drastically for potential runtime optimization.")->transform(MyTransformer(SpecializationModeMap, CLI::ignore_case))->default_str("default");
@@ -196,6 +202,11 @@ ProgramOptions::ProgramOptions(int argc, char** argv, ApplicationType type, cons
     app.add_flag_callback(
         "--disable-specialization", [&]() { this->Specialization = RuntimeOptions::SpecializationMode::Disable; },
         "Disables specialization for parameters in shading tree. This might decrease compile time drastically for worse runtime optimization");
+    app.add_option("--bvh-quality", BvhBuildQuality, "Set the quality of the bvh of triangular shapes. Fast reduces loading time for worse trace performance. Can be overridden per shape")->transform(MyTransformer(BvhQualityMap, CLI::ignore_case))->default_str("high");
+    app.add_flag("--compress-bvh", CompressBvh, "Quantize the bvh nodes of triangular shapes on the CPU. Reduces memory footprint and bandwidth for slightly more traversal steps");
+    app.add_flag("--compact-entities", CompactEntities, "Store entities with deduplicated transforms only. Reduces memory footprint of scenes with many instances for slightly more work per hit");
+    app.add_option("--texture-cache-budget", TextureCacheBudget, "Memory budget in MiB for image textures on the CPU. Textures are converted into tiles, which are loaded on first use and evicted if the budget is exceeded. Zero keeps all textures resident")->default_val(TextureCacheBudget);
+    app.add_flag("--compress-textures", CompressTextures, "Store 8 bit image textures block compressed (BC1, BC3 or BC4) and float image textures as half floats. Reduces texture memory for a small loss in quality");
 
     if (type != ApplicationType::Trace) {
         if (type == ApplicationType::CLI) {
@@ -218,6 +229,10 @@ ProgramOptions::ProgramOptions(int argc, char** argv, ApplicationType type, cons
     if (type == ApplicationType::Trace) {
         app.add_option("-i,--input", InputRay, "Read list of rays from file instead of the standard input");
         app.add_option("-o,--output", Output, "Write radiance for each ray into file instead of standard output");
+        app.add_flag("--server", Server, "Load the scene once and answer ray batches until the input is closed. Batches and answers are terminated by an empty line. The input might be a named pipe");
+        app.add_flag("--binary", Binary, "Read and write rays in the little-endian binary ray format instead of text. Regular input files are memory-mapped. Logging is disabled when writing to the standard output");
+        app.add_option("--batch-size", BatchSize, "Maximum number of rays traced at once in binary mode")->check(CLI::PositiveNumber);
+        app.add_flag("--output-hits", OutputHits, "Also write the hit distance and entity id of each ray in binary mode. Requires a CPU target");
     } else {
         app.add_option("-o,--output", Output, "Writes the output image to a file");
     }
@@ -384,6 +399,11 @@ ProgramOptions::ProgramOptions(int argc, char** argv, ApplicationType type, cons
 
     if (vectorWidth >= 1)
         Target.setVectorWidth((size_t)vectorWidth);
+
+    if (!cpu_sort.empty())
+        Target.setCPURaySortMode(IG::Target::getCPURaySortModeFromString(cpu_sort));
+
+    Target.setCPUWavefront(cpuWavefront);
 }
 
 void ProgramOptions::populate(RuntimeOptions& options) const
@@ -413,6 +433,12 @@ void ProgramOptions::populate(RuntimeOptions& options) const
 
     options.AddExtraEnvLight = AddExtraEnvLight;
     options.Specialization   = Specialization;
+    options.BvhBuildQuality  = BvhBuildQuality;
+    options.CompressBvh      = CompressBvh;
+    options.CompactEntities  = CompactEntities;
+
+    options.TextureCacheBudget = TextureCacheBudget * 1024 * 1024;
+    options.CompressTextures   = CompressTextures;
 
     options.Denoiser.Enabled            = Denoise;
     options.Denoiser.FollowSpecular     = DenoiserFollowSpecular;
@@ -425,6 +451,7 @@ void ProgramOptions::populate(RuntimeOptions& options) const
 
     options.ScriptDir               = ScriptDir;
     options.ShaderOptimizationLevel = std::min<size_t>(3, ShaderOptimizationLevel);
+    options.LazyShaderCompilation   = LazyShaders;
 
     options.WarnUnused = !NoUnused;
 
@@ -72,6 +72,11 @@ public:
     bool AddExtraEnvLight = false;
 
     RuntimeOptions::SpecializationMode Specialization = RuntimeOptions::SpecializationMode::Default;
+    RuntimeOptions::BvhQuality BvhBuildQuality        = RuntimeOptions::BvhQuality::High;
+    bool CompressBvh                                  = false;
+    bool CompactEntities                              = false;
+    size_t TextureCacheBudget                         = 0; // In MiB
+    bool CompressTextures                             = false;
 
     bool Denoise                    = false;
     bool DenoiserFollowSpecular     = false;
@@ -83,10 +88,15 @@ public:
     Path CacheDir;
 
     size_t ShaderOptimizationLevel = 3;
+    bool LazyShaders               = false;
 
     Path Output;
     Path InputScene;
     Path InputRay;
+    bool Server      = false;   // Only used by igtrace
+    bool Binary      = false;   // Only used by igtrace
+    size_t BatchSize = 1 << 20; // Only used by igtrace
+    bool OutputHits  = false;   // Only used by igtrace
 
     Path ScriptDir;
 
@@ -111,6 +111,41 @@ private:
 };
 
 std::unique_ptr<Runtime> RuntimeWrap::sInstance;
+
+// The input arrays are only read, which allows read-only numpy arrays as well
+using RayArray    = nb::ndarray<const float, nb::shape<nb::any, 3>, nb::c_contig, nb::device::cpu>;
+using RangeArray  = nb::ndarray<const float, nb::shape<nb::any, 2>, nb::c_contig, nb::device::cpu>;
+using OutputArray = nb::ndarray<float, nb::shape<nb::any, 3>, nb::c_contig, nb::device::cpu>;
+
+// The arrays are referenced directly by the device and the GIL is released while tracing, such that other Python threads can prepare the next batch
+static bool trace_arrays(Runtime& r, const RayArray& origins, const RayArray& directions, const float* ranges, size_t rangeStride, OutputArray& output)
+{
+    const size_t count = origins.shape(0);
+    if (directions.shape(0) != count || output.shape(0) != count)
+        throw nb::buffer_error("Incompatible buffer: Expected the same number of rays in all buffers");
+
+    const float* org = origins.data();
+    const float* dir = directions.data();
+
+    RayBatch batch;
+    batch.OriginX     = org + 0;
+    batch.OriginY     = org + 1;
+    batch.OriginZ     = org + 2;
+    batch.DirectionX  = dir + 0;
+    batch.DirectionY  = dir + 1;
+    batch.DirectionZ  = dir + 2;
+    batch.TMin        = ranges + 0;
+    batch.TMax        = ranges + 1;
+    batch.Stride      = 3;
+    batch.RangeStride = rangeStride;
+    batch.Count       = count;
+
+    RayBatchResult result;
+    result.Color = (float*)output.data();
+
+    nb::gil_scoped_release release;
+    return r.trace(batch, result);
+}
 void runtime_module(nb::module_& m)
 {
     // Logger IO stuff
@@ -127,6 +162,15 @@ void runtime_module(nb::module_& m)
         .value("Nvidia", GPUArchitecture::Nvidia)
         .value("Unknown", GPUArchitecture::Unknown);
 
+    nb::enum_<CPURaySortMode>(m, "CPURaySortMode", "Enum holding algorithms to sort rays by material on the CPU")
+        .value("Swap", CPURaySortMode::Swap)
+        .value("Counting", CPURaySortMode::Counting);
+
+    nb::enum_<RuntimeOptions::BvhQuality>(m, "BvhQuality", "Enum holding presets trading bvh build time against trace performance")
+        .value("Fast", RuntimeOptions::BvhQuality::Fast)
+        .value("Balanced", RuntimeOptions::BvhQuality::Balanced)
+        .value("High", RuntimeOptions::BvhQuality::High);
+
     nb::class_<Target>(m, "Target", "Target specification the runtime is using")
         .def(nb::init<>())
         .def_prop_ro("IsValid", &Target::isValid)
@@ -137,6 +181,8 @@ void runtime_module(nb::module_& m)
         .def_prop_rw("Device", &Target::device, &Target::setDevice)
         .def_prop_rw("VectorWidth", &Target::vectorWidth, &Target::setVectorWidth)
         .def_prop_rw("ThreadCount", &Target::threadCount, &Target::setThreadCount)
+        .def_prop_rw("CPURaySortMode", &Target::cpuRaySortMode, &Target::setCPURaySortMode)
+        .def_prop_rw("CPUWavefront", &Target::useCPUWavefront, &Target::setCPUWavefront)
         .def("toString", &Target::toString)
         .def("__str__", &Target::toString)
         .def_static("makeGeneric", &Target::makeGeneric)
@@ -160,6 +206,12 @@ void runtime_module(nb::module_& m)
         .def_rw("OverrideTechnique", &RuntimeOptions::OverrideTechnique, "Type of technique to use instead of the one used by the scene")
         .def_rw("OverrideFilmSize", &RuntimeOptions::OverrideFilmSize, "Type of film size to use instead of the one used by the scene")
         .def_rw("EnableTonemapping", &RuntimeOptions::EnableTonemapping, "Set True if any of the two tonemapping functions ``tonemap`` and ``imageinfo`` is to be used")
+        .def_rw("LazyShaderCompilation", &RuntimeOptions::LazyShaderCompilation, "Set True if material shaders should be compiled on demand the first time a material is hit")
+        .def_rw("BvhBuildQuality", &RuntimeOptions::BvhBuildQuality, "Quality of the bvh of triangular shapes. Can be overridden per shape")
+        .def_rw("CompressBvh", &RuntimeOptions::CompressBvh, "Set True to quantize the bvh nodes of triangular shapes on the CPU to reduce the memory footprint")
+        .def_rw("CompactEntities", &RuntimeOptions::CompactEntities, "Set True to store entities with deduplicated transforms only to reduce the memory footprint of scenes with many instances")
+        .def_rw("TextureCacheBudget", &RuntimeOptions::TextureCacheBudget, "Bytes of image texture tiles kept resident on the CPU. Zero keeps all textures resident as a whole")
+        .def_rw("CompressTextures", &RuntimeOptions::CompressTextures, "Set True to store 8 bit image textures block compressed and float image textures as half floats to reduce texture memory")
         .def_rw("WarnUnused", &RuntimeOptions::WarnUnused, "Set False if you want to ignore warnings about unused property entries");
 
     nb::class_<Ray>(m, "Ray", "Single ray traced into the scene")
@@ -178,11 +230,36 @@ void runtime_module(nb::module_& m)
     nb::class_<Runtime>(m, "Runtime", "Renderer runtime allowing control of simulation and access to results")
         .def("step", &Runtime::step, nb::arg("ignoreDenoiser") = false)
         .def("trace", [](Runtime& r, const std::vector<Ray>& rays) {
-            r.trace(rays);
+            if (!r.trace(rays))
+                throw std::runtime_error("Could not trace the given rays");
             size_t shape[] = { rays.size(), 3ul };
             return nb::ndarray<nb::numpy, float, nb::shape<nb::any, 3>>(r.getFramebufferForHost({}).Data, 2, shape);
         })
+        .def(
+            "trace", [](Runtime& r, const RayArray& origins, const RayArray& directions, OutputArray& output) {
+                static const float DefaultRange[2] = { 0, FltMax };
+                return trace_arrays(r, origins, directions, DefaultRange, 0, output);
+            },
+            "origins"_a, "directions"_a, "output"_a,
+            "Trace the rays given as (N,3) arrays without copying them and write the accumulated radiance into the (N,3) output array. The GIL is released while tracing")
+        .def(
+            "trace", [](Runtime& r, const RayArray& origins, const RayArray& directions, const RangeArray& ranges, OutputArray& output) {
+                if (ranges.shape(0) != origins.shape(0))
+                    throw nb::buffer_error("Incompatible buffer: Expected the same number of rays in all buffers");
+                return trace_arrays(r, origins, directions, ranges.data(), 2, output);
+            },
+            "origins"_a, "directions"_a, "ranges"_a, "output"_a,
+            "Trace the rays given as (N,3) arrays with (N,2) ranges (tmin, tmax) without copying them and write the accumulated radiance into the (N,3) output array. The GIL is released while tracing")
         .def("reset", &Runtime::reset)
+        .def(
+            "updateEntityTransforms", [](Runtime& r, const std::vector<std::pair<std::string, Matrix4f>>& transforms) {
+                std::vector<std::pair<std::string, Transformf>> list;
+                list.reserve(transforms.size());
+                for (const auto& p : transforms)
+                    list.emplace_back(p.first, Transformf(p.second));
+                return r.updateEntityTransforms(list);
+            },
+            "transforms"_a, "Update the transforms of the entities given as list of (name, 4x4 matrix) pairs without reloading the scene. Emissive entities can not be updated")
         .def(
             "getFramebufferForHost", [](const Runtime& r, const std::string& aov) {
                 const size_t width  = r.framebufferWidth();
@@ -0,0 +1,233 @@
+#include "BinaryRayFile.h"
+#include "Logger.h"
+
+#include <cstring>
+#include <filesystem>
+
+#ifdef IG_OS_WINDOWS
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+namespace IG {
+constexpr uint32 InputMagic      = 0x49524749; // "IGRI"
+constexpr uint32 OutputMagic     = 0x4F524749; // "IGRO"
+constexpr uint16 CurrentVersion  = 1;
+constexpr uint32 InputRecordSize = 8;
+
+static inline bool isLittleEndian()
+{
+    const uint32 value = 1;
+    uint8 first;
+    std::memcpy(&first, &value, 1);
+    return first == 1;
+}
+
+static inline void setBinaryMode(FILE* file)
+{
+#ifdef IG_OS_WINDOWS
+    _setmode(_fileno(file), _O_BINARY);
+#else
+    IG_UNUSED(file);
+#endif
+}
+
+BinaryRayReader::BinaryRayReader()
+    : mHeader()
+    , mStream(nullptr)
+    , mCursor(0)
+{
+}
+
+bool BinaryRayReader::open(const Path& path)
+{
+    if (!isLittleEndian()) {
+        IG_LOG(L_ERROR) << "Binary ray files are only supported on little-endian hosts" << std::endl;
+        return false;
+    }
+
+    mCursor = 0;
+
+    std::error_code ec;
+    if (!path.empty() && std::filesystem::is_regular_file(path, ec)) {
+        if (!mMapping.open(path)) {
+            IG_LOG(L_ERROR) << "Could not map " << path << std::endl;
+            return false;
+        }
+
+        if (mMapping.size() < sizeof(BinaryRayHeader)) {
+            IG_LOG(L_ERROR) << "Binary ray file " << path << " has no header" << std::endl;
+            return false;
+        }
+        std::memcpy(&mHeader, mMapping.data(), sizeof(BinaryRayHeader));
+    } else {
+        if (path.empty()) {
+            setBinaryMode(stdin);
+            mStream = &std::cin;
+        } else {
+            mFile.open(path, std::ios::in | std::ios::binary);
+            if (!mFile) {
+                IG_LOG(L_ERROR) << "Could not open " << path << std::endl;
+                return false;
+            }
+            mStream = &mFile;
+        }
+
+        if (!mStream->read(reinterpret_cast<char*>(&mHeader), sizeof(BinaryRayHeader))) {
+            IG_LOG(L_ERROR) << "Binary ray input has no header" << std::endl;
+            return false;
+        }
+    }
+
+    if (mHeader.Magic != InputMagic || mHeader.Version != CurrentVersion) {
+        IG_LOG(L_ERROR) << "Binary ray input has an unknown magic number or version" << std::endl;
+        return false;
+    }
+
+    if (mHeader.RecordSize != InputRecordSize || mHeader.Layout > (uint16)BinaryRayLayout::SoA) {
+        IG_LOG(L_ERROR) << "Binary ray input has an invalid record layout" << std::endl;
+        return false;
+    }
+
+    if (mMapping.isValid()) {
+        const size_t expected = sizeof(BinaryRayHeader) + mHeader.Count * mHeader.RecordSize * sizeof(float);
+        if (mMapping.size() < expected) {
+            IG_LOG(L_ERROR) << "Binary ray file " << path << " is truncated. Expected " << expected << " bytes but got " << mMapping.size() << std::endl;
+            return false;
+        }
+    } else if (mHeader.Layout == (uint16)BinaryRayLayout::SoA) {
+        IG_LOG(L_ERROR) << "Binary ray input with SoA layout has to be a regular file" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool BinaryRayReader::next(size_t maxCount, RayBatch& batch)
+{
+    if (mCursor >= mHeader.Count)
+        return false;
+
+    const size_t count = std::min<size_t>(maxCount, mHeader.Count - mCursor);
+
+    const float* base = nullptr;
+    size_t stride     = mHeader.RecordSize; // Distance between two rays
+    size_t pitch      = 1;                  // Distance between two components of a ray
+    if (mMapping.isValid()) {
+        const float* data = reinterpret_cast<const float*>(mMapping.data() + sizeof(BinaryRayHeader));
+        if (mHeader.Layout == (uint16)BinaryRayLayout::AoS) {
+            base = data + mCursor * mHeader.RecordSize;
+        } else {
+            base   = data + mCursor;
+            stride = 1;
+            pitch  = mHeader.Count;
+        }
+    } else {
+        mBuffer.resize(count * mHeader.RecordSize);
+        if (!mStream->read(reinterpret_cast<char*>(mBuffer.data()), mBuffer.size() * sizeof(float))) {
+            IG_LOG(L_ERROR) << "Binary ray input is truncated after " << mCursor << " rays" << std::endl;
+            return false;
+        }
+        base = mBuffer.data();
+    }
+
+    batch.OriginX     = base + 0 * pitch;
+    batch.OriginY     = base + 1 * pitch;
+    batch.OriginZ     = base + 2 * pitch;
+    batch.DirectionX  = base + 3 * pitch;
+    batch.DirectionY  = base + 4 * pitch;
+    batch.DirectionZ  = base + 5 * pitch;
+    batch.TMin        = base + 6 * pitch;
+    batch.TMax        = base + 7 * pitch;
+    batch.Stride      = stride;
+    batch.RangeStride = stride;
+    batch.Count       = count;
+
+    mCursor += count;
+    return true;
+}
+
+BinaryRayWriter::BinaryRayWriter()
+    : mHeader()
+    , mStream(nullptr)
+    , mCursor(0)
+{
+}
+
+uint32 BinaryRayWriter::recordSize(uint32 fields)
+{
+    return ((fields & BRF_Color) ? 3 : 0) + ((fields & BRF_Distance) ? 1 : 0) + ((fields & BRF_EntityID) ? 1 : 0);
+}
+
+bool BinaryRayWriter::open(const Path& path, BinaryRayLayout layout, uint32 fields, size_t count)
+{
+    if (!isLittleEndian()) {
+        IG_LOG(L_ERROR) << "Binary ray files are only supported on little-endian hosts" << std::endl;
+        return false;
+    }
+
+    mHeader.Magic      = OutputMagic;
+    mHeader.Version    = CurrentVersion;
+    mHeader.Layout     = (uint16)layout;
+    mHeader.Fields     = fields;
+    mHeader.RecordSize = recordSize(fields);
+    mHeader.Count      = count;
+    mCursor            = 0;
+
+    if (path.empty()) {
+        // The SoA layout is written component by component, which requires seeking
+        if (layout == BinaryRayLayout::SoA) {
+            IG_LOG(L_ERROR) << "Binary ray output with SoA layout requires an output file" << std::endl;
+            return false;
+        }
+
+        setBinaryMode(stdout);
+        mStream = &std::cout;
+    } else {
+        mFile.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!mFile) {
+            IG_LOG(L_ERROR) << "Could not open " << path << std::endl;
+            return false;
+        }
+        mStream = &mFile;
+    }
+
+    mStream->write(reinterpret_cast<const char*>(&mHeader), sizeof(BinaryRayHeader));
+    return mStream->good();
+}
+
+bool BinaryRayWriter::write(const float* color, const float* distance, const int32* entityID, size_t count, float colorScale)
+{
+    IG_ASSERT(mCursor + count <= mHeader.Count, "Expected not more rays than announced in the header");
+
+    const size_t recordSize = mHeader.RecordSize;
+    const bool isAoS        = mHeader.Layout == (uint16)BinaryRayLayout::AoS;
+    const auto index        = [&](size_t component, size_t i) { return isAoS ? i * recordSize + component : component * count + i; };
+
+    mBuffer.resize(count * recordSize);
+    for (size_t i = 0; i < count; ++i) {
+        size_t component = 0;
+        if (mHeader.Fields & BRF_Color) {
+            for (size_t c = 0; c < 3; ++c)
+                mBuffer[index(component++, i)] = color[3 * i + c] * colorScale;
+        }
+        if (mHeader.Fields & BRF_Distance)
+            mBuffer[index(component++, i)] = distance[i];
+        if (mHeader.Fields & BRF_EntityID)
+            std::memcpy(&mBuffer[index(component++, i)], &entityID[i], sizeof(int32));
+    }
+
+    if (isAoS) {
+        mStream->write(reinterpret_cast<const char*>(mBuffer.data()), mBuffer.size() * sizeof(float));
+    } else {
+        for (size_t component = 0; component < recordSize; ++component) {
+            mStream->seekp(sizeof(BinaryRayHeader) + (component * mHeader.Count + mCursor) * sizeof(float));
+            mStream->write(reinterpret_cast<const char*>(&mBuffer[component * count]), count * sizeof(float));
+        }
+    }
+
+    mCursor += count;
+    mStream->flush();
+    return mStream->good();
+}
+} // namespace IG
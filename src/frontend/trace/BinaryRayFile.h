@@ -0,0 +1,83 @@
+#pragma once
+
+#include "RuntimeStructs.h"
+#include "serialization/MappedFile.h"
+
+#include <fstream>
+
+namespace IG {
+/// Layout of the records in a binary ray file
+enum class BinaryRayLayout : uint16 {
+    AoS = 0, // All components of a ray are stored consecutively
+    SoA = 1  // Every component is stored in its own array of Count entries
+};
+
+/// Components stored per ray in a binary output file
+enum BinaryRayField : uint32 {
+    BRF_Color    = 0x1, // Three floats
+    BRF_Distance = 0x2, // One float, infinity if missed
+    BRF_EntityID = 0x4  // One int32, -1 if missed
+};
+
+/// Header in front of a binary ray file. Everything, including the following records, is stored in little-endian.
+/// Input records consist of eight float32 components: origin, direction, tmin and tmax.
+/// Output records consist of the components given by Fields, in the order of the BinaryRayField bits
+struct BinaryRayHeader {
+    uint32 Magic;
+    uint16 Version;
+    uint16 Layout;     // BinaryRayLayout
+    uint32 Fields;     // BinaryRayField mask, only used for output
+    uint32 RecordSize; // Number of 4 byte components per ray
+    uint64 Count;
+};
+static_assert(sizeof(BinaryRayHeader) == 24, "Expected binary ray header to be tightly packed");
+
+/// Reads a binary ray file in bounded chunks.
+/// Regular files are memory-mapped and the returned batches reference the mapping directly.
+/// Other inputs, like the standard input or named pipes, are read chunk by chunk into an internal buffer, which only supports the AoS layout
+class BinaryRayReader {
+public:
+    BinaryRayReader();
+
+    /// @brief Open the given file or the standard input if the path is empty and read the header
+    bool open(const Path& path);
+
+    /// @brief Get the next chunk with at most maxCount rays. The batch stays valid until the next call
+    /// @return False if no rays are left or the input is truncated
+    bool next(size_t maxCount, RayBatch& batch);
+
+    [[nodiscard]] inline const BinaryRayHeader& header() const { return mHeader; }
+    [[nodiscard]] inline bool isFinished() const { return mCursor >= mHeader.Count; }
+
+private:
+    BinaryRayHeader mHeader;
+    MappedFile mMapping;
+    std::ifstream mFile;
+    std::istream* mStream;
+    std::vector<float> mBuffer;
+    size_t mCursor;
+};
+
+/// Writes binary ray results in chunks to a file or the standard output. The SoA layout requires a file
+class BinaryRayWriter {
+public:
+    BinaryRayWriter();
+
+    /// @brief Open the given file or the standard output if the path is empty and write the header for count rays
+    bool open(const Path& path, BinaryRayLayout layout, uint32 fields, size_t count);
+
+    /// @brief Write the next chunk. Arrays of fields not requested in open() are ignored
+    /// @param color Three floats per ray, scaled by colorScale before writing
+    bool write(const float* color, const float* distance, const int32* entityID, size_t count, float colorScale);
+
+    /// @brief Number of 4 byte components per ray for the given field mask
+    static uint32 recordSize(uint32 fields);
+
+private:
+    BinaryRayHeader mHeader;
+    std::ofstream mFile;
+    std::ostream* mStream;
+    std::vector<float> mBuffer;
+    size_t mCursor;
+};
+} // namespace IG
@@ -1,10 +1,13 @@
+#include "BinaryRayFile.h"
 #include "Logger.h"
 #include "ProgramOptions.h"
 #include "Runtime.h"
 #include "config/Build.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iterator>
+#include <limits>
 #include <sstream>
 
 #ifndef IG_OS_WINDOWS
@@ -13,7 +16,8 @@
 
 using namespace IG;
 
-static std::vector<Ray> read_input(std::istream& is, bool print_prefix)
+// If valid is given, an entry is added for every non-empty line, such that invalid lines can be answered as well
+static std::vector<Ray> read_input(std::istream& is, bool print_prefix, bool report_invalid, std::vector<bool>* valid = nullptr)
 {
     std::vector<Ray> rays;
     while (true) {
@@ -32,8 +36,10 @@ static std::vector<Ray> read_input(std::istream& is, bool print_prefix)
                   std::back_inserter(data));
 
         if (data.size() < 6) {
-            if (&is == &std::cin)
+            if (report_invalid)
                 std::cout << "Invalid input" << std::endl;
+            if (valid)
+                valid->push_back(false);
             continue; // Ignore
         }
 
@@ -52,6 +58,8 @@ static std::vector<Ray> read_input(std::istream& is, bool print_prefix)
             ray.Range(1) = std::numeric_limits<float>::max();
 
         rays.push_back(ray);
+        if (valid)
+            valid->push_back(true);
 
         if (is.eof())
             break;
@@ -66,6 +74,201 @@ static void write_output(std::ostream& is, const float* data, size_t count, size
         is << std::scientific << data[3 * i + 0] / spp << "\t" << data[3 * i + 1] / spp << "\t" << data[3 * i + 2] / spp << std::endl;
 }
 
+// Invalid rays are answered with a placeholder, such that every input line gets exactly one output line
+static void write_output(std::ostream& is, const float* data, const std::vector<bool>& valid, size_t spp)
+{
+    constexpr float NaN = std::numeric_limits<float>::quiet_NaN();
+
+    size_t k = 0;
+    for (bool v : valid) {
+        if (v) {
+            write_output(is, data + 3 * k, 1, spp);
+            ++k;
+        } else {
+            is << std::scientific << NaN << "\t" << NaN << "\t" << NaN << std::endl;
+        }
+    }
+}
+
+static std::unique_ptr<Runtime> setup_runtime(const ProgramOptions& cmd, RuntimeOptions opts, size_t count)
+{
+    opts.OverrideFilmSize = { (uint32)count, 1 };
+
+    std::unique_ptr<Runtime> runtime;
+    try {
+        runtime = std::make_unique<Runtime>(opts);
+    } catch (const std::exception& e) {
+        IG_LOG(L_ERROR) << e.what() << std::endl;
+        return nullptr;
+    }
+
+    if (!runtime->loadFromFile(cmd.InputScene)) {
+        IG_LOG(L_ERROR) << "Could not load " << cmd.InputScene << std::endl;
+        return nullptr;
+    }
+
+    runtime->mergeParametersFrom(cmd.UserEntries);
+    return runtime;
+}
+
+static size_t desired_iterations(const Runtime& runtime, const ProgramOptions& cmd)
+{
+    const size_t SPI          = runtime.samplesPerIteration();
+    const size_t desired_iter = std::max<size_t>(1, static_cast<size_t>(std::ceil(cmd.SPP.value_or(1) / (float)SPI)));
+
+    if (cmd.SPP.has_value() && (cmd.SPP.value() % SPI) != 0)
+        IG_LOG(L_WARNING) << "Given spp " << cmd.SPP.value() << " is not a multiple of the spi " << SPI << ". Using spp " << desired_iter * SPI << " instead" << std::endl;
+
+    return desired_iter;
+}
+
+static bool trace_rays(Runtime& runtime, const ProgramOptions& cmd, const std::vector<Ray>& rays, std::ostream& output, const std::vector<bool>* valid = nullptr)
+{
+    const size_t desired_iter = desired_iterations(runtime, cmd);
+
+    // The framebuffer accumulates all iterations
+    std::vector<float> data;
+    for (size_t iter = 0; iter < desired_iter; ++iter) {
+        if (!runtime.trace(rays, data))
+            return false;
+    }
+
+    if (data.size() != rays.size() * 3) {
+        IG_LOG(L_FATAL) << "Got trace output size " << data.size() << " but expected " << rays.size() * 3 << std::endl;
+        return false;
+    }
+
+    if (valid)
+        write_output(output, data.data(), *valid, runtime.currentIterationCount());
+    else
+        write_output(output, data.data(), rays.size(), runtime.currentIterationCount());
+    return true;
+}
+
+// Keeps the runtime, and therefore the scene and the compiled shaders, alive between batches
+static int run_server(const ProgramOptions& cmd, const RuntimeOptions& opts)
+{
+    std::ifstream file;
+    if (!cmd.InputRay.empty()) {
+        file.open(cmd.InputRay);
+        if (!file) {
+            IG_LOG(L_ERROR) << "Could not open " << cmd.InputRay << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    std::istream& input = cmd.InputRay.empty() ? std::cin : file;
+
+    std::ofstream outputFile;
+    if (!cmd.Output.empty())
+        outputFile.open(cmd.Output);
+    std::ostream& output = cmd.Output.empty() ? std::cout : outputFile;
+
+    std::unique_ptr<Runtime> runtime;
+    while (input) {
+        std::vector<bool> valid;
+        const std::vector<Ray> rays = read_input(input, false, false, &valid);
+        if (rays.empty()) {
+            if (!input && valid.empty())
+                break;
+            // Answer empty batches and batches without any valid ray to stay in sync with the client
+            write_output(output, nullptr, valid, 1);
+            output << std::endl;
+            output.flush();
+            continue;
+        }
+
+        if (!runtime) {
+            runtime = setup_runtime(cmd, opts, rays.size());
+            if (!runtime)
+                return EXIT_FAILURE;
+        } else if (runtime->framebufferWidth() != rays.size()) {
+            runtime->resizeFramebuffer(rays.size(), 1); // Also resets the runtime
+        } else {
+            runtime->reset();
+        }
+
+        if (!trace_rays(*runtime, cmd, rays, output, &valid))
+            return EXIT_FAILURE;
+
+        // An empty line terminates the answer
+        output << std::endl;
+        output.flush();
+    }
+
+    return EXIT_SUCCESS;
+}
+
+// Rays are processed in chunks of bounded size, therefore the input might be larger than the available memory
+static int run_binary(const ProgramOptions& cmd, const RuntimeOptions& opts)
+{
+    // Logging would corrupt the binary output
+    if (cmd.Output.empty())
+        IG_LOGGER.setQuiet(true);
+
+    BinaryRayReader reader;
+    if (!reader.open(cmd.InputRay))
+        return EXIT_FAILURE;
+
+    const size_t total  = reader.header().Count;
+    const uint32 fields = BRF_Color | (cmd.OutputHits ? (BRF_Distance | BRF_EntityID) : 0);
+
+    BinaryRayWriter writer;
+    if (!writer.open(cmd.Output, (BinaryRayLayout)reader.header().Layout, fields, total))
+        return EXIT_FAILURE;
+
+    if (total == 0)
+        return EXIT_SUCCESS;
+
+    const size_t batch_size = std::min(cmd.BatchSize, total);
+    const auto runtime      = setup_runtime(cmd, opts, batch_size);
+    if (!runtime)
+        return EXIT_FAILURE;
+
+    const size_t desired_iter = desired_iterations(*runtime, cmd);
+
+    std::vector<float> color(batch_size * 3);
+    std::vector<float> distance(cmd.OutputHits ? batch_size : 0);
+    std::vector<int32> entity(cmd.OutputHits ? batch_size : 0);
+
+    bool first_batch = true;
+    RayBatch rays;
+    while (reader.next(batch_size, rays)) {
+        if (runtime->framebufferWidth() != rays.Count)
+            runtime->resizeFramebuffer(rays.Count, 1); // Also resets the runtime
+        else if (!first_batch)
+            runtime->reset();
+        first_batch = false;
+
+        // On the CPU the iterations are accumulated directly into the color buffer, otherwise the framebuffer is copied after the last one
+        const bool accumulate = !runtime->target().isGPU();
+        if (accumulate)
+            std::fill_n(color.begin(), rays.Count * 3, 0.0f);
+
+        for (size_t iter = 0; iter < desired_iter; ++iter) {
+            RayBatchResult result;
+            result.Color           = accumulate || iter + 1 == desired_iter ? color.data() : nullptr;
+            result.AccumulateColor = accumulate;
+            if (!runtime->trace(rays, result))
+                return EXIT_FAILURE;
+        }
+
+        if (cmd.OutputHits) {
+            RayBatchResult hits;
+            hits.Distance = distance.data();
+            hits.EntityID = entity.data();
+            if (!runtime->trace(rays, hits, RayBatchMode::IntersectOnly))
+                return EXIT_FAILURE;
+        }
+
+        if (!writer.write(color.data(), distance.data(), entity.data(), rays.Count, 1.0f / runtime->currentIterationCount())) {
+            IG_LOG(L_ERROR) << "Could not write binary ray output" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    return reader.isFinished() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
 int main(int argc, char** argv)
 {
     ProgramOptions cmd(argc, argv, ApplicationType::Trace, "Command Line Tracer");
@@ -80,6 +283,17 @@ int main(int argc, char** argv)
     opts.SPI      = 1;
     opts.IsTracer = true;
 
+    if (cmd.Binary) {
+        if (cmd.Server) {
+            IG_LOG(L_ERROR) << "Binary ray input can not be combined with the server mode" << std::endl;
+            return EXIT_FAILURE;
+        }
+        return run_binary(cmd, opts);
+    }
+
+    if (cmd.Server)
+        return run_server(cmd, opts);
+
     if (!cmd.Quiet)
         std::cout << Build::getCopyrightString() << std::endl;
 
@@ -94,10 +308,10 @@ int main(int argc, char** argv)
     while (true) {
         std::vector<Ray> rays;
         if (isInteractive) {
-            rays = read_input(std::cin, isAtty);
+            rays = read_input(std::cin, isAtty, true);
         } else {
             std::ifstream stream(cmd.InputRay);
-            rays = read_input(stream, false);
+            rays = read_input(stream, false, false);
         }
 
         if (rays.empty()) {
@@ -106,52 +320,22 @@ int main(int argc, char** argv)
             return EXIT_FAILURE;
         }
 
-        opts.OverrideFilmSize = { (uint32)rays.size(), 1 };
-        std::unique_ptr<Runtime> runtime;
-        try {
-            runtime = std::make_unique<Runtime>(opts);
-        } catch (const std::exception& e) {
-            IG_LOG(L_ERROR) << e.what() << std::endl;
-            return EXIT_FAILURE;
-        }
-
-        if (!runtime->loadFromFile(cmd.InputScene)) {
-            IG_LOG(L_ERROR) << "Could not load " << cmd.InputScene << std::endl;
-            return EXIT_FAILURE;
-        }
-
-        runtime->mergeParametersFrom(cmd.UserEntries);
-
-        const size_t SPI          = runtime->samplesPerIteration();
-        const size_t desired_iter = std::max<size_t>(1, static_cast<size_t>(std::ceil(cmd.SPP.value_or(1) / (float)SPI)));
-
-        if (cmd.SPP.has_value() && (cmd.SPP.value() % SPI) != 0)
-            IG_LOG(L_WARNING) << "Given spp " << cmd.SPP.value() << " is not a multiple of the spi " << SPI << ". Using spp " << desired_iter * SPI << " instead" << std::endl;
-
-        std::vector<float> accum_data;
-        std::vector<float> iter_data;
-        for (size_t iter = 0; iter < desired_iter; ++iter) {
-            runtime->trace(rays, iter_data);
-
-            if (accum_data.size() != iter_data.size())
-                accum_data.resize(iter_data.size(), 0.0f);
-            for (size_t i = 0; i < iter_data.size(); ++i)
-                accum_data[i] = iter_data[i];
-        }
-
-        if (accum_data.size() != rays.size() * 3) {
-            IG_LOG(L_FATAL) << "Got trace output size " << accum_data.size() << " but expected " << rays.size() * 3 << std::endl;
+        const auto runtime = setup_runtime(cmd, opts, rays.size());
+        if (!runtime)
             return EXIT_FAILURE;
-        }
 
         // Extract data
+        bool success = false;
         if (cmd.Output.empty()) {
-            write_output(std::cout, accum_data.data(), rays.size(), runtime->currentIterationCount());
+            success = trace_rays(*runtime, cmd, rays, std::cout);
         } else {
             std::ofstream stream(cmd.Output, firstRound ? std::ofstream::out : (std::ofstream::out | std::ofstream::app));
-            write_output(stream, accum_data.data(), rays.size(), runtime->currentIterationCount());
+            success = trace_rays(*runtime, cmd, rays, stream);
         }
 
+        if (!success)
+            return EXIT_FAILURE;
+
         firstRound = false;
         if (!isInteractive || !isAtty)
             break;
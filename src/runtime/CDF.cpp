@@ -39,6 +39,72 @@ void CDF::computeForArray(const std::vector<float>& values, const Path& out)
     serializer.write(cdf, true);
 }
 
+// Vose, M. D. (1991). A linear algorithm for generating random numbers with a given distribution.
+// IEEE Transactions on Software Engineering, 17(9), 972-975. https://doi.org/10.1109/32.92917
+void CDF::computeAliasForArray(const std::vector<float>& values, std::vector<float>& out)
+{
+    constexpr float MinEps = 1e-5f;
+
+    const size_t count = values.size();
+    if (count == 0)
+        return;
+
+    double sum = 0;
+    for (float v : values)
+        sum += std::max(0.0f, v);
+
+    std::vector<float> pdf(count);
+    if (sum > MinEps) {
+        for (size_t i = 0; i < count; ++i)
+            pdf[i] = (float)(std::max(0.0f, values[i]) / sum);
+    } else {
+        std::fill(pdf.begin(), pdf.end(), 1.0f / count);
+    }
+
+    // Scale such that the average bucket is exactly one
+    std::vector<float> scaled(count);
+    std::vector<size_t> small;
+    std::vector<size_t> large;
+    for (size_t i = 0; i < count; ++i) {
+        scaled[i] = pdf[i] * count;
+        if (scaled[i] < 1)
+            small.push_back(i);
+        else
+            large.push_back(i);
+    }
+
+    std::vector<float> threshold(count, 1.0f);
+    std::vector<int32> alias(count);
+    for (size_t i = 0; i < count; ++i)
+        alias[i] = (int32)i;
+
+    while (!small.empty() && !large.empty()) {
+        const size_t l = small.back();
+        small.pop_back();
+        const size_t g = large.back();
+        large.pop_back();
+
+        threshold[l] = scaled[l];
+        alias[l]     = (int32)g;
+
+        scaled[g] = (scaled[g] + scaled[l]) - 1;
+        if (scaled[g] < 1)
+            small.push_back(g);
+        else
+            large.push_back(g);
+    }
+    // Remaining entries are one up to numerical errors and keep their defaults
+
+    const size_t offset = out.size();
+    out.resize(offset + 4 * count);
+    for (size_t i = 0; i < count; ++i) {
+        out[offset + 4 * i + 0] = threshold[i];
+        std::memcpy(&out[offset + 4 * i + 1], &alias[i], sizeof(int32));
+        out[offset + 4 * i + 2] = pdf[i];
+        out[offset + 4 * i + 3] = 0;
+    }
+}
+
 void CDF::computeForImage(const Image& image, const Path& out,
                           size_t& slice_conditional, size_t& slice_marginal,
                           bool premultiplySin, bool compensate)
@@ -6,6 +6,8 @@ namespace IG {
 class CDF {
 public:
     static void computeForArray(const std::vector<float>& values, const Path& out);
+    /// @brief Append an alias table for the given discrete distribution to out. Every entry consists of four floats [threshold, alias (as int32), pdf, unused]
+    static void computeAliasForArray(const std::vector<float>& values, std::vector<float>& out);
     static void computeForImage(const Image& image, const Path& out,
                                 size_t& slice_conditional, size_t& slice_marginal,
                                 bool premultiplySin, bool compensate);
@@ -758,6 +758,56 @@ bool Image::save(const Path& path, const float* data, size_t width, size_t heigh
     }
 }
 
+Image Image::downsample() const
+{
+    IG_ASSERT(isValid(), "Expected a valid image");
+
+    Image img;
+    img.width    = std::max<size_t>(1, width / 2);
+    img.height   = std::max<size_t>(1, height / 2);
+    img.channels = channels;
+    img.pixels.reset(new float[img.width * img.height * channels]);
+
+    // Each destination pixel covers a block of 2x2 source pixels. The last block of odd resolutions covers 3 pixels instead
+    const auto blockRange = [](size_t i, size_t dstSize, size_t srcSize) {
+        const size_t begin = std::min(2 * i, srcSize - 1);
+        const size_t end   = (i + 1 == dstSize) ? srcSize : std::min(2 * i + 2, srcSize);
+        return std::make_pair(begin, end);
+    };
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, img.height), [&](const tbb::blocked_range<size_t>& range) {
+        std::vector<float> sum(channels);
+        for (size_t y = range.begin(); y < range.end(); ++y) {
+            const auto [y0, y1] = blockRange(y, img.height, height);
+            for (size_t x = 0; x < img.width; ++x) {
+                const auto [x0, x1] = blockRange(x, img.width, width);
+
+                std::fill(sum.begin(), sum.end(), 0.0f);
+                for (size_t sy = y0; sy < y1; ++sy) {
+                    for (size_t sx = x0; sx < x1; ++sx) {
+                        for (size_t c = 0; c < channels; ++c)
+                            sum[c] += pixels[(sy * width + sx) * channels + c];
+                    }
+                }
+
+                const float factor = 1.0f / float((y1 - y0) * (x1 - x0));
+                for (size_t c = 0; c < channels; ++c)
+                    img.pixels[(y * img.width + x) * channels + c] = sum[c] * factor;
+            }
+        }
+    });
+
+    return img;
+}
+
+size_t Image::computeMipLevelCount(size_t width, size_t height)
+{
+    size_t levels = 1;
+    for (size_t size = std::max(width, height); size > 1; size /= 2)
+        ++levels;
+    return levels;
+}
+
 Image Image::createSolidImage(const Vector4f& color, size_t width, size_t height)
 {
     Image img;
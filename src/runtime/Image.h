@@ -55,6 +55,13 @@ struct IG_LIB Image {
 
     [[nodiscard]] Vector4f computeAverage() const;
 
+    /// Downsample the image by a factor of two in each dimension with a box filter. The resolution is rounded down, but never below one.
+    /// The last column and row of odd resolutions are merged into their neighbours, such that no pixel is dropped
+    [[nodiscard]] Image downsample() const;
+
+    /// Number of levels of a full mip pyramid for the given resolution, including the full resolution level
+    [[nodiscard]] static size_t computeMipLevelCount(size_t width, size_t height);
+
     enum class FilterMethod {
         Nearest,
         Bilinear,
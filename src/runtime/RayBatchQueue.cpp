@@ -0,0 +1,62 @@
+#include "RayBatchQueue.h"
+
+namespace IG {
+RayBatchQueue::RayBatchQueue()
+    : mRunning(0)
+    , mStop(false)
+{
+    mThread = std::thread([this]() { run(); });
+}
+
+RayBatchQueue::~RayBatchQueue()
+{
+    {
+        std::lock_guard<std::mutex> _guard(mMutex);
+        mStop = true;
+    }
+    mCondition.notify_all();
+    mThread.join();
+}
+
+std::future<bool> RayBatchQueue::submit(Job job)
+{
+    std::packaged_task<bool()> task(std::move(job));
+    auto future = task.get_future();
+    {
+        std::lock_guard<std::mutex> _guard(mMutex);
+        mJobs.emplace_back(std::move(task));
+    }
+    mCondition.notify_one();
+    return future;
+}
+
+size_t RayBatchQueue::pending() const
+{
+    std::lock_guard<std::mutex> _guard(mMutex);
+    return mJobs.size() + mRunning;
+}
+
+void RayBatchQueue::run()
+{
+    while (true) {
+        std::packaged_task<bool()> task;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mCondition.wait(lock, [this]() { return mStop || !mJobs.empty(); });
+
+            // Pending jobs are still processed when stopping, as the caller might wait for them
+            if (mJobs.empty())
+                return;
+
+            task = std::move(mJobs.front());
+            mJobs.pop_front();
+            mRunning = 1;
+        }
+
+        task();
+
+        std::lock_guard<std::mutex> _guard(mMutex);
+        mRunning = 0;
+    }
+}
+} // namespace IG
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "IG_Config.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace IG {
+/// Executes submitted ray batches one after another on a single background thread.
+/// The device can only trace one batch at a time, but the caller is free to prepare or consume other batches in the meantime
+class IG_LIB RayBatchQueue {
+    IG_CLASS_NON_COPYABLE(RayBatchQueue);
+    IG_CLASS_NON_MOVEABLE(RayBatchQueue);
+
+public:
+    using Job = std::function<bool()>;
+
+    RayBatchQueue();
+    /// Waits until all pending jobs are done
+    ~RayBatchQueue();
+
+    /// @brief Submit a job to be executed after all previously submitted jobs
+    /// @return Future containing the result of the job
+    std::future<bool> submit(Job job);
+
+    /// @brief Number of jobs submitted, but not yet finished
+    [[nodiscard]] size_t pending() const;
+
+private:
+    void run();
+
+    mutable std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::deque<std::packaged_task<bool()>> mJobs;
+    size_t mRunning;
+    bool mStop;
+    std::thread mThread;
+};
+} // namespace IG
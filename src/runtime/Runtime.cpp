@@ -3,11 +3,15 @@
 #include "RuntimeInfo.h"
 #include "StringUtils.h"
 #include "loader/LoaderCamera.h"
+#include "loader/LoaderEntity.h"
 #include "loader/Parser.h"
 
 #include <chrono>
 #include <fstream>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 namespace IG {
 
 static inline void setup_technique(LoaderOptions& lopts, const RuntimeOptions& opts)
@@ -97,6 +101,7 @@ Runtime::Runtime(const RuntimeOptions& opts)
     // Configure compiler
     mCompiler.setOptimizationLevel(std::min<size_t>(3, mOptions.ShaderOptimizationLevel));
     mCompiler.setVerbose(IG_LOGGER.verbosity() == L_DEBUG);
+    mCompiler.setTargetName(mOptions.Target.toString());
 
     // Check configuration
     if (!mOptions.Target.isValid())
@@ -117,6 +122,10 @@ Runtime::Runtime(const RuntimeOptions& opts)
     settings.DebugTrace    = mOptions.DebugTrace;
     settings.IsInteractive = mOptions.IsInteractive;
 
+    settings.TextureCacheBudget = mOptions.TextureCacheBudget;
+    if (mOptions.TextureCacheBudget > 0 && !mOptions.Target.isCPU())
+        IG_LOG(L_WARNING) << "Texture cache budget is only supported on the CPU. Textures are kept resident as a whole" << std::endl;
+
     IG_LOG(L_DEBUG) << "Init device" << std::endl;
     mDevice = std::make_unique<Device>(settings);
 }
@@ -202,19 +211,25 @@ bool Runtime::loadFromScene(const Scene* scene)
 bool Runtime::load(const Path& path, const Scene* scene)
 {
     LoaderOptions lopts;
-    lopts.FilePath          = path;
-    lopts.EnableCache       = mOptions.EnableCache;
-    lopts.CachePath         = mOptions.CacheDir.empty() ? (path.parent_path() / ("ignis_cache_" + path.stem().generic_u8string())) : mOptions.CacheDir;
-    lopts.Target            = mOptions.Target;
-    lopts.IsTracer          = mOptions.IsTracer;
-    lopts.Scene             = scene;
-    lopts.Specialization    = mOptions.Specialization;
-    lopts.EnableTonemapping = mOptions.EnableTonemapping;
-    lopts.Denoiser          = mOptions.Denoiser;
-    lopts.Denoiser.Enabled  = !mOptions.IsTracer && mOptions.Denoiser.Enabled && hasDenoiser();
-    lopts.Glare             = mOptions.Glare;
-    lopts.Compiler          = &mCompiler;
-    lopts.Device            = mDevice.get();
+    lopts.FilePath              = path;
+    lopts.EnableCache           = mOptions.EnableCache;
+    lopts.LazyShaderCompilation = mOptions.LazyShaderCompilation;
+    lopts.CachePath             = mOptions.CacheDir.empty() ? (path.parent_path() / ("ignis_cache_" + path.stem().generic_u8string())) : mOptions.CacheDir;
+    lopts.Target                = mOptions.Target;
+    lopts.IsTracer              = mOptions.IsTracer;
+    lopts.Scene                 = scene;
+    lopts.Specialization        = mOptions.Specialization;
+    lopts.BvhBuildQuality       = mOptions.BvhBuildQuality;
+    lopts.CompressBvh           = mOptions.CompressBvh;
+    lopts.CompactEntities       = mOptions.CompactEntities;
+    lopts.TiledTextures         = mOptions.TextureCacheBudget > 0 && mOptions.Target.isCPU();
+    lopts.CompressTextures      = mOptions.CompressTextures;
+    lopts.EnableTonemapping     = mOptions.EnableTonemapping;
+    lopts.Denoiser              = mOptions.Denoiser;
+    lopts.Denoiser.Enabled      = !mOptions.IsTracer && mOptions.Denoiser.Enabled && hasDenoiser();
+    lopts.Glare                 = mOptions.Glare;
+    lopts.Compiler              = &mCompiler;
+    lopts.Device                = mDevice.get();
 
     mHasSceneParameters = !scene->parameters().empty();
 
@@ -261,6 +276,8 @@ bool Runtime::load(const Path& path, const Scene* scene)
     mInitialCameraOrientation = ctx->Camera->getOrientation(*ctx);
     mTechniqueVariants        = std::move(ctx->TechniqueVariants);
     mResourceMap              = ctx->generateResourceMap();
+    mCacheManager             = ctx->CacheManager;
+    mCompiler.setCacheManager(mCacheManager.get());
 
     if (mOptions.Denoiser.Enabled && ctx->Technique->hasDenoiserEnabled())
         mTechniqueInfo.EnabledAOVs.emplace_back("Denoised");
@@ -274,6 +291,9 @@ bool Runtime::load(const Path& path, const Scene* scene)
     // Merge global registry
     mGlobalRegistry.mergeFrom(ctx->GlobalRegistry);
 
+    // Keep timings of the loading phases
+    mLoaderStatistics = ctx->Stats;
+
     // Free memory from loader context
     ctx.reset();
 
@@ -303,6 +323,10 @@ void Runtime::step(bool ignoreDenoiser)
 
     handleTime();
 
+    // Restart the progressive rendering once the actual shaders replaced the fallback shader
+    if (mDevice->consumeLazyShaderUpdates())
+        reset();
+
     if (mTechniqueInfo.VariantSelector) {
         const auto active = mTechniqueInfo.VariantSelector(mCurrentIteration);
 
@@ -346,43 +370,94 @@ void Runtime::stepVariant(bool ignoreDenoiser, size_t variant, bool lastVariant)
         mCurrentSampleCount += settings.spi;
 }
 
-void Runtime::trace(const std::vector<Ray>& rays)
+bool Runtime::trace(const std::vector<Ray>& rays)
+{
+    return trace(RayBatch::fromRays(rays.data(), rays.size()), RayBatchResult{});
+}
+
+bool Runtime::trace(const std::vector<Ray>& rays, std::vector<float>& data)
+{
+    data.resize(rays.size() * 3);
+
+    RayBatchResult result;
+    result.Color = data.data();
+    return trace(RayBatch::fromRays(rays.data(), rays.size()), result);
+}
+
+bool Runtime::trace(const RayBatch& rays, const RayBatchResult& result, RayBatchMode mode)
 {
     if (!mOptions.IsTracer) {
         IG_LOG(L_ERROR) << "Trying to use trace() in a camera driver!" << std::endl;
-        return;
+        return false;
     }
 
     if (mTechniqueVariants.empty()) {
         IG_LOG(L_ERROR) << "No scene loaded!" << std::endl;
-        return;
+        return false;
+    }
+
+    if (mode == RayBatchMode::IntersectOnly && mOptions.Target.isGPU()) {
+        IG_LOG(L_ERROR) << "Intersect-only ray batches are only supported on the CPU!" << std::endl;
+        return false;
     }
 
+    if (rays.Count == 0)
+        return true;
+
+    const bool accumulateColor = mode == RayBatchMode::Shade && result.Color && result.AccumulateColor;
+    if (accumulateColor && (mOptions.Target.isGPU() || rays.Count != mFilmWidth * mFilmHeight)) {
+        IG_LOG(L_ERROR) << "Accumulating the color directly is only supported on the CPU with a batch matching the framebuffer size!" << std::endl;
+        return false;
+    }
+
+    // The directions are normalized by the device, which keeps zero directions as they are instead of producing NaNs
+    size_t zeroDirections = 0;
+    for (size_t i = 0; i < rays.Count; ++i) {
+        const size_t k = i * rays.Stride;
+        if (Vector3f(rays.DirectionX[k], rays.DirectionY[k], rays.DirectionZ[k]).norm() < std::numeric_limits<float>::epsilon())
+            ++zeroDirections;
+    }
+    if (zeroDirections > 0)
+        IG_LOG(L_ERROR) << "Invalid rays given: " << zeroDirections << " rays have zero direction!" << std::endl;
+
+    std::lock_guard<std::mutex> _guard(mTraceMutex);
+
+    // The closest hit does not depend on the technique, therefore the first variant suffices
+    if (mode == RayBatchMode::IntersectOnly) {
+        traceVariant(rays, &result, nullptr, 0);
+        return true;
+    }
+
+    float* film = accumulateColor ? result.Color : nullptr;
+
     handleTime();
 
     if (mTechniqueInfo.VariantSelector) {
         const auto& active = mTechniqueInfo.VariantSelector(mCurrentIteration);
         for (const auto& ind : active)
-            traceVariant(rays, ind);
+            traceVariant(rays, nullptr, film, ind);
     } else {
         for (size_t i = 0; i < mTechniqueVariants.size(); ++i)
-            traceVariant(rays, i);
+            traceVariant(rays, nullptr, film, i);
     }
 
     ++mCurrentIteration;
+
+    if (result.Color && !accumulateColor) {
+        const float* data_ptr = getFramebufferForHost({}).Data;
+        std::memcpy(result.Color, data_ptr, sizeof(float) * 3 * rays.Count);
+    }
+
+    return true;
 }
 
-void Runtime::trace(const std::vector<Ray>& rays, std::vector<float>& data)
+std::future<bool> Runtime::traceAsync(const RayBatch& rays, const RayBatchResult& result, RayBatchMode mode)
 {
-    trace(rays);
-
-    // Get result
-    const float* data_ptr = getFramebufferForHost({}).Data;
-    data.resize(rays.size() * 3);
-    std::memcpy(data.data(), data_ptr, sizeof(float) * data.size());
+    std::call_once(mRayBatchQueueFlag, [&]() { mRayBatchQueue = std::make_unique<RayBatchQueue>(); });
+    return mRayBatchQueue->submit([this, rays, result, mode]() { return trace(rays, result, mode); });
 }
 
-void Runtime::traceVariant(const std::vector<Ray>& rays, size_t variant)
+void Runtime::traceVariant(const RayBatch& rays, const RayBatchResult* hits, float* film, size_t variant)
 {
     IG_ASSERT(variant < mTechniqueVariants.size(), "Expected technique variant to be well selected");
     const auto& info = mTechniqueInfo.Variants[variant];
@@ -390,10 +465,12 @@ void Runtime::traceVariant(const std::vector<Ray>& rays, size_t variant)
     // IG_LOG(L_DEBUG) << "Tracing iteration " << mCurrentIteration << ", variant " << variant << std::endl;
 
     Device::RenderSettings settings;
-    settings.rays      = rays.data();
+    settings.rays      = &rays;
+    settings.hits      = hits;
+    settings.film      = film;
     settings.denoise   = false;
-    settings.spi       = info.GetSPI(mSamplesPerIteration);
-    settings.width     = rays.size();
+    settings.spi       = hits ? 1 : info.GetSPI(mSamplesPerIteration); // A single sample determines the closest hit
+    settings.width     = rays.Count;
     settings.height    = 1;
     settings.info      = info;
     settings.iteration = mCurrentIteration;
@@ -402,7 +479,7 @@ void Runtime::traceVariant(const std::vector<Ray>& rays, size_t variant)
 
     mDevice->render(mTechniqueVariantShaderSets.at(variant), settings, &mGlobalRegistry);
 
-    if (!info.LockFramebuffer)
+    if (!info.LockFramebuffer && !hits)
         mCurrentSampleCount += settings.spi;
 }
 
@@ -442,9 +519,41 @@ void Runtime::reset()
     // No mCurrentFrameCount
 }
 
+bool Runtime::updateEntityTransforms(const std::vector<std::pair<std::string, Transformf>>& transforms)
+{
+    if (mTechniqueVariants.empty()) {
+        IG_LOG(L_ERROR) << "No scene loaded!" << std::endl;
+        return false;
+    }
+
+    if (transforms.empty())
+        return true;
+
+    {
+        // Ray batches traced in the background might still use the old data
+        std::lock_guard<std::mutex> _guard(mTraceMutex);
+
+        const auto sectionClosure = mLoaderStatistics.section(SectionType::EntityUpdate);
+
+        std::vector<uint32> updated;
+        if (!LoaderEntity::updateTransforms(mDatabase, mOptions.Target, transforms, updated))
+            return false;
+
+        mDevice->updateEntities(updated);
+    }
+
+    reset();
+    return true;
+}
+
 const Statistics* Runtime::statistics() const
 {
-    return mOptions.AcquireStats ? mDevice->getStatistics() : nullptr;
+    if (!mOptions.AcquireStats)
+        return nullptr;
+
+    mStatistics = *mDevice->getStatistics();
+    mStatistics.add(mLoaderStatistics);
+    return &mStatistics;
 }
 
 static void dumpRegistries(std::ostream& stream, const std::string& name, const ShaderOutput<void*>& shader)
@@ -482,6 +591,15 @@ bool Runtime::setupScene()
     settings.aov_map             = &mTechniqueInfo.EnabledAOVs;
     settings.resource_map        = &mResourceMap;
     settings.entity_per_material = &mEntityPerMaterial;
+    settings.cache_manager       = mCacheManager;
+
+    if (mOptions.LazyShaderCompilation) {
+        settings.hit_shader_compiler = [this](uint32 variant, uint32 material) {
+            IG_LOG(L_DEBUG) << "Compiling hit shader " << material << " of technique variant " << variant << " on demand" << std::endl;
+            const std::string name = "v" + std::to_string(variant) + "_" + whitespace_escaped("hit shader " + std::to_string(material));
+            return compileShader(mTechniqueVariants.at(variant).HitShaders.at(material).Exec, "ig_hit_shader", name);
+        };
+    }
 
     IG_LOG(L_DEBUG) << "Assign scene to device" << std::endl;
     mDevice->assignScene(settings);
@@ -541,73 +659,101 @@ bool Runtime::setupScene()
 
 bool Runtime::compileShaders()
 {
-    const auto compile = [this](size_t i, const std::string& name, const std::string& func, const ShaderOutput<std::string>& input, ShaderOutput<void*>& output) {
-        IG_LOG(L_DEBUG) << "Compiling " << name << " shader" << std::endl;
-        output.Exec          = compileShader(input.Exec, func, "v" + std::to_string(i) + "_" + whitespace_escaped(name));
-        output.LocalRegistry = input.LocalRegistry;
-        if (output.Exec == nullptr)
-            throw std::runtime_error("Failed to compile " + name + " shader in variant " + std::to_string(i) + ".");
+    struct CompileJob {
+        size_t Variant;
+        std::string Name;
+        std::string Function;
+        const ShaderOutput<std::string>* Input;
+        ShaderOutput<void*>* Output;
+    };
+
+    // Gather all shaders first, such that the (independent) preparation of the shaders can be done in parallel
+    std::vector<CompileJob> jobs;
+    const auto compile = [&](size_t i, const std::string& name, const std::string& func, const ShaderOutput<std::string>& input, ShaderOutput<void*>& output) {
+        jobs.push_back(CompileJob{ i, name, func, &input, &output });
     };
 
     const auto startJIT = std::chrono::high_resolution_clock::now();
 
     mTechniqueVariantShaderSets.resize(mTechniqueVariants.size());
-    try {
-        for (size_t i = 0; i < mTechniqueVariants.size(); ++i) {
-            const auto& variant = mTechniqueVariants[i];
-            auto& shaders       = mTechniqueVariantShaderSets[i];
-            shaders.ID          = (uint32)i;
-
-            IG_LOG(L_DEBUG) << "Handling technique variant " << i << std::endl;
-            compile(i, "device", "ig_callback_shader", variant.DeviceShader, shaders.DeviceShader);
-            if (mOptions.EnableTonemapping) {
-                compile(i, "tonemap", "ig_tonemap_shader", variant.TonemapShader, shaders.TonemapShader);
-                compile(i, "imageinfo", "ig_imageinfo_shader", variant.ImageinfoShader, shaders.ImageinfoShader);
-            }
-            if (mOptions.Glare.Enabled)
-                compile(i, "glare", "ig_glare_shader", variant.GlareShader, shaders.GlareShader);
-            compile(i, "primary traversal", "ig_traversal_shader", variant.PrimaryTraversalShader, shaders.PrimaryTraversalShader);
-            compile(i, "secondary traversal", "ig_traversal_shader", variant.SecondaryTraversalShader, shaders.SecondaryTraversalShader);
-            compile(i, "ray generation", "ig_ray_generation_shader", variant.RayGenerationShader, shaders.RayGenerationShader);
-            compile(i, "miss", "ig_miss_shader", variant.MissShader, shaders.MissShader);
-
-            IG_LOG(L_DEBUG) << "Compiling hit shaders" << std::endl;
+    for (size_t i = 0; i < mTechniqueVariants.size(); ++i) {
+        const auto& variant = mTechniqueVariants[i];
+        auto& shaders       = mTechniqueVariantShaderSets[i];
+        shaders.ID          = (uint32)i;
+
+        compile(i, "device", "ig_callback_shader", variant.DeviceShader, shaders.DeviceShader);
+        if (mOptions.EnableTonemapping) {
+            compile(i, "tonemap", "ig_tonemap_shader", variant.TonemapShader, shaders.TonemapShader);
+            compile(i, "imageinfo", "ig_imageinfo_shader", variant.ImageinfoShader, shaders.ImageinfoShader);
+        }
+        if (mOptions.Glare.Enabled)
+            compile(i, "glare", "ig_glare_shader", variant.GlareShader, shaders.GlareShader);
+        compile(i, "primary traversal", "ig_traversal_shader", variant.PrimaryTraversalShader, shaders.PrimaryTraversalShader);
+        compile(i, "secondary traversal", "ig_traversal_shader", variant.SecondaryTraversalShader, shaders.SecondaryTraversalShader);
+        compile(i, "ray generation", "ig_ray_generation_shader", variant.RayGenerationShader, shaders.RayGenerationShader);
+        compile(i, "miss", "ig_miss_shader", variant.MissShader, shaders.MissShader);
+
+        shaders.HitShaders.resize(variant.HitShaders.size());
+        if (mOptions.LazyShaderCompilation) {
+            // Hit shaders will be compiled by the device the first time a material receives rays
             for (size_t j = 0; j < variant.HitShaders.size(); ++j) {
-                ShaderOutput<void*> result;
-                compile(i, "hit shader " + std::to_string(j), "ig_hit_shader", variant.HitShaders.at(j), result);
-                shaders.HitShaders.push_back(result);
+                shaders.HitShaders[j].Exec          = nullptr;
+                shaders.HitShaders[j].LocalRegistry = variant.HitShaders.at(j).LocalRegistry;
             }
+            compile(i, "fallback hit shader", "ig_hit_shader", variant.FallbackHitShader, shaders.FallbackHitShader);
+        } else {
+            for (size_t j = 0; j < variant.HitShaders.size(); ++j)
+                compile(i, "hit shader " + std::to_string(j), "ig_hit_shader", variant.HitShaders.at(j), shaders.HitShaders[j]);
+        }
 
-            if (!variant.AdvancedShadowHitShaders.empty()) {
-                IG_LOG(L_DEBUG) << "Compiling advanced shadow shaders" << std::endl;
+        if (!variant.AdvancedShadowHitShaders.empty()) {
+            shaders.AdvancedShadowHitShaders.resize(variant.AdvancedShadowHitShaders.size());
+            for (size_t j = 0; j < variant.AdvancedShadowHitShaders.size(); ++j)
+                compile(i, "advanced shadow hit shader " + std::to_string(j), "ig_advanced_shadow_shader", variant.AdvancedShadowHitShaders.at(j), shaders.AdvancedShadowHitShaders[j]);
 
-                for (size_t j = 0; j < variant.AdvancedShadowHitShaders.size(); ++j) {
-                    ShaderOutput<void*> result;
-                    compile(i, "advanced shadow hit shader " + std::to_string(j), "ig_advanced_shadow_shader", variant.AdvancedShadowHitShaders.at(j), result);
-                    shaders.AdvancedShadowHitShaders.push_back(result);
-                }
+            shaders.AdvancedShadowMissShaders.resize(variant.AdvancedShadowMissShaders.size());
+            for (size_t j = 0; j < variant.AdvancedShadowMissShaders.size(); ++j)
+                compile(i, "advanced shadow miss shader " + std::to_string(j), "ig_advanced_shadow_shader", variant.AdvancedShadowMissShaders.at(j), shaders.AdvancedShadowMissShaders[j]);
+        }
 
-                for (size_t j = 0; j < variant.AdvancedShadowMissShaders.size(); ++j) {
-                    ShaderOutput<void*> result;
-                    compile(i, "advanced shadow miss shader " + std::to_string(j), "ig_advanced_shadow_shader", variant.AdvancedShadowMissShaders.at(j), result);
-                    shaders.AdvancedShadowMissShaders.push_back(result);
-                }
-            }
+        for (size_t j = 0; j < variant.CallbackShaders.size(); ++j) {
+            if (variant.CallbackShaders.at(j).Exec.empty())
+                shaders.CallbackShaders[j].Exec = nullptr;
+            else
+                compile(i, "callback " + std::to_string(j), "ig_callback_shader", variant.CallbackShaders.at(j), shaders.CallbackShaders[j]);
+        }
+    }
+
+    const size_t compiledBefore  = mCompiler.compiledCount();
+    const size_t reusedBefore    = mCompiler.reusedCount();
+    const size_t persistedBefore = mCompiler.persistedCount();
 
-            for (size_t j = 0; j < variant.CallbackShaders.size(); ++j) {
-                if (variant.CallbackShaders.at(j).Exec.empty()) {
-                    shaders.CallbackShaders[j].Exec = nullptr;
-                } else {
-                    compile(i, "callback " + std::to_string(j), "ig_callback_shader", variant.CallbackShaders.at(j), shaders.CallbackShaders[j]);
+    // The JIT itself is serialized inside the compiler, but preparation and hashing of the shaders are not.
+    // Identical shaders (e.g., materials with the same structure) are only compiled once.
+    try {
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, jobs.size(), 1),
+            [&](const tbb::blocked_range<size_t>& range) {
+                for (size_t k = range.begin(); k < range.end(); ++k) {
+                    const auto& job = jobs[k];
+                    IG_LOG(L_DEBUG) << "Compiling " << job.Name << " shader of technique variant " << job.Variant << std::endl;
+                    job.Output->Exec          = compileShader(job.Input->Exec, job.Function, "v" + std::to_string(job.Variant) + "_" + whitespace_escaped(job.Name));
+                    job.Output->LocalRegistry = job.Input->LocalRegistry;
+                    if (job.Output->Exec == nullptr)
+                        throw std::runtime_error("Failed to compile " + job.Name + " shader in variant " + std::to_string(job.Variant) + ".");
                 }
-            }
-        }
+            });
     } catch (const std::exception& e) {
         IG_LOG(L_ERROR) << e.what() << std::endl;
         return false;
     }
 
-    IG_LOG(L_DEBUG) << "Compiling shaders took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - startJIT).count() / 1000.0f << " seconds" << std::endl;
+    IG_LOG(L_DEBUG) << "Compiling shaders took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - startJIT).count() / 1000.0f << " seconds"
+                    << " [" << (mCompiler.compiledCount() - compiledBefore) << " compiled, " << (mCompiler.persistedCount() - persistedBefore) << " of them from a previous run, "
+                    << (mCompiler.reusedCount() - reusedBefore) << " reused]" << std::endl;
+
+    if (mCacheManager)
+        mCacheManager->sync();
 
     return true;
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "RayBatchQueue.h"
 #include "RuntimeSettings.h"
 #include "RuntimeStructs.h"
 #include "Statistics.h"
@@ -41,12 +42,28 @@ public:
     /// Do a single iteration in non-tracing mode
     void step(bool ignoreDenoiser = false);
     /// Do a single iteration in tracing mode and return values in data
-    void trace(const std::vector<Ray>& rays, std::vector<float>& data);
-    /// Do a single iteration in tracing mode. Output will be in the framebuffer
-    void trace(const std::vector<Ray>& rays);
+    /// @return False if the rays could not be traced
+    bool trace(const std::vector<Ray>& rays, std::vector<float>& data);
+    /// Do a single iteration in tracing mode. Output will be in the framebuffer, which is resized to the number of rays
+    /// @return False if the rays could not be traced
+    bool trace(const std::vector<Ray>& rays);
+    /// Trace a batch of rays owned by the caller. The framebuffer is resized to the number of rays.
+    /// Nothing is copied besides the color, which is also kept in the framebuffer, unless RayBatchResult::AccumulateColor is set.
+    /// Only the closest hits are computed with RayBatchMode::IntersectOnly, which requires a CPU target and does not advance the iteration
+    /// @return False if the batch could not be traced
+    bool trace(const RayBatch& rays, const RayBatchResult& result, RayBatchMode mode = RayBatchMode::Shade);
+    /// Submit a batch of rays to be traced in the background. Batches are traced one after another in submission order.
+    /// The arrays referenced by rays and result have to stay valid until the returned future is ready
+    [[nodiscard]] std::future<bool> traceAsync(const RayBatch& rays, const RayBatchResult& result, RayBatchMode mode = RayBatchMode::Shade);
     /// Reset internal counters etc. This should be used if data (like camera orientation) has changed. Frame counter will NOT be reset
     void reset();
 
+    /// Update the transforms of the given entities without reloading the scene. Only the scene bvhs are rebuilt, shaders and shape bvhs are kept.
+    /// Emissive entities can not be updated this way. The rendering is reset if successful
+    /// @param transforms Pairs of entity name and new transform
+    /// @return False if an entity is unknown or emissive. Nothing is updated in that case
+    [[nodiscard]] bool updateEntityTransforms(const std::vector<std::pair<std::string, Transformf>>& transforms);
+
     /// A utility function to speed up tonemapping
     /// out_pixels should be of size width*height!
     void tonemap(uint32* out_pixels, const TonemapSettings& settings);
@@ -91,7 +108,7 @@ public:
     /// Increase frame count (only used in interactive/realtime sessions)
     inline void incFrameCount() { mCurrentFrame++; }
 
-    /// Return pointer to structure containing statistics
+    /// Return pointer to structure containing statistics. Timings of the loading process are included
     [[nodiscard]] const Statistics* statistics() const;
 
     /// Returns the name of the loaded technique
@@ -160,7 +177,7 @@ private:
     bool compileShaders();
     void* compileShader(const std::string& src, const std::string& func, const std::string& name);
     void stepVariant(bool ignoreDenoiser, size_t variant, bool lastVariant);
-    void traceVariant(const std::vector<Ray>& rays, size_t variant);
+    void traceVariant(const RayBatch& rays, const RayBatchResult* hits, float* film, size_t variant);
     void handleTime();
 
     const RuntimeOptions mOptions;
@@ -171,6 +188,10 @@ private:
 
     std::unique_ptr<Device> mDevice;
 
+    Statistics mLoaderStatistics;   // Timings of the loading process and later scene updates
+    mutable Statistics mStatistics; // Combination of device and loader statistics returned to the user
+    std::mutex mTraceMutex; // Guards the device while tracing ray batches
+
     size_t mSamplesPerIteration;
 
     size_t mCurrentIteration;
@@ -192,8 +213,13 @@ private:
 
     std::vector<std::string> mResourceMap;
     std::vector<int> mEntityPerMaterial;
+    std::shared_ptr<CacheManager> mCacheManager; // Shared with the device to cache generated resources
 
     std::vector<TechniqueVariant> mTechniqueVariants;
     std::vector<TechniqueVariantShaderSet> mTechniqueVariantShaderSets; // Compiled shaders
+
+    // Declared last, as pending batches have to finish before anything else is destroyed
+    std::once_flag mRayBatchQueueFlag;
+    std::unique_ptr<RayBatchQueue> mRayBatchQueue;
 };
 } // namespace IG
\ No newline at end of file
@@ -39,6 +39,7 @@ struct RuntimeOptions {
     Path CacheDir    = {};
 
     size_t ShaderOptimizationLevel = 3;
+    bool LazyShaderCompilation     = false; // Compile hit shaders on demand the first time a material receives rays
 
     enum class SpecializationMode {
         Default = 0, // Depending on the parameter it will be embedded or not.
@@ -47,6 +48,17 @@ struct RuntimeOptions {
     };
     SpecializationMode Specialization = SpecializationMode::Default;
 
+    enum class BvhQuality {
+        Fast = 0, // Binned SAH without optimization. Fastest build, intended for interactive editing
+        Balanced, // Binned SAH with reinsertion optimization
+        High      // Spatial splits with reinsertion optimization. Slowest build, best trace performance
+    };
+    BvhQuality BvhBuildQuality = BvhQuality::High; // Can be overridden per shape with the 'bvh_quality' property
+    bool CompressBvh           = false;            // Quantize the child bounds of CPU primitive bvhs to 8 bit. Reduces the node memory to a half (4-wide) or three eighths (8-wide)
+    bool CompactEntities       = false;            // Store entities with deduplicated transforms only and derive the inverse and normal matrices on demand
+    size_t TextureCacheBudget  = 0;                // Bytes of image texture tiles kept resident on the CPU. Zero keeps all textures resident as a whole
+    bool CompressTextures      = false;            // Store 8 bit image textures block compressed and float image textures as half floats
+
     bool WarnUnused = true;           // Warn about unused properties. They might indicate a typo or similar.
 
     DenoiserSettings Denoiser;
@@ -2,6 +2,28 @@
 #include <sstream>
 
 namespace IG {
+RayBatch RayBatch::fromRays(const Ray* rays, size_t count)
+{
+    static_assert(sizeof(Ray) % sizeof(float) == 0, "Expected ray to consist of floats only");
+
+    RayBatch batch;
+    if (count == 0)
+        return batch;
+
+    batch.OriginX     = &rays->Origin.x();
+    batch.OriginY     = &rays->Origin.y();
+    batch.OriginZ     = &rays->Origin.z();
+    batch.DirectionX  = &rays->Direction.x();
+    batch.DirectionY  = &rays->Direction.y();
+    batch.DirectionZ  = &rays->Direction.z();
+    batch.TMin        = &rays->Range.x();
+    batch.TMax        = &rays->Range.y();
+    batch.Stride      = sizeof(Ray) / sizeof(float);
+    batch.RangeStride = batch.Stride;
+    batch.Count       = count;
+    return batch;
+}
+
 std::string ParameterSet::dump() const
 {
     std::stringstream stream;
@@ -73,4 +73,43 @@ struct Ray {
     Vector3f Direction;
     Vector2f Range;
 };
+
+/// Rays owned by the caller in structure-of-arrays layout. Entry i of the origin and direction arrays is at index i * Stride,
+/// entry i of the range arrays at index i * RangeStride.
+/// Directions do not have to be normalized, but must not be zero
+struct IG_LIB RayBatch {
+    const float* OriginX    = nullptr;
+    const float* OriginY    = nullptr;
+    const float* OriginZ    = nullptr;
+    const float* DirectionX = nullptr;
+    const float* DirectionY = nullptr;
+    const float* DirectionZ = nullptr;
+    const float* TMin       = nullptr;
+    const float* TMax       = nullptr;
+    size_t Stride           = 1; // In floats
+    size_t RangeStride      = 1; // In floats. Zero shares a single range between all rays
+    size_t Count            = 0;
+
+    /// @brief Construct a batch referencing the given rays. Nothing is copied, therefore the rays have to stay alive while tracing
+    static RayBatch fromRays(const Ray* rays, size_t count);
+};
+
+/// Output arrays owned by the caller with an entry per ray. Arrays set to null are not written
+struct RayBatchResult {
+    float* Color       = nullptr; // Three floats per ray. Only written in shading mode
+    float* Distance    = nullptr; // Hit distance or infinity if missed. Only written in intersect-only mode
+    int32* EntityID    = nullptr; // Entity hit or -1 if missed. Only written in intersect-only mode
+    int32* PrimitiveID = nullptr; // Primitive of the entity hit or -1 if missed. Only written in intersect-only mode
+
+    /// If false, the framebuffer is copied into Color after tracing.
+    /// If true, Color replaces the framebuffer while tracing and the samples are accumulated directly into it, without any copy.
+    /// Color has to hold the previous iterations in that case, i.e., zeros after a reset.
+    /// Only supported on the CPU and if the number of rays matches the framebuffer size
+    bool AccumulateColor = false;
+};
+
+enum class RayBatchMode {
+    Shade = 0,    // Apply the technique of the scene
+    IntersectOnly // Only compute the closest hit of every ray
+};
 } // namespace IG
\ No newline at end of file
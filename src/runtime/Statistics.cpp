@@ -57,6 +57,58 @@ Statistics::SectionStats& Statistics::SectionStats::operator+=(const Statistics:
     return *this;
 }
 
+Statistics::MeasurementStats& Statistics::MeasurementStats::operator+=(const Statistics::MeasurementStats& other)
+{
+    count += other.count;
+    sum += other.sum;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+
+    return *this;
+}
+
+void Statistics::record(Measurement measurement, float value)
+{
+    MeasurementStats stats;
+    stats.count = 1;
+    stats.sum   = value;
+    stats.min   = value;
+    stats.max   = value;
+
+    mMeasurements[(size_t)measurement] += stats;
+}
+
+Statistics::ScheduleStats& Statistics::ScheduleStats::operator+=(const Statistics::ScheduleStats& other)
+{
+    wall += other.wall;
+    tail += other.tail;
+    count += other.count;
+    steals += other.steals;
+    splits += other.splits;
+
+    if (busy.size() < other.busy.size())
+        busy.resize(other.busy.size(), duration_t(0));
+    for (size_t i = 0; i < other.busy.size(); ++i)
+        busy[i] += other.busy[i];
+
+    return *this;
+}
+
+void Statistics::addTileSchedule(Timer::duration wall, Timer::duration tail, const std::vector<Timer::duration>& busy, size_t steals, size_t splits)
+{
+    ScheduleStats stats;
+    stats.wall   = std::chrono::duration_cast<duration_t>(wall);
+    stats.tail   = std::chrono::duration_cast<duration_t>(tail);
+    stats.count  = 1;
+    stats.steals = steals;
+    stats.splits = splits;
+    stats.busy.reserve(busy.size());
+    for (const auto& b : busy)
+        stats.busy.push_back(std::chrono::duration_cast<duration_t>(b));
+
+    mScheduleStats += stats;
+}
+
 void Statistics::add(const Statistics& other)
 {
     mDeviceStats += other.mDeviceStats;
@@ -80,6 +132,19 @@ void Statistics::add(const Statistics& other)
 
     for (size_t i = 0; i < other.mSections.size(); ++i)
         mSections[i] += other.mSections[i];
+
+    for (size_t i = 0; i < other.mMeasurements.size(); ++i)
+        mMeasurements[i] += other.mMeasurements[i];
+
+    mScheduleStats += other.mScheduleStats;
+
+    mLazyCompiledShaders = std::max(mLazyCompiledShaders, other.mLazyCompiledShaders);
+    mLazyDeclaredShaders = std::max(mLazyDeclaredShaders, other.mLazyDeclaredShaders);
+
+    mTextureTileEvictions = std::max(mTextureTileEvictions, other.mTextureTileEvictions);
+    mTextureCacheResident = std::max(mTextureCacheResident, other.mTextureCacheResident);
+    mTextureCachePeak     = std::max(mTextureCachePeak, other.mTextureCachePeak);
+    mTextureCacheBudget   = std::max(mTextureCacheBudget, other.mTextureCacheBudget);
 }
 
 class DumpTable {
@@ -270,9 +335,41 @@ std::string Statistics::dump(size_t totalMS, size_t iter, bool verbose) const
     if (mBakeStats.count > 0)
         dumpStats("  |-Bake", mBakeStats);
 
+    if (mLazyDeclaredShaders > 0)
+        table.addRow({ "  |-LazyHitShaders", std::to_string(mLazyCompiledShaders) + " of " + std::to_string(mLazyDeclaredShaders) + " compiled" });
+
+    if (mScheduleStats.count > 0) {
+        const auto utilization = [&](duration_t busy) {
+            const double wall = (double)mScheduleStats.wall.count();
+            std::stringstream bstream;
+            bstream << std::fixed << std::setprecision(3) << (wall > 0 ? 100 * (double)busy.count() / wall : 0.0) << "%";
+            return bstream.str();
+        };
+
+        duration_t totalBusy = duration_t(0);
+        for (const auto& busy : mScheduleStats.busy)
+            totalBusy += busy;
+        const size_t workers = std::max<size_t>(1, mScheduleStats.busy.size());
+
+        table.addRow({ "  Scheduler:" });
+        dumpInline("  |-Passes", mScheduleStats.count, mScheduleStats.wall);
+        dumpInline("  |-TailLatency", mScheduleStats.count, mScheduleStats.tail);
+        table.addRow({ "  |-Utilization", utilization(totalBusy / workers) + " of " + std::to_string(mScheduleStats.busy.size()) + " workers" });
+        if (verbose) {
+            for (size_t i = 0; i < mScheduleStats.busy.size(); ++i)
+                table.addRow({ "  ||-@" + std::to_string(i), utilization(mScheduleStats.busy[i]) });
+        }
+        table.addRow({ "  |-Steals", std::to_string(mScheduleStats.steals) });
+        table.addRow({ "  |-Splits", std::to_string(mScheduleStats.splits) });
+    }
+
     table.addRow({ "  Sections:" });
     dumpSectionStats("  |-ImageLoading", mSections[(size_t)SectionType::ImageLoading]);
     dumpSectionStats("  |-PackedImageLoading", mSections[(size_t)SectionType::PackedImageLoading]);
+    dumpSectionStats("  |-MipImageLoading", mSections[(size_t)SectionType::MipImageLoading]);
+    dumpSectionStats("  |-TiledImageLoading", mSections[(size_t)SectionType::TiledImageLoading]);
+    dumpSectionStats("  |-HalfImageLoading", mSections[(size_t)SectionType::HalfImageLoading]);
+    dumpSectionStats("  |-CompressedImageLoading", mSections[(size_t)SectionType::CompressedImageLoading]);
     dumpSectionStats("  |-BufferLoading", mSections[(size_t)SectionType::BufferLoading]);
     dumpSectionStats("  |-BufferRequests", mSections[(size_t)SectionType::BufferRequests]);
     dumpSectionStats("  |-BufferReleases", mSections[(size_t)SectionType::BufferReleases]);
@@ -281,6 +378,11 @@ std::string Statistics::dump(size_t totalMS, size_t iter, bool verbose) const
     dumpSectionStats("  |-TonemapUpdate", mSections[(size_t)SectionType::TonemapUpdate]);
     dumpSectionStats("  |-FramebufferHostUpdate", mSections[(size_t)SectionType::FramebufferHostUpdate]);
     dumpSectionStats("  |-AOVHostUpdate", mSections[(size_t)SectionType::AOVHostUpdate]);
+    dumpSectionStats("  |-SplatFilmMerge", mSections[(size_t)SectionType::SplatFilmMerge]);
+    dumpSectionStats("  |-EntityGrouping", mSections[(size_t)SectionType::EntityGrouping]);
+    dumpSectionStats("  |-EntitySerialization", mSections[(size_t)SectionType::EntitySerialization]);
+    dumpSectionStats("  |-SceneBVHBuild", mSections[(size_t)SectionType::SceneBVHBuild]);
+    dumpSectionStats("  |-EntityUpdate", mSections[(size_t)SectionType::EntityUpdate]);
 
     table.addRow({ "  Quantities:" });
     table.addRow({ "  |-CameraRays", dumpQuantity(mQuantities[(size_t)Quantity::CameraRayCount]) });
@@ -288,6 +390,43 @@ std::string Statistics::dump(size_t totalMS, size_t iter, bool verbose) const
     table.addRow({ "  |-BounceRays", dumpQuantity(mQuantities[(size_t)Quantity::BounceRayCount]) });
     table.addRow({ "  |-PrimaryRays", dumpQuantity(mQuantities[(size_t)Quantity::CameraRayCount] + mQuantities[(size_t)Quantity::BounceRayCount]) });
     table.addRow({ "  |-TotalRays", dumpQuantity(mQuantities[(size_t)Quantity::CameraRayCount] + mQuantities[(size_t)Quantity::BounceRayCount] + mQuantities[(size_t)Quantity::ShadowRayCount]) });
+    if (mQuantities[(size_t)Quantity::PhotonCount] > 0)
+        table.addRow({ "  |-Photons", dumpQuantity(mQuantities[(size_t)Quantity::PhotonCount]) });
+
+    const uint64 tileHits   = mQuantities[(size_t)Quantity::TextureTileHitCount];
+    const uint64 tileMisses = mQuantities[(size_t)Quantity::TextureTileMissCount];
+    if (mTextureCacheBudget > 0) {
+        const auto dumpBytes = [](size_t bytes) {
+            std::stringstream bstream;
+            bstream << std::fixed << std::setprecision(2) << bytes / (1024.0 * 1024.0) << " MiB";
+            return bstream.str();
+        };
+
+        std::stringstream rstream;
+        rstream << std::fixed << std::setprecision(3) << (tileHits + tileMisses > 0 ? 100 * double(tileHits) / double(tileHits + tileMisses) : 0.0) << "%";
+
+        table.addRow({ "  TextureCache:" });
+        table.addRow({ "  |-TileHits", dumpQuantity(tileHits) });
+        table.addRow({ "  |-TileMisses", dumpQuantity(tileMisses) });
+        table.addRow({ "  |-HitRate", rstream.str() });
+        table.addRow({ "  |-Evictions", std::to_string(mTextureTileEvictions) });
+        table.addRow({ "  |-Resident", dumpBytes(mTextureCacheResident) + " (peak " + dumpBytes(mTextureCachePeak) + ") of " + dumpBytes(mTextureCacheBudget) });
+    }
+
+    const auto dumpMeasurement = [&](const std::string& name, const MeasurementStats& stats) {
+        if (stats.count == 0)
+            return;
+
+        std::stringstream bstream;
+        bstream << "mean " << stats.sum / stats.count << " (min " << stats.min << ", max " << stats.max << ") [" << stats.count << "]";
+        table.addRow({ name, bstream.str() });
+    };
+
+    const bool hasMeasurements = std::any_of(mMeasurements.begin(), mMeasurements.end(), [](const MeasurementStats& stats) { return stats.count > 0; });
+    if (hasMeasurements) {
+        table.addRow({ "  Measurements:" });
+        dumpMeasurement("  |-PhotonMergeRadius", mMeasurements[(size_t)Measurement::PhotonMergeRadius]);
+    }
 
     return table.print(false, true);
 }
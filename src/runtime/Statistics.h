@@ -2,6 +2,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include "Timer.h"
 
@@ -41,6 +42,10 @@ enum class SectionType {
 
     ImageLoading,
     PackedImageLoading,
+    MipImageLoading,
+    TiledImageLoading,
+    HalfImageLoading,
+    CompressedImageLoading,
     BufferLoading,
     BufferRequests,
     BufferReleases,
@@ -49,6 +54,12 @@ enum class SectionType {
     TonemapUpdate,
     FramebufferHostUpdate,
     AOVHostUpdate,
+    SplatFilmMerge,
+
+    EntityGrouping,
+    EntitySerialization,
+    SceneBVHBuild,
+    EntityUpdate,
 
     _COUNT
 };
@@ -58,6 +69,16 @@ enum class Quantity {
     CameraRayCount = 0,
     ShadowRayCount,
     BounceRayCount,
+    PhotonCount,
+    TextureTileHitCount,
+    TextureTileMissCount,
+
+    _COUNT
+};
+
+enum class Measurement {
+    // This should be in sync with core/stats.art
+    PhotonMergeRadius = 0,
 
     _COUNT
 };
@@ -106,6 +127,28 @@ public:
         mQuantities[(size_t)quantity] += value;
     }
 
+    /// Record a single value of a measurement. Only the mean and the extrema are kept
+    void record(Measurement measurement, float value);
+
+    /// Set number of hit shaders compiled on demand and the number of hit shaders declared in total
+    inline void setLazyShaderCount(size_t compiled, size_t declared)
+    {
+        mLazyCompiledShaders = compiled;
+        mLazyDeclaredShaders = declared;
+    }
+
+    /// Set usage of the texture page cache. Evictions are counted since the start of the device
+    inline void setTextureCacheUsage(size_t evictions, size_t resident, size_t peak, size_t budget)
+    {
+        mTextureTileEvictions = evictions;
+        mTextureCacheResident = resident;
+        mTextureCachePeak     = peak;
+        mTextureCacheBudget   = budget;
+    }
+
+    /// Add timings of a CPU render pass distributed over multiple workers
+    void addTileSchedule(Timer::duration wall, Timer::duration tail, const std::vector<Timer::duration>& busy, size_t steals, size_t splits);
+
     void add(const Statistics& other);
 
     [[nodiscard]] std::string dump(size_t totalMS, size_t iter, bool verbose) const;
@@ -133,6 +176,26 @@ private:
         SectionStats& operator+=(const SectionStats& other);
     };
 
+    struct ScheduleStats {
+        duration_t wall = duration_t(0);
+        duration_t tail = duration_t(0);
+        std::vector<duration_t> busy; // Per worker
+        size_t count  = 0;
+        size_t steals = 0;
+        size_t splits = 0;
+
+        ScheduleStats& operator+=(const ScheduleStats& other);
+    };
+
+    struct MeasurementStats {
+        size_t count = 0;
+        double sum   = 0;
+        float min    = std::numeric_limits<float>::infinity();
+        float max    = -std::numeric_limits<float>::infinity();
+
+        MeasurementStats& operator+=(const MeasurementStats& other);
+    };
+
     ShaderStats mDeviceStats;
     ShaderStats mPrimaryTraversalStats;
     ShaderStats mSecondaryTraversalStats;
@@ -148,5 +211,15 @@ private:
 
     std::array<uint64, (size_t)Quantity::_COUNT> mQuantities;
     std::array<SectionStats, (size_t)SectionType::_COUNT> mSections;
+    std::array<MeasurementStats, (size_t)Measurement::_COUNT> mMeasurements;
+    ScheduleStats mScheduleStats;
+
+    size_t mLazyCompiledShaders = 0;
+    size_t mLazyDeclaredShaders = 0;
+
+    size_t mTextureTileEvictions = 0;
+    size_t mTextureCacheResident = 0;
+    size_t mTextureCachePeak     = 0;
+    size_t mTextureCacheBudget   = 0;
 };
 } // namespace IG
\ No newline at end of file
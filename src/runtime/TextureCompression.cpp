@@ -0,0 +1,390 @@
+#include "TextureCompression.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include <tbb/parallel_for.h>
+
+namespace IG {
+using Texel = std::array<uint8, 4>;
+
+// ------------------------------------------------- Block compression
+static inline uint16 packRGB565(const Texel& c)
+{
+    return (uint16)(((c[0] * 31 + 127) / 255) << 11 | ((c[1] * 63 + 127) / 255) << 5 | ((c[2] * 31 + 127) / 255));
+}
+
+static inline Texel unpackRGB565(uint16 c)
+{
+    const uint32 r = (c >> 11) & 0x1F;
+    const uint32 g = (c >> 5) & 0x3F;
+    const uint32 b = c & 0x1F;
+    return Texel{ (uint8)((r << 3) | (r >> 2)), (uint8)((g << 2) | (g >> 4)), (uint8)((b << 3) | (b >> 2)), 255 };
+}
+
+static inline uint32 distanceRGB(const Texel& a, const Texel& b)
+{
+    uint32 sum = 0;
+    for (int i = 0; i < 3; ++i) {
+        const int32 d = (int32)a[i] - (int32)b[i];
+        sum += (uint32)(d * d);
+    }
+    return sum;
+}
+
+/// Endpoints are the bounding box of the block colors, inset by 1/16 of its extent to reduce the error of the common case
+static void encodeColorBlock(const std::array<Texel, 16>& texels, uint8* dst)
+{
+    Texel min = texels[0];
+    Texel max = texels[0];
+    for (const auto& t : texels) {
+        for (int i = 0; i < 3; ++i) {
+            min[i] = std::min(min[i], t[i]);
+            max[i] = std::max(max[i], t[i]);
+        }
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        const uint8 inset = (uint8)((max[i] - min[i]) >> 4);
+        min[i] += inset;
+        max[i] -= inset;
+    }
+
+    // The channels of max are at least the channels of min, therefore c0 >= c1, which selects the four color mode
+    const uint16 c0 = packRGB565(max);
+    const uint16 c1 = packRGB565(min);
+
+    uint32 indices = 0;
+    if (c0 != c1) {
+        const Texel p0 = unpackRGB565(c0);
+        const Texel p1 = unpackRGB565(c1);
+        std::array<Texel, 4> palette = { p0, p1, p0, p1 };
+        for (int i = 0; i < 3; ++i) {
+            palette[2][i] = (uint8)((2 * p0[i] + p1[i] + 1) / 3);
+            palette[3][i] = (uint8)((p0[i] + 2 * p1[i] + 1) / 3);
+        }
+
+        for (size_t k = 0; k < 16; ++k) {
+            uint32 best     = 0;
+            uint32 bestDist = distanceRGB(texels[k], palette[0]);
+            for (uint32 j = 1; j < 4; ++j) {
+                const uint32 dist = distanceRGB(texels[k], palette[j]);
+                if (dist < bestDist) {
+                    best     = j;
+                    bestDist = dist;
+                }
+            }
+            indices |= best << (2 * k);
+        }
+    }
+
+    const uint32 colors = (uint32)c0 | ((uint32)c1 << 16);
+    std::memcpy(dst, &colors, sizeof(colors));
+    std::memcpy(dst + 4, &indices, sizeof(indices));
+}
+
+static void encodeValueBlock(const std::array<uint8, 16>& values, uint8* dst)
+{
+    const uint8 r0 = *std::max_element(values.begin(), values.end());
+    const uint8 r1 = *std::min_element(values.begin(), values.end());
+
+    // r0 > r1 selects the eight value mode
+    uint64 indices = 0;
+    if (r0 != r1) {
+        std::array<int32, 8> palette = { r0, r1 };
+        for (int32 i = 2; i < 8; ++i)
+            palette[i] = ((8 - i) * r0 + (i - 1) * r1 + 3) / 7;
+
+        for (size_t k = 0; k < 16; ++k) {
+            uint64 best    = 0;
+            int32 bestDist = std::abs(values[k] - palette[0]);
+            for (uint64 j = 1; j < 8; ++j) {
+                const int32 dist = std::abs(values[k] - palette[j]);
+                if (dist < bestDist) {
+                    best     = j;
+                    bestDist = dist;
+                }
+            }
+            indices |= best << (3 * k);
+        }
+    }
+
+    dst[0] = r0;
+    dst[1] = r1;
+    for (size_t i = 0; i < 6; ++i)
+        dst[2 + i] = (uint8)((indices >> (8 * i)) & 0xFF);
+}
+
+static void decodeColorBlock(const uint8* src, bool forceFourColors, std::array<Texel, 16>& texels)
+{
+    uint32 colors, indices;
+    std::memcpy(&colors, src, sizeof(colors));
+    std::memcpy(&indices, src + 4, sizeof(indices));
+
+    const uint16 c0 = (uint16)(colors & 0xFFFF);
+    const uint16 c1 = (uint16)(colors >> 16);
+    const Texel p0  = unpackRGB565(c0);
+    const Texel p1  = unpackRGB565(c1);
+
+    std::array<Texel, 4> palette = { p0, p1, p0, Texel{ 0, 0, 0, 0 } };
+    for (int i = 0; i < 3; ++i) {
+        if (forceFourColors || c0 > c1) {
+            palette[2][i] = (uint8)((2 * p0[i] + p1[i] + 1) / 3);
+            palette[3][i] = (uint8)((p0[i] + 2 * p1[i] + 1) / 3);
+            palette[3][3] = 255;
+        } else {
+            palette[2][i] = (uint8)((p0[i] + p1[i] + 1) / 2);
+        }
+    }
+
+    for (size_t k = 0; k < 16; ++k)
+        texels[k] = palette[(indices >> (2 * k)) & 0x3];
+}
+
+static void decodeValueBlock(const uint8* src, std::array<uint8, 16>& values)
+{
+    const int32 r0 = src[0];
+    const int32 r1 = src[1];
+
+    std::array<int32, 8> palette = { r0, r1 };
+    if (r0 > r1) {
+        for (int32 i = 2; i < 8; ++i)
+            palette[i] = ((8 - i) * r0 + (i - 1) * r1 + 3) / 7;
+    } else {
+        for (int32 i = 2; i < 6; ++i)
+            palette[i] = ((6 - i) * r0 + (i - 1) * r1 + 2) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    uint64 indices = 0;
+    for (size_t i = 0; i < 6; ++i)
+        indices |= (uint64)src[2 + i] << (8 * i);
+
+    for (size_t k = 0; k < 16; ++k)
+        values[k] = (uint8)palette[(indices >> (3 * k)) & 0x7];
+}
+
+TextureCompression::BlockFormat TextureCompression::compressBlocks(const uint8* packed, size_t width, size_t height, size_t channels, std::vector<uint8>& dst, float minColorPSNR)
+{
+    IG_ASSERT(channels == 1 || channels == 4, "Expected packed image to have one or four channels");
+
+    bool opaque = true;
+    bool noBlue = true;
+    if (channels == 4) {
+        for (size_t i = 0; i < width * height && (opaque || noBlue); ++i) {
+            opaque = opaque && packed[4 * i + 3] == 255;
+            noBlue = noBlue && packed[4 * i + 2] == 0;
+        }
+    }
+
+    BlockFormat format = BlockFormat::BC4;
+    if (channels == 4)
+        format = opaque ? (noBlue ? BlockFormat::BC5 : BlockFormat::BC1) : BlockFormat::BC3;
+
+    const size_t blockX = (width + 3) / 4;
+    const auto encode   = [&](BlockFormat encodeFormat) {
+        const size_t size = blockSize(encodeFormat);
+        dst.resize(blockCount(width, height) * size);
+
+        std::atomic<uint64> colorError = 0;
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, blockCount(width, height)),
+            [&](const tbb::blocked_range<size_t>& range) {
+                uint64 localError = 0;
+                for (size_t b = range.begin(); b < range.end(); ++b) {
+                    // Blocks at the border repeat the last row and column
+                    const size_t x0 = (b % blockX) * 4;
+                    const size_t y0 = (b / blockX) * 4;
+                    const auto texel = [&](size_t k) {
+                        const size_t x = std::min(x0 + k % 4, width - 1);
+                        const size_t y = std::min(y0 + k / 4, height - 1);
+                        return (y * width + x) * channels;
+                    };
+
+                    uint8* block = dst.data() + b * size;
+                    if (encodeFormat == BlockFormat::BC4) {
+                        std::array<uint8, 16> values;
+                        for (size_t k = 0; k < 16; ++k)
+                            values[k] = packed[texel(k)];
+                        encodeValueBlock(values, block);
+                    } else if (encodeFormat == BlockFormat::RGBA8) {
+                        for (size_t k = 0; k < 16; ++k)
+                            std::memcpy(block + 4 * k, packed + texel(k), 4);
+                    } else if (encodeFormat == BlockFormat::BC5) {
+                        std::array<uint8, 16> reds, greens;
+                        for (size_t k = 0; k < 16; ++k) {
+                            reds[k]   = packed[texel(k) + 0];
+                            greens[k] = packed[texel(k) + 1];
+                        }
+                        encodeValueBlock(reds, block);
+                        encodeValueBlock(greens, block + 8);
+                    } else {
+                        std::array<Texel, 16> texels;
+                        for (size_t k = 0; k < 16; ++k)
+                            std::memcpy(texels[k].data(), packed + texel(k), 4);
+
+                        uint8* colorBlock = block;
+                        if (encodeFormat == BlockFormat::BC3) {
+                            std::array<uint8, 16> alphas;
+                            for (size_t k = 0; k < 16; ++k)
+                                alphas[k] = texels[k][3];
+                            encodeValueBlock(alphas, block);
+                            colorBlock = block + 8;
+                        }
+                        encodeColorBlock(texels, colorBlock);
+
+                        // Only texels inside the image contribute to the quality check
+                        std::array<Texel, 16> decoded;
+                        decodeColorBlock(colorBlock, encodeFormat == BlockFormat::BC3, decoded);
+                        for (size_t k = 0; k < 16; ++k) {
+                            if (x0 + k % 4 < width && y0 + k / 4 < height)
+                                localError += distanceRGB(texels[k], decoded[k]);
+                        }
+                    }
+                }
+                colorError += localError;
+            });
+
+        return colorError.load();
+    };
+
+    const uint64 colorError = encode(format);
+    if (format == BlockFormat::BC1 || format == BlockFormat::BC3) {
+        const double mse  = (double)colorError / (double)(3 * width * height);
+        const double psnr = mse > 0 ? 10 * std::log10(255.0 * 255.0 / mse) : std::numeric_limits<double>::infinity();
+        if (psnr < minColorPSNR) {
+            format = BlockFormat::RGBA8;
+            encode(format);
+        }
+    }
+
+    return format;
+}
+
+void TextureCompression::decompressBlocks(const uint8* blocks, size_t width, size_t height, BlockFormat format, std::vector<uint8>& dst)
+{
+    const size_t channels = format == BlockFormat::BC4 ? 1 : 4;
+    const size_t blockX   = (width + 3) / 4;
+    const size_t size     = blockSize(format);
+    dst.resize(width * height * channels);
+
+    for (size_t b = 0; b < blockCount(width, height); ++b) {
+        const uint8* block = blocks + b * size;
+
+        std::array<Texel, 16> texels;
+        std::array<uint8, 16> values;
+        if (format == BlockFormat::BC4) {
+            decodeValueBlock(block, values);
+        } else if (format == BlockFormat::BC3) {
+            decodeValueBlock(block, values);
+            decodeColorBlock(block + 8, true, texels);
+        } else if (format == BlockFormat::BC5) {
+            std::array<uint8, 16> greens;
+            decodeValueBlock(block, values);
+            decodeValueBlock(block + 8, greens);
+            for (size_t k = 0; k < 16; ++k)
+                texels[k] = Texel{ values[k], greens[k], 0, 255 };
+        } else if (format == BlockFormat::RGBA8) {
+            for (size_t k = 0; k < 16; ++k)
+                std::memcpy(texels[k].data(), block + 4 * k, 4);
+        } else {
+            decodeColorBlock(block, false, texels);
+        }
+
+        const size_t x0 = (b % blockX) * 4;
+        const size_t y0 = (b / blockX) * 4;
+        for (size_t k = 0; k < 16; ++k) {
+            const size_t x = x0 + k % 4;
+            const size_t y = y0 + k / 4;
+            if (x >= width || y >= height)
+                continue;
+
+            uint8* texel = dst.data() + (y * width + x) * channels;
+            if (format == BlockFormat::BC4) {
+                texel[0] = values[k];
+            } else {
+                std::memcpy(texel, texels[k].data(), 4);
+                if (format == BlockFormat::BC3)
+                    texel[3] = values[k];
+            }
+        }
+    }
+}
+
+// ------------------------------------------------- Half floats
+uint16 TextureCompression::floatToHalf(float value)
+{
+    if (std::isnan(value))
+        return 0x7E00;
+
+    value = std::clamp(value, -HalfMax, HalfMax);
+
+    uint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint16 sign = (uint16)((bits >> 16) & 0x8000);
+    bits &= 0x7FFFFFFF;
+
+    // Subnormal halfs are multiples of 2^-24
+    if (bits < 0x38800000) {
+        float abs;
+        std::memcpy(&abs, &bits, sizeof(abs));
+        return sign | (uint16)std::lrint(abs * 16777216.0f);
+    }
+
+    // Round to nearest even. A carry into the exponent is the correct result
+    uint32 half          = ((bits >> 23) - 112) << 10 | ((bits >> 13) & 0x3FF);
+    const uint32 dropped = bits & 0x1FFF;
+    if (dropped > 0x1000 || (dropped == 0x1000 && (half & 0x1)))
+        ++half;
+
+    return sign | (uint16)half;
+}
+
+float TextureCompression::halfToFloat(uint16 value)
+{
+    const uint32 sign = (uint32)(value & 0x8000) << 16;
+    const uint32 exp  = (value >> 10) & 0x1F;
+    const uint32 mant = value & 0x3FF;
+
+    uint32 bits;
+    if (exp == 0) {
+        const float abs = mant / 16777216.0f;
+        return sign ? -abs : abs;
+    } else if (exp == 31) {
+        bits = sign | 0x7F800000 | (mant << 13);
+    } else {
+        bits = sign | ((exp + 112) << 23) | (mant << 13);
+    }
+
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+size_t TextureCompression::convertToHalf(const float* src, size_t count, std::vector<uint16>& dst)
+{
+    dst.resize(count + count % 2);
+    if (count % 2 == 1)
+        dst.back() = 0;
+
+    std::atomic<size_t> clamped = 0;
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, count),
+        [&](const tbb::blocked_range<size_t>& range) {
+            size_t localClamped = 0;
+            for (size_t i = range.begin(); i < range.end(); ++i) {
+                if (std::abs(src[i]) > HalfMax)
+                    ++localClamped;
+                dst[i] = floatToHalf(src[i]);
+            }
+            clamped += localClamped;
+        });
+
+    return clamped;
+}
+} // namespace IG
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "IG_Config.h"
+
+namespace IG {
+/// Compact storage formats for device images.
+/// 8 bit images are block compressed in 4x4 texel blocks, float images are stored as half floats.
+/// The layouts match the decoders in driver/image.art
+class IG_LIB TextureCompression {
+public:
+    enum class BlockFormat : int32 {
+        BC1   = 0, // Opaque RGBA, 8 bytes per block
+        BC3   = 1, // RGBA with alpha, 16 bytes per block
+        BC4   = 2, // Mono, 8 bytes per block
+        BC5   = 3, // Opaque RGBA with an empty blue channel, e.g., two channel normal maps. Red and green are BC4 blocks, 16 bytes per block
+        RGBA8 = 4  // Uncompressed RGBA in block order, 64 bytes per block. Used if the color blocks fail the quality check
+    };
+
+    /// Minimum peak signal to noise ratio in dB of the color channels for BC1 and BC3.
+    /// The bounding box encoder is close to the BC1 optimum, which is about 5-10 dB below BC7 for noisy or multi-colored blocks.
+    /// Images which would lose more than that are stored uncompressed instead
+    static constexpr float MinColorPSNR = 35.0f;
+
+    /// Largest finite half float. Larger values are clamped
+    static constexpr float HalfMax = 65504.0f;
+
+    [[nodiscard]] static inline size_t blockCount(size_t width, size_t height) { return ((width + 3) / 4) * ((height + 3) / 4); }
+    [[nodiscard]] static inline size_t blockSize(BlockFormat format)
+    {
+        switch (format) {
+        case BlockFormat::BC3:
+        case BlockFormat::BC5:
+            return 16;
+        case BlockFormat::RGBA8:
+            return 64;
+        default:
+            return 8;
+        }
+    }
+
+    /// @brief Block compress an image given in the packed format, see Image::loadAsPacked.
+    /// Four channel images use BC5 if all texels are opaque and have no blue, BC1 if all texels are opaque and BC3 otherwise.
+    /// If the color channels of BC1 or BC3 do not reach the given peak signal to noise ratio, RGBA8 is used instead. Single channel images use BC4
+    /// @return The format used
+    static BlockFormat compressBlocks(const uint8* packed, size_t width, size_t height, size_t channels, std::vector<uint8>& dst, float minColorPSNR = MinColorPSNR);
+
+    /// @brief Decompress the given blocks into the packed format, see Image::loadAsPacked. Mainly used for testing
+    static void decompressBlocks(const uint8* blocks, size_t width, size_t height, BlockFormat format, std::vector<uint8>& dst);
+
+    [[nodiscard]] static uint16 floatToHalf(float value);
+    [[nodiscard]] static float halfToFloat(uint16 value);
+
+    /// @brief Convert the given values to half floats. The output is padded to an even count, such that it can be read with 32 bit words
+    /// @return Number of values clamped to the range of half floats
+    static size_t convertToHalf(const float* src, size_t count, std::vector<uint16>& dst);
+};
+} // namespace IG
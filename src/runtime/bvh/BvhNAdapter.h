@@ -2,6 +2,10 @@
 
 #include "NArityBvh.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 namespace IG {
 template <size_t N, typename Node, typename LeafObject, template <typename> typename Allocator>
 class BvhNAdapter {
@@ -158,4 +162,81 @@ protected:
 
     std::vector<Node, Allocator<Node>>& nodes;
 };
+
+/// @brief Quantize the child bounds of a N-ary node relative to the union of all valid children.
+/// Each plane is stored with 8 bits and decoded as origin + q * 2^exp. Planes are rounded outwards,
+/// such that the decoded bounds always contain the original child bounds, with or without fused multiply-add.
+/// Invalid children (child id 0) get an empty box
+template <size_t N, typename Node, typename QNode>
+inline void quantize_node(const Node& node, QNode& qnode)
+{
+    std::memset(&qnode, 0, sizeof(QNode));
+
+    for (size_t i = 0; i < N; ++i)
+        qnode.child.e[i] = node.child.e[i];
+
+    for (int a = 0; a < 3; ++a) {
+        float lo = FltInf;
+        float hi = -FltInf;
+        for (size_t i = 0; i < N; ++i) {
+            if (node.child.e[i] == 0)
+                continue;
+            lo = std::min(lo, node.bounds.e[2 * a + 0].e[i]);
+            hi = std::max(hi, node.bounds.e[2 * a + 1].e[i]);
+        }
+
+        if (lo > hi) // No valid child at all
+            lo = hi = 0;
+
+        // Smallest power of two, such that 255 steps cover the whole extent
+        const float extent = hi - lo;
+        int exp            = extent > 0 ? (int)std::ceil(std::log2(extent / 255.0f)) : -126;
+        exp                = std::clamp(exp, -126, 127);
+        while (exp < 127 && lo + 255.0f * std::ldexp(1.0f, exp) < hi)
+            ++exp;
+
+        const float scale = std::ldexp(1.0f, exp);
+        const auto decode = [&](int q, bool fma) { return fma ? std::fma((float)q, scale, lo) : lo + (float)q * scale; };
+
+        qnode.origin.e[a] = lo;
+        qnode.exp.e[a]    = (int8)exp;
+
+        for (size_t i = 0; i < N; ++i) {
+            if (node.child.e[i] == 0) {
+                qnode.bounds.e[2 * a + 0].e[i] = 255;
+                qnode.bounds.e[2 * a + 1].e[i] = 0;
+                continue;
+            }
+
+            const float cmin = node.bounds.e[2 * a + 0].e[i];
+            const float cmax = node.bounds.e[2 * a + 1].e[i];
+
+            int qlo = std::clamp((int)std::floor((cmin - lo) / scale), 0, 255);
+            while (qlo > 0 && (decode(qlo, false) > cmin || decode(qlo, true) > cmin))
+                --qlo;
+
+            int qhi = std::clamp((int)std::ceil((cmax - lo) / scale), 0, 255);
+            while (qhi < 255 && (decode(qhi, false) < cmax || decode(qhi, true) < cmax))
+                ++qhi;
+
+            // Flat children, e.g., axis aligned quads, would decode to a slab without thickness, which the slab test misses under rounding
+            if (cmin == cmax) {
+                qlo = std::max(qlo - 1, 0);
+                qhi = std::min(qhi + 1, 255);
+            }
+
+            qnode.bounds.e[2 * a + 0].e[i] = (uint8)qlo;
+            qnode.bounds.e[2 * a + 1].e[i] = (uint8)qhi;
+        }
+    }
+}
+
+/// @brief Quantize all nodes of a N-ary bvh. The node ids, and therefore the leaves, stay the same
+template <size_t N, typename Node, typename QNode, template <typename> typename Allocator>
+inline void quantize_nodes(const std::vector<Node, Allocator<Node>>& nodes, std::vector<QNode, Allocator<QNode>>& qnodes)
+{
+    qnodes.resize(nodes.size());
+    for (size_t i = 0; i < nodes.size(); ++i)
+        quantize_node<N>(nodes[i], qnodes[i]);
+}
 } // namespace IG
\ No newline at end of file
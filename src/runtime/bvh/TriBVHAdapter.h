@@ -1,10 +1,12 @@
 #pragma once
 
 #include "BvhNAdapter.h"
+#include "RuntimeSettings.h"
 #include "math/Triangle.h"
 #include "mesh/TriMesh.h"
 
 IG_BEGIN_IGNORE_WARNINGS
+#include <bvh/binned_sah_builder.hpp>
 #include <bvh/bvh.hpp>
 #include <bvh/leaf_collapser.hpp>
 #include <bvh/locally_ordered_clustering_builder.hpp>
@@ -15,7 +17,7 @@ IG_BEGIN_IGNORE_WARNINGS
 #include <bvh/triangle.hpp>
 IG_END_IGNORE_WARNINGS
 
-// Contains implementation for NodeN and TriN
+// Contains implementation for NodeN, QNodeN and TriN
 #include "generated_interface.h"
 
 namespace IG {
@@ -26,14 +28,16 @@ struct BvhNTriM {
 
 template <>
 struct BvhNTriM<8, 4> {
-    using Node = Node8;
-    using Tri  = Tri4;
+    using Node  = Node8;
+    using QNode = QNode8; // Quantized variant of Node
+    using Tri   = Tri4;
 };
 
 template <>
 struct BvhNTriM<4, 4> {
-    using Node = Node4;
-    using Tri  = Tri4;
+    using Node  = Node4;
+    using QNode = QNode4; // Quantized variant of Node
+    using Tri   = Tri4;
 };
 
 template <>
@@ -159,15 +163,36 @@ protected:
     }
 };
 
+/// @brief Compute the surface area heuristic cost of a binary bvh, relative to the root node. Intersecting a primitive has unit cost
+template <typename Bvh>
+inline float compute_sah_cost(const Bvh& bvh, float traversal_cost = 1.0f)
+{
+    if (bvh.node_count == 0)
+        return 0.0f;
+
+    const float root_area = bvh.nodes[0].bounding_box_proxy().to_bounding_box().half_area();
+    if (root_area <= 0.0f)
+        return 0.0f;
+
+    float cost = 0.0f;
+    for (size_t i = 0; i < bvh.node_count; ++i) {
+        const auto& node = bvh.nodes[i];
+        const float area = node.bounding_box_proxy().to_bounding_box().half_area();
+        cost += area * (node.is_leaf() ? (float)node.primitive_count : traversal_cost);
+    }
+    return cost / root_area;
+}
+
+/// @brief Build a bvh for the given triangle mesh
+/// @param quality Trade-off between build time and trace performance
+/// @return SAH cost of the intermediate binary bvh
 template <size_t N, size_t M, template <typename> typename Allocator>
-inline void build_bvh(const TriMesh& tri_mesh,
-                      std::vector<typename BvhNTriM<N, M>::Node, Allocator<typename BvhNTriM<N, M>::Node>>& nodes,
-                      std::vector<typename BvhNTriM<N, M>::Tri, Allocator<typename BvhNTriM<N, M>::Tri>>& tris)
+inline float build_bvh(const TriMesh& tri_mesh,
+                       std::vector<typename BvhNTriM<N, M>::Node, Allocator<typename BvhNTriM<N, M>::Node>>& nodes,
+                       std::vector<typename BvhNTriM<N, M>::Tri, Allocator<typename BvhNTriM<N, M>::Tri>>& tris,
+                       RuntimeOptions::BvhQuality quality = RuntimeOptions::BvhQuality::High)
 {
-    using Bvh        = bvh::Bvh<float>;
-    using BvhBuilder = bvh::SpatialSplitBvhBuilder<Bvh, TriangleProxy, 64>;
-    // using BvhBuilder = bvh::LocallyOrderedClusteringBuilder<Bvh, uint32>;
-    // using BvhBuilder = bvh::SweepSahBuilder<Bvh>;
+    using Bvh = bvh::Bvh<float>;
 
     const size_t num_tris = tri_mesh.faceCount();
     std::vector<TriangleProxy> primitives(num_tris);
@@ -184,12 +209,27 @@ inline void build_bvh(const TriMesh& tri_mesh,
     auto global_bbox       = bvh::compute_bounding_boxes_union(bboxes.get(), primitives.size());
 
     Bvh bvh;
-    BvhBuilder builder(bvh);
-    builder.build(global_bbox, primitives.data(), bboxes.get(), centers.get(), primitives.size());
-    // builder.build(global_bbox, bboxes.get(), centers.get(), primitives.size());
-
-    bvh::ParallelReinsertionOptimizer parallel_optimizer(bvh);
-    parallel_optimizer.optimize();
+    switch (quality) {
+    case RuntimeOptions::BvhQuality::Fast: {
+        bvh::BinnedSahBuilder<Bvh, 16> builder(bvh);
+        builder.build(global_bbox, bboxes.get(), centers.get(), primitives.size());
+    } break;
+    case RuntimeOptions::BvhQuality::Balanced: {
+        bvh::BinnedSahBuilder<Bvh, 32> builder(bvh);
+        builder.build(global_bbox, bboxes.get(), centers.get(), primitives.size());
+
+        bvh::ParallelReinsertionOptimizer parallel_optimizer(bvh);
+        parallel_optimizer.optimize();
+    } break;
+    default:
+    case RuntimeOptions::BvhQuality::High: {
+        bvh::SpatialSplitBvhBuilder<Bvh, TriangleProxy, 64> builder(bvh);
+        builder.build(global_bbox, primitives.data(), bboxes.get(), centers.get(), primitives.size());
+
+        bvh::ParallelReinsertionOptimizer parallel_optimizer(bvh);
+        parallel_optimizer.optimize();
+    } break;
+    }
 
     // bvh::LeafCollapser leaf_optimizer(bvh);
     // leaf_optimizer.collapse();
@@ -197,7 +237,11 @@ inline void build_bvh(const TriMesh& tri_mesh,
     bvh::NodeLayoutOptimizer layout_optimizer(bvh);
     layout_optimizer.optimize();
 
+    const float sah_cost = compute_sah_cost(bvh);
+
     BvhNTriMAdapter<N, M, Allocator> adapter(nodes, tris);
     adapter.adapt(bvh, primitives);
+
+    return sah_cost;
 }
-} // namespace IG
\ No newline at end of file
+} // namespace IG
@@ -1,9 +1,17 @@
 #include "Device.h"
+#include "CacheManager.h"
 #include "Image.h"
 #include "Logger.h"
+#include "MaterialQueue.h"
 #include "RuntimeStructs.h"
+#include "ResidencyMap.h"
 #include "ShaderKey.h"
+#include "SplatFilm.h"
 #include "Statistics.h"
+#include "TextureCompression.h"
+#include "TexturePageCache.h"
+#include "TileScheduler.h"
+#include "serialization/FileSerializer.h"
 #include "table/SceneDatabase.h"
 
 #include "generated_interface.h"
@@ -13,18 +21,24 @@
 #include <anydsl_jit.h>
 #include <anydsl_runtime.hpp>
 
+#include <algorithm>
 #include <atomic>
+#include <condition_variable>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
+#include <future>
 #include <iomanip>
 #include <iterator>
 #include <mutex>
+#include <random>
+#include <sstream>
 #include <thread>
 #include <type_traits>
 #include <variant>
 
 #include <tbb/concurrent_queue.h>
+#include <tbb/concurrent_unordered_map.h>
 
 #if defined(__x86_64__) || defined(__amd64__) || defined(_M_X64)
 #ifdef IG_CC_MSC
@@ -91,6 +105,12 @@ struct ShaderStats {
     size_t call_count     = 0;
     size_t workload_count = 0;
 };
+struct LazyShader {
+    std::atomic<void*> Exec{ nullptr };
+    std::atomic<bool> Requested{ false };
+    std::mutex Mutex;              // Guards the publication of Exec for threads waiting on Ready
+    std::condition_variable Ready; // Notified once Exec is set
+};
 struct AOV {
     anydsl::Array<float> Data;
     bool Mapped           = false;
@@ -104,9 +124,25 @@ struct DeviceImageBase {
     anydsl::Array<T> Data;
     size_t Width  = 0;
     size_t Height = 0;
+    size_t Levels = 1; // Number of mip levels stored one after another
 };
 using DeviceImage       = DeviceImageBase<float>;
 using DevicePackedImage = DeviceImageBase<uint8_t>; // Packed RGBA
+using DeviceHalfImage   = DeviceImageBase<uint16_t>; // Half float RGBA or mono
+
+struct DeviceCompressedImage {
+    anydsl::Array<uint8_t> Data;
+    size_t Width                           = 0;
+    size_t Height                          = 0;
+    TextureCompression::BlockFormat Format = TextureCompression::BlockFormat::BC1;
+};
+
+struct DeviceTiledImage {
+    int32 Handle    = -1; // Handle of the image in the texture page cache
+    size_t Width    = 0;
+    size_t Height   = 0;
+    size_t TileSize = 0;
+};
 
 template <typename T>
 struct DeviceBufferBase {
@@ -118,8 +154,13 @@ using DeviceStream = DeviceBufferBase<float>;
 
 struct CPUData {
     size_t ref_count = 0;
-    DeviceStream cpu_primary;
-    DeviceStream cpu_secondary;
+    std::array<DeviceStream, 2> cpu_primary; // Front and back buffer used by out-of-place sorting
+    std::array<DeviceStream, 2> cpu_secondary;
+    size_t cpu_primary_front   = 0;
+    size_t cpu_secondary_front = 0;
+
+    inline DeviceStream& primaryStream(size_t buffer) { return cpu_primary[(cpu_primary_front + buffer) % cpu_primary.size()]; }
+    inline DeviceStream& secondaryStream(size_t buffer) { return cpu_secondary[(cpu_secondary_front + buffer) % cpu_secondary.size()]; }
     TemporaryStorageHostProxy temporary_storage_host;
     Statistics stats;
     const ParameterSet* current_local_registry = nullptr;
@@ -127,6 +168,7 @@ struct CPUData {
     std::unordered_map<ShaderKey, ShaderStats, ShaderKeyHash> shader_stats;
 };
 thread_local CPUData* tlThreadData = nullptr;
+thread_local int32 tlSplatChunk    = -1; // Work chunk of the current CPU worker, see SplatFilm
 
 #ifdef IG_HAS_DENOISER
 void ignis_denoise(Device* device);
@@ -143,7 +185,7 @@ public:
         IG_CLASS_NON_MOVEABLE(DeviceData);
 
     public:
-        std::unordered_map<std::string, BvhVariant> bvh_ents;
+        ResidencyMap<BvhVariant> bvh_ents;
         anydsl::Array<int32_t> tmp_buffer;
         TemporaryStorageHostProxy temporary_storage_host;
         std::array<DeviceStream, GPUStreamBufferCount> primary;
@@ -151,13 +193,19 @@ public:
         std::unordered_map<std::string, anydsl::Array<float>> aovs;
         anydsl::Array<float> film_pixels;
         anydsl::Array<StreamRay> ray_list;
+        size_t ray_list_render = 0; // Render call the ray list was uploaded for
         std::array<DeviceStream*, GPUStreamBufferCount> current_primary;
         std::array<DeviceStream*, GPUStreamBufferCount> current_secondary;
-        std::unordered_map<std::string, DeviceImage> images;
-        std::unordered_map<std::string, DevicePackedImage> packed_images;
-        std::unordered_map<std::string, DeviceBuffer> buffers;
-        std::unordered_map<std::string, DynTableProxy> dyntables;
-        std::unordered_map<std::string, DeviceBuffer> fixtables;
+        ResidencyMap<DeviceImage> images;
+        ResidencyMap<DeviceImage> mip_images;
+        ResidencyMap<DevicePackedImage> packed_images;
+        ResidencyMap<DeviceHalfImage> half_images;
+        ResidencyMap<DeviceCompressedImage> compressed_images;
+        ResidencyMap<DeviceTiledImage> tiled_images;
+        ResidencyMap<DeviceBuffer> file_buffers;
+        std::unordered_map<std::string, DeviceBuffer> buffers; // Requested buffers, guarded by thread_mutex
+        ResidencyMap<DynTableProxy> dyntables;
+        ResidencyMap<ShallowArray<uint8_t>> fixtables;
 
         anydsl::Array<uint32_t> tonemap_pixels;
 
@@ -177,7 +225,7 @@ public:
 
         ~DeviceData() = default;
     };
-    std::unordered_map<int32_t, DeviceData> devices;
+    tbb::concurrent_unordered_map<int32_t, DeviceData> devices;
 
     Device* device_ptr;
     std::mutex thread_mutex;
@@ -186,6 +234,21 @@ public:
     tbb::concurrent_queue<CPUData*> available_thread_data;
     std::unordered_map<ShaderKey, ShaderInfo, ShaderKeyHash> shader_infos;
 
+    std::unordered_map<uint32, std::unique_ptr<LazyShader[]>> lazy_hit_shaders; // Per technique variant. Only modified in between renderings
+    std::vector<std::future<void>> lazy_compile_tasks;
+    std::mutex lazy_compile_mutex;
+    std::atomic<size_t> lazy_compiled_count = 0;
+    size_t lazy_declared_count              = 0;
+    std::atomic<bool> lazy_shader_published = false; // Set if a shader compiled in the background replaced the fallback shader
+
+    TileScheduler tile_scheduler;
+    MaterialQueue material_queue; // Shared by the workers of a wavefront pass
+    TexturePageCache texture_cache;
+    Path temporary_tiled_directory; // Holds the tiled files written if the cache is disabled, guarded by thread_mutex
+
+    std::unordered_map<std::string, std::unique_ptr<SplatFilm>> splat_films; // Per aov, guarded by thread_mutex
+    std::vector<int32> splat_chunk_order;                                     // Of the current tile pass
+
     std::unordered_map<std::string, AOV> aovs;
     AOV host_pixels;
 
@@ -196,6 +259,7 @@ public:
     const Device::SetupSettings setup;
     Device::SceneSettings scene;
     Device::RenderSettings current_settings;
+    size_t render_count = 0;
     const ParameterSet* current_parameters = nullptr;
     TechniqueVariantShaderSet shader_set;
 
@@ -209,6 +273,7 @@ public:
 
     inline explicit Interface(Device* device, const Device::SetupSettings& setup)
         : device_ptr(device)
+        , texture_cache(setup.TextureCacheBudget)
         , entity_count(0)
         , film_width(0)
         , film_height(0)
@@ -227,7 +292,14 @@ public:
         shader_infos[ShaderKey(0, ShaderType::Bake, 0)] = {};
     }
 
-    inline ~Interface() = default;
+    inline ~Interface()
+    {
+        waitForLazyCompilation();
+
+        // The streams have to be closed before the files can be removed on every platform
+        texture_cache.clear();
+        removeTemporaryTiledFiles();
+    }
 
     inline int getDevID(size_t device) const
     {
@@ -244,10 +316,51 @@ public:
 
     inline void assignScene(const Device::SceneSettings& settings)
     {
+        waitForLazyCompilation();
+        lazy_hit_shaders.clear();
+        lazy_compiled_count   = 0;
+        lazy_declared_count   = 0;
+        lazy_shader_published = false;
+
         scene        = settings;
         entity_count = scene.database->FixTables.count("entities") > 0 ? scene.database->FixTables.at("entities").entryCount() : 0;
     }
 
+    /// @brief Synchronize resident scene data after entities were updated on the host.
+    /// Only the modified entries of the entity table are uploaded, while the scene bvhs are reloaded on demand
+    inline void updateEntities(const std::vector<uint32>& entity_ids)
+    {
+        const auto& tbl = scene.database->FixTables.at("entities");
+        IG_ASSERT(tbl.entryCount() == entity_count, "Expected number of entities to stay the same");
+        const size_t entry_size = entity_count > 0 ? tbl.currentOffset() / entity_count : 0;
+
+        // The compact layout stores the transforms separately, which might have grown due to previously shared transforms being split up
+        const auto transform_it = scene.database->FixTables.find("entity_transforms");
+        constexpr size_t tsize  = 12 * sizeof(float);
+
+        std::lock_guard<std::mutex> _guard(thread_mutex);
+        for (auto& p : devices) {
+            p.second.bvh_ents.clear();
+
+            if (auto entities = p.second.fixtables.find("entities")) {
+                for (uint32 id : entity_ids)
+                    entities->update(tbl.data(), id * entry_size, entry_size);
+            }
+
+            if (transform_it == scene.database->FixTables.end())
+                continue;
+
+            if (auto transforms = p.second.fixtables.find("entity_transforms")) {
+                if (transforms->size() != transform_it->second.currentOffset()) {
+                    p.second.fixtables.erase("entity_transforms");
+                } else {
+                    for (uint32 id : entity_ids)
+                        transforms->update(transform_it->second.data(), scene.database->Entities[id].TransformID * tsize, tsize);
+                }
+            }
+        }
+    }
+
     inline size_t getPrimaryPayloadBlockSize() const { return current_settings.info.PrimaryPayloadCount; }
     inline size_t getSecondaryPayloadBlockSize() const { return current_settings.info.SecondaryPayloadCount; }
 
@@ -387,6 +500,10 @@ public:
         shader_infos.try_emplace(ShaderKey(shader_set.ID, ShaderType::Miss, 0));
         for (size_t i = 0; i < shader_set.HitShaders.size(); ++i)
             shader_infos.try_emplace(ShaderKey(shader_set.ID, ShaderType::Hit, (uint32)i));
+        if (scene.hit_shader_compiler && lazy_hit_shaders.count(shader_set.ID) == 0) {
+            lazy_hit_shaders[shader_set.ID] = std::make_unique<LazyShader[]>(shader_set.HitShaders.size());
+            lazy_declared_count += shader_set.HitShaders.size();
+        }
         for (size_t i = 0; i < shader_set.AdvancedShadowHitShaders.size(); ++i)
             shader_infos.try_emplace(ShaderKey(shader_set.ID, ShaderType::AdvancedShadowHit, (uint32)i));
         for (size_t i = 0; i < shader_set.AdvancedShadowMissShaders.size(); ++i)
@@ -474,7 +591,7 @@ public:
     inline DeviceStream& getPrimaryStream(int32_t dev, size_t buffer, size_t size)
     {
         const size_t elements = roundUp(MinPrimaryStreamSize + getPrimaryPayloadBlockSize(), 4);
-        auto& stream          = is_gpu ? *devices[dev].current_primary.at(buffer) : getThreadData()->cpu_primary;
+        auto& stream          = is_gpu ? *devices[dev].current_primary.at(buffer) : getThreadData()->primaryStream(buffer);
         resizeArray(dev, stream.Data, size, elements);
         stream.BlockSize = size;
 
@@ -487,15 +604,15 @@ public:
             IG_ASSERT(devices[dev].current_primary.at(buffer)->Data.size() > 0, "Expected gpu primary stream to be initialized");
             return *devices[dev].current_primary.at(buffer);
         } else {
-            IG_ASSERT(getThreadData()->cpu_primary.Data.size() > 0, "Expected cpu primary stream to be initialized");
-            return getThreadData()->cpu_primary;
+            IG_ASSERT(getThreadData()->primaryStream(buffer).Data.size() > 0, "Expected cpu primary stream to be initialized");
+            return getThreadData()->primaryStream(buffer);
         }
     }
 
     inline DeviceStream& getSecondaryStream(int32_t dev, size_t buffer, size_t size)
     {
         const size_t elements = roundUp(MinSecondaryStreamSize + getSecondaryPayloadBlockSize(), 4);
-        auto& stream          = is_gpu ? *devices[dev].current_secondary.at(buffer) : getThreadData()->cpu_secondary;
+        auto& stream          = is_gpu ? *devices[dev].current_secondary.at(buffer) : getThreadData()->secondaryStream(buffer);
         resizeArray(dev, stream.Data, size, elements);
         stream.BlockSize = size;
 
@@ -508,8 +625,8 @@ public:
             IG_ASSERT(devices[dev].current_secondary.at(buffer)->Data.size() > 0, "Expected gpu secondary stream to be initialized");
             return *devices[dev].current_secondary.at(buffer);
         } else {
-            IG_ASSERT(getThreadData()->cpu_secondary.Data.size() > 0, "Expected cpu secondary stream to be initialized");
-            return getThreadData()->cpu_secondary;
+            IG_ASSERT(getThreadData()->secondaryStream(buffer).Data.size() > 0, "Expected cpu secondary stream to be initialized");
+            return getThreadData()->secondaryStream(buffer);
         }
     }
 
@@ -530,6 +647,18 @@ public:
         std::swap(device.current_secondary[0], device.current_secondary[1]);
     }
 
+    inline void swapCPUPrimaryStreams()
+    {
+        auto data               = getThreadData();
+        data->cpu_primary_front = (data->cpu_primary_front + 1) % data->cpu_primary.size();
+    }
+
+    inline void swapCPUSecondaryStreams()
+    {
+        auto data                 = getThreadData();
+        data->cpu_secondary_front = (data->cpu_secondary_front + 1) % data->cpu_secondary.size();
+    }
+
     inline size_t getTemporaryBufferSize() const
     {
         // Upper bound extracted from "mapping_*.art"
@@ -559,57 +688,49 @@ public:
     template <typename Bvh, typename Node>
     inline const Bvh& loadEntityBVH(int32_t dev, const char* prim_type)
     {
-        std::lock_guard<std::mutex> _guard(thread_mutex);
-
-        auto& device    = devices[dev];
-        std::string str = prim_type;
-        auto it         = device.bvh_ents.find(str);
-        if (it == device.bvh_ents.end())
-            return std::get<Bvh>(device.bvh_ents.emplace(str, std::move(loadSceneBVH<Node>(dev, prim_type))).first->second);
-        else
-            return std::get<Bvh>(it->second);
+        return std::get<Bvh>(devices[dev].bvh_ents.getOrLoad(prim_type, [&]() { return BvhVariant(loadSceneBVH<Node>(dev, prim_type)); }));
     }
 
+    // Only used by the GPU, the CPU accesses the ray batch directly
     inline const anydsl::Array<StreamRay>& loadRayList(int32_t dev)
     {
-        size_t count = current_settings.width;
         auto& device = devices[dev];
-        if (device.ray_list.size() == (int64_t)count)
+        if (device.ray_list_render == render_count)
             return device.ray_list;
 
         IG_ASSERT(current_settings.rays != nullptr, "Expected list of rays to be available");
-
-        std::vector<StreamRay> rays;
-        rays.reserve(count);
-
-        for (size_t i = 0; i < count; ++i) {
-            const auto dRay = current_settings.rays[i];
-
-            float norm = dRay.Direction.norm();
-            if (norm < std::numeric_limits<float>::epsilon()) {
-                IG_LOG(L_ERROR) << "Invalid ray given: Ray has zero direction!" << std::endl;
-                norm = 1;
-            }
-
-            // FIXME: Bytewise they are essentially the same...
-            StreamRay ray;
-            ray.org.x = dRay.Origin(0);
-            ray.org.y = dRay.Origin(1);
-            ray.org.z = dRay.Origin(2);
-
-            ray.dir.x = dRay.Direction(0) / norm;
-            ray.dir.y = dRay.Direction(1) / norm;
-            ray.dir.z = dRay.Direction(2) / norm;
-
-            ray.tmin = dRay.Range(0);
-            ray.tmax = dRay.Range(1);
-
-            rays.push_back(ray);
+        const RayBatch& batch = *current_settings.rays;
+
+        std::vector<StreamRay> rays(batch.Count);
+        for (size_t i = 0; i < batch.Count; ++i) {
+            const size_t k = i * batch.Stride;
+            const size_t r = i * batch.RangeStride;
+            rays[i]        = StreamRay{ { batch.OriginX[k], batch.OriginY[k], batch.OriginZ[k] },
+                                        { batch.DirectionX[k], batch.DirectionY[k], batch.DirectionZ[k] },
+                                        batch.TMin[r], batch.TMax[r] };
         }
 
+        device.ray_list_render = render_count;
         return device.ray_list = copyToDevice(dev, rays);
     }
 
+    inline void loadRayBatch(StreamRayBatch* batch)
+    {
+        IG_ASSERT(current_settings.rays != nullptr, "Expected list of rays to be available");
+        const RayBatch& rays = *current_settings.rays;
+
+        batch->org_x        = const_cast<float*>(rays.OriginX);
+        batch->org_y        = const_cast<float*>(rays.OriginY);
+        batch->org_z        = const_cast<float*>(rays.OriginZ);
+        batch->dir_x        = const_cast<float*>(rays.DirectionX);
+        batch->dir_y        = const_cast<float*>(rays.DirectionY);
+        batch->dir_z        = const_cast<float*>(rays.DirectionZ);
+        batch->tmin         = const_cast<float*>(rays.TMin);
+        batch->tmax         = const_cast<float*>(rays.TMax);
+        batch->stride       = (int32_t)rays.Stride;
+        batch->range_stride = (int32_t)rays.RangeStride;
+    }
+
     template <typename T>
     inline anydsl::Array<T> copyToDevice(int32_t dev, const T* data, size_t n)
     {
@@ -666,104 +787,429 @@ public:
 
         DynTableProxy proxy;
         proxy.EntryCount    = tbl.entryCount();
-        proxy.LookupEntries = ShallowArray<::LookupEntry>(dev, (::LookupEntry*)tbl.lookups().data(), tbl.lookups().size());
-        proxy.Data          = ShallowArray<uint8_t>(dev, tbl.data().data(), tbl.data().size());
+        proxy.LookupEntries = ShallowArray<::LookupEntry>(dev, (const ::LookupEntry*)tbl.lookups(), tbl.entryCount());
+        proxy.Data          = ShallowArray<uint8_t>(dev, tbl.data(), tbl.currentOffset());
         return proxy;
     }
 
     inline const DynTableProxy& loadDyntable(int32_t dev, const char* name)
+    {
+        return devices[dev].dyntables.getOrLoad(name, [&]() {
+            IG_LOG(L_DEBUG) << "Loading dyntable '" << name << "'" << std::endl;
+            return loadDyntable(dev, scene.database->DynTables.at(name));
+        });
+    }
+
+    inline ShallowArray<uint8_t> loadFixtable(int32_t dev, const FixTable& tbl)
+    {
+        // Tables are only modified in place after loading (see updateEntities), therefore the host does not need a copy
+        return ShallowArray<uint8_t>(dev, tbl.data(), tbl.currentOffset());
+    }
+
+    inline const ShallowArray<uint8_t>& loadFixtable(int32_t dev, const char* name)
+    {
+        return devices[dev].fixtables.getOrLoad(name, [&]() {
+            IG_LOG(L_DEBUG) << "Loading fixtable '" << name << "'" << std::endl;
+            IG_ASSERT(scene.database->FixTables.count(name) > 0, "Expected given fixtable name to be available");
+
+            return loadFixtable(dev, scene.database->FixTables.at(name));
+        });
+    }
+
+    /// @brief Register the memory usage of a loaded resource for the currently active shader
+    inline void trackResource(int32_t dev, const std::string& filename, size_t memory_usage, bool packed)
     {
         std::lock_guard<std::mutex> _guard(thread_mutex);
 
-        auto& tables = devices[dev].dyntables;
-        auto it      = tables.find(name);
-        if (it != tables.end())
-            return it->second;
+        auto& info = getCurrentShaderInfo(dev);
+        auto& res  = packed ? info.packed_images[filename] : info.images[filename]; // Get or construct resource info for given resource
+        res.counter++;
+        res.memory_usage = memory_usage;
+    }
 
-        IG_LOG(L_DEBUG) << "Loading dyntable '" << name << "'" << std::endl;
+    /// @brief Load image from disk and make it resident on the device. Each image is decoded only once, cache hits are lock-free
+    inline const DeviceImage& loadImage(int32_t dev, const std::string& filename, int32_t expected_channels)
+    {
+        return devices[dev].images.getOrLoad(filename, [&]() {
+            _SECTION(SectionType::ImageLoading);
 
-        return tables[name] = loadDyntable(dev, scene.database->DynTables.at(name));
+            IG_LOG(L_DEBUG) << "Loading image '" << filename << "' (C=" << expected_channels << ")" << std::endl;
+            try {
+                const auto img = Image::load(filename);
+                if (expected_channels != (int32_t)img.channels) {
+                    IG_LOG(L_ERROR) << "Image '" << filename << "' is has unexpected channel count" << std::endl;
+                    return copyToDevice(dev, Image());
+                }
+
+                trackResource(dev, filename, img.width * img.height * img.channels * sizeof(float), false);
+                return copyToDevice(dev, img);
+            } catch (const ImageLoadException& e) {
+                IG_LOG(L_ERROR) << e.what() << std::endl;
+                return copyToDevice(dev, MissingImage);
+            }
+        });
     }
 
-    inline DeviceBuffer loadFixtable(int32_t dev, const FixTable& tbl)
+    /// @brief Path of a resource generated from the given image in the cache directory of the scene
+    inline Path getImageCachePath(const std::string& prefix, const std::string& filename) const
     {
-        return DeviceBuffer{ copyToDevice(dev, tbl.data()), 1 };
+        return scene.cache_manager->directory() / ("_" + prefix + "_" + std::to_string(std::hash<std::string>{}(filename)) + ".bin");
     }
 
-    inline const DeviceBuffer& loadFixtable(int32_t dev, const char* name)
+    /// @brief Concatenate all mip levels of the given image, starting with the full resolution
+    static inline std::vector<float> buildMipPyramid(const Image& image, size_t& levels)
     {
-        std::lock_guard<std::mutex> _guard(thread_mutex);
+        levels = Image::computeMipLevelCount(image.width, image.height);
 
-        auto& tables = devices[dev].fixtables;
-        auto it      = tables.find(name);
-        if (it != tables.end())
-            return it->second;
+        std::vector<float> pyramid(image.pixels.get(), image.pixels.get() + image.width * image.height * image.channels);
 
-        IG_LOG(L_DEBUG) << "Loading fixtable '" << name << "'" << std::endl;
-        IG_ASSERT(scene.database->FixTables.count(name) > 0, "Expected given fixtable name to be available");
+        Image level;
+        const Image* previous = &image;
+        for (size_t l = 1; l < levels; ++l) {
+            level    = previous->downsample();
+            previous = &level;
+            pyramid.insert(pyramid.end(), level.pixels.get(), level.pixels.get() + level.width * level.height * level.channels);
+        }
 
-        return tables[name] = loadFixtable(dev, scene.database->FixTables.at(name));
+        return pyramid;
     }
 
-    inline const DeviceImage& loadImage(int32_t dev, const std::string& filename, int32_t expected_channels)
+    /// @brief Identifier of resources generated from the given image, e.g., the mip pyramid. Changes whenever the image file changes
+    static inline std::string computeImageCacheHash(const std::string& filename, int32_t expected_channels)
     {
-        std::lock_guard<std::mutex> _guard(thread_mutex);
+        std::error_code ec;
+        const auto size = std::filesystem::file_size(filename, ec);
+        const auto time = std::filesystem::last_write_time(filename, ec);
+        return std::to_string(size) + "_" + std::to_string(time.time_since_epoch().count()) + "_" + std::to_string(expected_channels);
+    }
 
-        auto& images = devices[dev].images;
-        auto it      = images.find(filename);
-        if (it != images.end())
-            return it->second;
+    /// @brief Load image from disk with all its mip levels and make it resident on the device. Each image is decoded only once, cache hits are lock-free.
+    /// The pyramid is stored in the cache directory of the scene, such that it is generated only once
+    inline const DeviceImage& loadMipImage(int32_t dev, const std::string& filename, int32_t expected_channels)
+    {
+        return devices[dev].mip_images.getOrLoad(filename, [&]() {
+            _SECTION(SectionType::MipImageLoading);
+
+            IG_LOG(L_DEBUG) << "Loading mip mapped image '" << filename << "' (C=" << expected_channels << ")" << std::endl;
+
+            const auto& cache      = scene.cache_manager;
+            const bool useCache    = cache && cache->isEnabled();
+            const std::string name = "mip_" + filename;
+            const std::string hash = useCache ? computeImageCacheHash(filename, expected_channels) : std::string{};
+            const Path path        = useCache ? getImageCachePath("mip", filename) : Path{};
+
+            uint64 width  = 0;
+            uint64 height = 0;
+            uint64 levels = 0;
+            std::vector<float> pyramid;
+            if (useCache && cache->check(name, hash) && std::filesystem::exists(path)) {
+                FileSerializer serializer(path, true);
+                serializer.read(width);
+                serializer.read(height);
+                serializer.read(levels);
+                serializer.read(pyramid);
+            }
+
+            if (pyramid.empty()) {
+                try {
+                    const auto img = Image::load(filename);
+                    if (expected_channels != (int32_t)img.channels) {
+                        IG_LOG(L_ERROR) << "Image '" << filename << "' is has unexpected channel count" << std::endl;
+                        return copyToDevice(dev, Image());
+                    }
 
-        _SECTION(SectionType::ImageLoading);
+                    size_t count = 0;
+                    pyramid      = buildMipPyramid(img, count);
+                    width        = img.width;
+                    height       = img.height;
+                    levels       = count;
+                } catch (const ImageLoadException& e) {
+                    IG_LOG(L_ERROR) << e.what() << std::endl;
+                    return copyToDevice(dev, MissingImage);
+                }
+
+                if (useCache) {
+                    FileSerializer serializer(path, false);
+                    serializer.write(width);
+                    serializer.write(height);
+                    serializer.write(levels);
+                    serializer.write(pyramid);
 
-        IG_LOG(L_DEBUG) << "Loading image '" << filename << "' (C=" << expected_channels << ")" << std::endl;
-        try {
-            const auto img = Image::load(filename);
-            if (expected_channels != (int32_t)img.channels) {
-                IG_LOG(L_ERROR) << "Image '" << filename << "' is has unexpected channel count" << std::endl;
-                return images[filename] = copyToDevice(dev, Image());
+                    cache->update(name, hash);
+                    cache->sync();
+                }
             }
 
-            auto& res = getCurrentShaderInfo(dev).images[filename]; // Get or construct resource info for given resource
-            res.counter++;
-            res.memory_usage        = img.width * img.height * img.channels * sizeof(float);
-            return images[filename] = copyToDevice(dev, img);
-        } catch (const ImageLoadException& e) {
-            IG_LOG(L_ERROR) << e.what() << std::endl;
-            return images[filename] = copyToDevice(dev, MissingImage);
+            trackResource(dev, filename, pyramid.size() * sizeof(float), false);
+            return DeviceImage{ copyToDevice(dev, pyramid), (size_t)width, (size_t)height, (size_t)levels };
+        });
+    }
+
+    /// @brief Register the image in the texture page cache, converting it into the tiled format first if necessary. Only the tiles requested by shaders are resident.
+    /// The tiled file is stored in the cache directory of the scene, or in a temporary directory of this runtime if the cache is disabled. Temporary files are removed by releaseAll()
+    inline const DeviceTiledImage& loadTiledImage(int32_t dev, const std::string& filename, int32_t expected_channels)
+    {
+        return devices[dev].tiled_images.getOrLoad(filename, [&]() {
+            _SECTION(SectionType::TiledImageLoading);
+
+            IG_LOG(L_DEBUG) << "Loading tiled image '" << filename << "' (C=" << expected_channels << ")" << std::endl;
+
+            const auto& cache      = scene.cache_manager;
+            const bool useCache    = cache && cache->isEnabled();
+            const std::string name = "tiled_" + filename;
+            const std::string hash = computeImageCacheHash(filename, expected_channels);
+            const Path directory   = useCache ? cache->directory() : getTemporaryTiledDirectory();
+            if (directory.empty())
+                return registerMissingTiledImage();
+            const Path path = directory / ("_tiled_" + std::to_string(std::hash<std::string>{}(filename + hash)) + ".bin");
+
+            if (!(useCache && cache->check(name, hash)) || !std::filesystem::exists(path)) {
+                try {
+                    const auto img = Image::load(filename);
+                    if (expected_channels != (int32_t)img.channels) {
+                        IG_LOG(L_ERROR) << "Image '" << filename << "' is has unexpected channel count" << std::endl;
+                        return registerMissingTiledImage();
+                    }
+
+                    TexturePageCache::writeTiledImage(img, path);
+                } catch (const std::exception& e) {
+                    // Includes errors writing the tiled file, e.g., if the disk is full
+                    IG_LOG(L_ERROR) << e.what() << std::endl;
+                    return registerMissingTiledImage();
+                }
+
+                if (useCache) {
+                    cache->update(name, hash);
+                    cache->sync();
+                }
+            }
+
+            const int32 handle = texture_cache.registerImage(path);
+            if (handle < 0)
+                return registerMissingTiledImage();
+
+            const auto& info = texture_cache.info(handle);
+            trackResource(dev, filename, info.tileCount() * info.tileBytes(), false);
+            return DeviceTiledImage{ handle, info.Width, info.Height, info.TileSize };
+        });
+    }
+
+    /// @brief The fallback is kept in memory, as writing it to disk might fail for the same reason the original image failed
+    inline DeviceTiledImage registerMissingTiledImage()
+    {
+        const int32 handle = texture_cache.registerResidentImage(MissingImage);
+        return DeviceTiledImage{ handle, MissingImage.width, MissingImage.height, TexturePageCache::DefaultTileSize };
+    }
+
+    /// @brief Get the directory for tiled files written if the cache is disabled. The directory is created on first use and is unique to this runtime,
+    /// such that other runtimes, also in other processes, never write or remove the same files. Empty if the directory could not be created
+    inline Path getTemporaryTiledDirectory()
+    {
+        std::lock_guard<std::mutex> _guard(thread_mutex);
+        if (!temporary_tiled_directory.empty())
+            return temporary_tiled_directory;
+
+        std::error_code ec;
+        const Path base = std::filesystem::temp_directory_path(ec);
+        if (ec) {
+            IG_LOG(L_ERROR) << "Could not get temporary directory for tiled images: " << ec.message() << std::endl;
+            return Path{};
         }
+
+        std::random_device device;
+        std::uniform_int_distribution<uint64> distribution;
+        for (int tries = 0; tries < 16; ++tries) {
+            std::stringstream stream;
+            stream << "ignis_tiled_" << std::hex << distribution(device);
+
+            // Fails if the directory exists already, which is then owned by someone else
+            const Path directory = base / stream.str();
+            if (std::filesystem::create_directory(directory, ec)) {
+                temporary_tiled_directory = directory;
+                return directory;
+            }
+        }
+
+        IG_LOG(L_ERROR) << "Could not create temporary directory for tiled images in " << base << std::endl;
+        return Path{};
+    }
+
+    inline void removeTemporaryTiledFiles()
+    {
+        if (temporary_tiled_directory.empty())
+            return;
+
+        std::error_code ec;
+        std::filesystem::remove_all(temporary_tiled_directory, ec);
+        if (ec)
+            IG_LOG(L_WARNING) << "Could not remove temporary tiled images in " << temporary_tiled_directory << ": " << ec.message() << std::endl;
+        temporary_tiled_directory.clear();
     }
 
+    /// @brief Load image from disk in packed format and make it resident on the device. Each image is decoded only once, cache hits are lock-free
     inline const DevicePackedImage& loadPackedImage(int32_t dev, const std::string& filename, int32_t expected_channels, bool linear)
     {
-        std::lock_guard<std::mutex> _guard(thread_mutex);
+        return devices[dev].packed_images.getOrLoad(filename, [&]() {
+            _SECTION(SectionType::PackedImageLoading);
 
-        auto& images = devices[dev].packed_images;
-        auto it      = images.find(filename);
-        if (it != images.end())
-            return it->second;
+            IG_LOG(L_DEBUG) << "Loading (packed) image '" << filename << "' (C=" << expected_channels << ")" << std::endl;
+            try {
+                std::vector<uint8_t> packed;
+                size_t width, height, channels;
+                Image::loadAsPacked(filename, packed, width, height, channels, linear);
+
+                if (expected_channels != (int32_t)channels) {
+                    IG_LOG(L_ERROR) << "Packed image '" << filename << "' is has unexpected channel count" << std::endl;
+                    return copyToDevicePacked(dev, MissingImage);
+                }
+
+                trackResource(dev, filename, packed.size(), true);
+                return DevicePackedImage{ copyToDevice(dev, packed), width, height };
+            } catch (const ImageLoadException& e) {
+                IG_LOG(L_ERROR) << e.what() << std::endl;
+                return copyToDevicePacked(dev, MissingImage);
+            }
+        });
+    }
+
+    inline DeviceHalfImage copyToDeviceHalf(int32_t dev, const Image& image)
+    {
+        std::vector<uint16_t> halfs;
+        TextureCompression::convertToHalf(image.pixels.get(), image.width * image.height * image.channels, halfs);
+        return DeviceHalfImage{ copyToDevice(dev, halfs), image.width, image.height };
+    }
+
+    /// @brief Load image from disk, convert it to half floats and make it resident on the device. Each image is decoded only once, cache hits are lock-free.
+    /// The converted image is stored in the cache directory of the scene, such that it is converted only once
+    inline const DeviceHalfImage& loadHalfImage(int32_t dev, const std::string& filename, int32_t expected_channels)
+    {
+        return devices[dev].half_images.getOrLoad(filename, [&]() {
+            _SECTION(SectionType::HalfImageLoading);
 
-        _SECTION(SectionType::PackedImageLoading);
+            IG_LOG(L_DEBUG) << "Loading half image '" << filename << "' (C=" << expected_channels << ")" << std::endl;
 
-        IG_LOG(L_DEBUG) << "Loading (packed) image '" << filename << "' (C=" << expected_channels << ")" << std::endl;
-        try {
-            std::vector<uint8_t> packed;
-            size_t width, height, channels;
-            Image::loadAsPacked(filename, packed, width, height, channels, linear);
+            const auto& cache      = scene.cache_manager;
+            const bool useCache    = cache && cache->isEnabled();
+            const std::string name = "half_" + filename;
+            const std::string hash = useCache ? computeImageCacheHash(filename, expected_channels) : std::string{};
+            const Path path        = useCache ? getImageCachePath("half", filename) : Path{};
 
-            if (expected_channels != (int32_t)channels) {
-                IG_LOG(L_ERROR) << "Packed image '" << filename << "' is has unexpected channel count" << std::endl;
-                return images[filename] = copyToDevicePacked(dev, MissingImage);
+            uint64 width  = 0;
+            uint64 height = 0;
+            std::vector<uint16_t> halfs;
+            if (useCache && cache->check(name, hash) && std::filesystem::exists(path)) {
+                FileSerializer serializer(path, true);
+                serializer.read(width);
+                serializer.read(height);
+                serializer.read(halfs);
             }
 
-            auto& res = getCurrentShaderInfo(dev).packed_images[filename]; // Get or construct resource info for given resource
-            res.counter++;
-            res.memory_usage        = packed.size();
-            return images[filename] = DevicePackedImage{ copyToDevice(dev, packed), width, height };
-        } catch (const ImageLoadException& e) {
-            IG_LOG(L_ERROR) << e.what() << std::endl;
-            return images[filename] = copyToDevicePacked(dev, MissingImage);
-        }
+            if (halfs.empty()) {
+                try {
+                    const auto img = Image::load(filename);
+                    if (expected_channels != (int32_t)img.channels) {
+                        IG_LOG(L_ERROR) << "Image '" << filename << "' is has unexpected channel count" << std::endl;
+                        return copyToDeviceHalf(dev, MissingImage);
+                    }
+
+                    const size_t clamped = TextureCompression::convertToHalf(img.pixels.get(), img.width * img.height * img.channels, halfs);
+                    if (clamped > 0)
+                        IG_LOG(L_WARNING) << "Image '" << filename << "' has " << clamped << " values exceeding the range of half floats. They are clamped to " << TextureCompression::HalfMax << std::endl;
+
+                    width  = img.width;
+                    height = img.height;
+                } catch (const ImageLoadException& e) {
+                    IG_LOG(L_ERROR) << e.what() << std::endl;
+                    return copyToDeviceHalf(dev, MissingImage);
+                }
+
+                if (useCache) {
+                    FileSerializer serializer(path, false);
+                    serializer.write(width);
+                    serializer.write(height);
+                    serializer.write(halfs);
+
+                    cache->update(name, hash);
+                    cache->sync();
+                }
+            }
+
+            trackResource(dev, filename, halfs.size() * sizeof(uint16_t), false);
+            return DeviceHalfImage{ copyToDevice(dev, halfs), (size_t)width, (size_t)height };
+        });
+    }
+
+    inline DeviceCompressedImage copyToDeviceCompressed(int32_t dev, const Image& image)
+    {
+        std::vector<uint8_t> packed;
+        image.copyToPackedFormat(packed);
+
+        std::vector<uint8_t> blocks;
+        const auto format = TextureCompression::compressBlocks(packed.data(), image.width, image.height, image.channels, blocks);
+        return DeviceCompressedImage{ copyToDevice(dev, blocks), image.width, image.height, format };
+    }
+
+    /// @brief Load image from disk in packed format, block compress it and make it resident on the device. Each image is decoded only once, cache hits are lock-free.
+    /// The compressed image is stored in the cache directory of the scene, such that it is compressed only once
+    inline const DeviceCompressedImage& loadCompressedImage(int32_t dev, const std::string& filename, int32_t expected_channels, bool linear)
+    {
+        return devices[dev].compressed_images.getOrLoad(filename, [&]() {
+            _SECTION(SectionType::CompressedImageLoading);
+
+            IG_LOG(L_DEBUG) << "Loading compressed image '" << filename << "' (C=" << expected_channels << ")" << std::endl;
+
+            const auto& cache      = scene.cache_manager;
+            const bool useCache    = cache && cache->isEnabled();
+            const std::string name = "bc_" + filename;
+            const std::string hash = useCache ? computeImageCacheHash(filename, expected_channels) + (linear ? "_linear" : "") : std::string{};
+            const Path path        = useCache ? getImageCachePath("bc", filename) : Path{};
+
+            uint64 width  = 0;
+            uint64 height = 0;
+            int32 format  = 0;
+            std::vector<uint8_t> blocks;
+            if (useCache && cache->check(name, hash) && std::filesystem::exists(path)) {
+                FileSerializer serializer(path, true);
+                serializer.read(width);
+                serializer.read(height);
+                serializer.read(format);
+                serializer.read(blocks);
+            }
+
+            if (blocks.empty()) {
+                try {
+                    std::vector<uint8_t> packed;
+                    size_t packedWidth, packedHeight, channels;
+                    Image::loadAsPacked(filename, packed, packedWidth, packedHeight, channels, linear);
+
+                    if (expected_channels != (int32_t)channels) {
+                        IG_LOG(L_ERROR) << "Packed image '" << filename << "' is has unexpected channel count" << std::endl;
+                        return copyToDeviceCompressed(dev, MissingImage);
+                    }
+
+                    format = (int32)TextureCompression::compressBlocks(packed.data(), packedWidth, packedHeight, channels, blocks);
+                    width  = packedWidth;
+                    height = packedHeight;
+                } catch (const ImageLoadException& e) {
+                    IG_LOG(L_ERROR) << e.what() << std::endl;
+                    return copyToDeviceCompressed(dev, MissingImage);
+                }
+
+                if (useCache) {
+                    FileSerializer serializer(path, false);
+                    serializer.write(width);
+                    serializer.write(height);
+                    serializer.write(format);
+                    serializer.write(blocks);
+
+                    cache->update(name, hash);
+                    cache->sync();
+                }
+            }
+
+            trackResource(dev, filename, blocks.size(), true);
+            return DeviceCompressedImage{ copyToDevice(dev, blocks), (size_t)width, (size_t)height, (TextureCompression::BlockFormat)format };
+        });
     }
 
     std::vector<uint8_t> readBufferFile(const std::string& filename)
@@ -787,23 +1233,18 @@ public:
 
     inline const DeviceBuffer& loadBuffer(int32_t dev, const std::string& filename)
     {
-        std::lock_guard<std::mutex> _guard(thread_mutex);
+        return devices[dev].file_buffers.getOrLoad(filename, [&]() {
+            _SECTION(SectionType::BufferLoading);
 
-        auto& buffers = devices[dev].buffers;
-        auto it       = buffers.find(filename);
-        if (it != buffers.end())
-            return it->second;
-
-        _SECTION(SectionType::BufferLoading);
-
-        IG_LOG(L_DEBUG) << "Loading buffer '" << filename << "'" << std::endl;
-        const auto vec = readBufferFile(filename);
-        IG_LOG(L_DEBUG) << "Finished loading buffer" << std::endl;
+            IG_LOG(L_DEBUG) << "Loading buffer '" << filename << "'" << std::endl;
+            const auto vec = readBufferFile(filename);
+            IG_LOG(L_DEBUG) << "Finished loading buffer" << std::endl;
 
-        if ((vec.size() % sizeof(int32_t)) != 0)
-            IG_LOG(L_WARNING) << "Buffer '" << filename << "' is not properly sized!" << std::endl;
+            if ((vec.size() % sizeof(int32_t)) != 0)
+                IG_LOG(L_WARNING) << "Buffer '" << filename << "' is not properly sized!" << std::endl;
 
-        return buffers[filename] = DeviceBuffer{ copyToDevice(dev, vec), 1 };
+            return DeviceBuffer{ copyToDevice(dev, vec), 1 };
+        });
     }
 
     inline DeviceBuffer& requestBuffer(int32_t dev, const std::string& name, int32_t size, int32_t flags)
@@ -948,7 +1389,9 @@ public:
     inline void releaseAll()
     {
         std::lock_guard<std::mutex> _guard(thread_mutex);
-        std::unordered_map<int32_t, DeviceData>().swap(devices);
+        devices.clear();
+        texture_cache.clear();
+        removeTemporaryTiledFiles();
     }
 
     // -------------------------------------------------------- Shader
@@ -1121,6 +1564,94 @@ public:
             getThreadData()->stats.endShaderLaunch(ShaderType::Miss, {});
     }
 
+    inline void compileLazyHitShader(LazyShader& lazy, uint32 variant, int material_id, bool background)
+    {
+        void* exec = scene.hit_shader_compiler(variant, (uint32)material_id);
+        if (exec == nullptr) {
+            // Keep rendering with the generic material instead of taking down the whole session
+            if (shader_set.FallbackHitShader.Exec == nullptr) {
+                IG_LOG(L_FATAL) << "Could not compile hit shader " << material_id << " of technique variant " << variant << " on demand" << std::endl;
+                std::abort();
+            }
+
+            IG_LOG(L_ERROR) << "Could not compile hit shader " << material_id << " of technique variant " << variant << " on demand. Using the fallback shader instead" << std::endl;
+            publishLazyHitShader(lazy, shader_set.FallbackHitShader.Exec);
+            return;
+        }
+
+        publishLazyHitShader(lazy, exec);
+        lazy_compiled_count++;
+
+        // Samples shaded by the fallback shader in the meantime have to be discarded
+        if (background)
+            lazy_shader_published = true;
+    }
+
+    inline void publishLazyHitShader(LazyShader& lazy, void* exec)
+    {
+        {
+            std::lock_guard<std::mutex> _guard(lazy.Mutex);
+            lazy.Exec.store(exec, std::memory_order_release);
+        }
+        lazy.Ready.notify_all();
+    }
+
+    /// @brief The registry of a lazy hit shader depends on whether its compilation failed and the fallback shader took its place
+    inline std::pair<void*, const ShaderOutput<void*>*> lazyHitShaderPair(void* exec, const ShaderOutput<void*>& output) const
+    {
+        if (exec == shader_set.FallbackHitShader.Exec)
+            return { exec, &shader_set.FallbackHitShader };
+        return { exec, &output };
+    }
+
+    /// @brief Get the hit shader for the given material. If lazy compilation is enabled, the shader is compiled the first time a material receives rays.
+    /// In interactive sessions the shader is compiled in the background and the generic fallback shader is used in the meantime,
+    /// else the calling thread is parked until the shader is available.
+    /// @return Pair of the callback and the shader output containing the registry for the callback
+    inline std::pair<void*, const ShaderOutput<void*>*> getHitShader(int material_id)
+    {
+        const auto& output = shader_set.HitShaders.at(material_id);
+        if (output.Exec != nullptr || !scene.hit_shader_compiler)
+            return { output.Exec, &output };
+
+        LazyShader& lazy = lazy_hit_shaders.at(shader_set.ID)[material_id];
+        if (void* exec = lazy.Exec.load(std::memory_order_acquire))
+            return lazyHitShaderPair(exec, output);
+
+        const bool useFallback = setup.IsInteractive && shader_set.FallbackHitShader.Exec != nullptr;
+        if (!lazy.Requested.exchange(true)) {
+            if (useFallback) {
+                std::lock_guard<std::mutex> _guard(lazy_compile_mutex);
+                lazy_compile_tasks.emplace_back(std::async(std::launch::async, [this, &lazy, variant = shader_set.ID, material_id]() { compileLazyHitShader(lazy, variant, material_id, true); }));
+            } else {
+                compileLazyHitShader(lazy, shader_set.ID, material_id, false);
+                return lazyHitShaderPair(lazy.Exec.load(std::memory_order_acquire), output);
+            }
+        }
+
+        if (useFallback)
+            return { shader_set.FallbackHitShader.Exec, &shader_set.FallbackHitShader };
+
+        // Another thread is already compiling the shader, park until it is available
+        std::unique_lock<std::mutex> lock(lazy.Mutex);
+        lazy.Ready.wait(lock, [&]() { return lazy.Exec.load(std::memory_order_acquire) != nullptr; });
+        return lazyHitShaderPair(lazy.Exec.load(std::memory_order_acquire), output);
+    }
+
+    /// @brief Returns true if a shader compiled in the background replaced the fallback shader since the last call
+    inline bool consumeLazyShaderUpdates()
+    {
+        return lazy_shader_published.exchange(false);
+    }
+
+    inline void waitForLazyCompilation()
+    {
+        std::lock_guard<std::mutex> _guard(lazy_compile_mutex);
+        for (auto& task : lazy_compile_tasks)
+            task.wait();
+        lazy_compile_tasks.clear();
+    }
+
     inline void runHitShader(int32_t dev, int material_id, int first, int last)
     {
         if (setup.DebugTrace)
@@ -1131,10 +1662,10 @@ public:
 
         using Callback = decltype(ig_hit_shader);
         IG_ASSERT(material_id >= 0 && material_id < (int)shader_set.HitShaders.size(), "Expected material id for hit shaders to be valid");
-        const auto& output = shader_set.HitShaders.at(material_id);
-        auto callback      = reinterpret_cast<Callback*>(output.Exec);
+        const auto [exec, output] = getHitShader(material_id);
+        auto callback             = reinterpret_cast<Callback*>(exec);
         IG_ASSERT(callback != nullptr, "Expected hit shader to be valid");
-        setCurrentShader(dev, last - first, ShaderKey(shader_set.ID, ShaderType::Hit, (uint32)material_id), output);
+        setCurrentShader(dev, last - first, ShaderKey(shader_set.ID, ShaderType::Hit, (uint32)material_id), *output);
         callback(&driver_settings, material_id, first, last);
 
         checkDebugOutput();
@@ -1269,7 +1800,7 @@ public:
             }
             return device.film_pixels.data();
         } else {
-            return host_pixels.Data.data();
+            return current_settings.film ? current_settings.film : host_pixels.Data.data();
         }
     }
 
@@ -1457,6 +1988,50 @@ public:
     }
 #endif
 
+    // -------------------------------------------------------- CPU splatting
+    inline SplatFilm* getSplatFilm(const std::string& aov_name)
+    {
+        IG_ASSERT(!is_gpu, "Should only be called if not GPU");
+
+        std::lock_guard<std::mutex> _guard(thread_mutex);
+        auto& film = splat_films[aov_name == "Color" ? std::string{} : aov_name];
+        if (!film)
+            film = std::make_unique<SplatFilm>();
+
+        // Films created in the middle of a tile pass join it directly
+        if (film->width() != film_width || film->height() != film_height) {
+            film->resize(film_width, film_height);
+            film->beginPass(splat_chunk_order);
+        }
+        return film.get();
+    }
+
+    /// Films are never removed, therefore the pointers stay valid without holding the lock
+    inline std::vector<SplatFilm*> getSplatFilms()
+    {
+        std::lock_guard<std::mutex> _guard(thread_mutex);
+
+        std::vector<SplatFilm*> films;
+        films.reserve(splat_films.size());
+        for (const auto& pair : splat_films)
+            films.push_back(pair.second.get());
+        return films;
+    }
+
+    /// Add the committed splats to the shared aovs
+    inline void mergeSplatFilms()
+    {
+        if (is_gpu || splat_films.empty())
+            return;
+
+        _SECTION(SectionType::SplatFilmMerge);
+        for (const auto& pair : splat_films) {
+            float* target = getAOVImageOnlyCPU(pair.first).Data;
+            if (target && pair.second->width() == film_width && pair.second->height() == film_height)
+                pair.second->merge(target);
+        }
+    }
+
     inline void present()
     {
         // Single thread access
@@ -1471,12 +2046,85 @@ public:
         }
     }
 
+    // -------------------------------------------------------- CPU tile scheduling
+    inline size_t beginTiles(size_t width, size_t height, size_t tile_size, size_t num_cores)
+    {
+        const size_t workers = tile_scheduler.begin(shader_set.ID, width, height, tile_size, num_cores);
+
+        // Splats are grouped by tile and committed in the order the tiles are distributed.
+        // Rays still in flight after a worker ran out of tiles, which only happens in the wavefront mode, are grouped by worker
+        const size_t tile_count = tile_scheduler.tileCount();
+        splat_chunk_order       = tile_scheduler.order();
+        for (size_t i = 0; i < workers; ++i)
+            splat_chunk_order.push_back((int32)(tile_count + i));
+
+        for (auto film : getSplatFilms())
+            film->beginPass(splat_chunk_order);
+
+        return workers;
+    }
+
+    inline int32 nextTile(size_t worker, TileScheduler::Tile& tile)
+    {
+        const int32 id = tile_scheduler.next(worker, tile);
+        tlSplatChunk   = id >= 0 ? id : (int32)(tile_scheduler.tileCount() + worker);
+        return id;
+    }
+
+    inline void finishTile(size_t worker, int32 id, uint64 rays)
+    {
+        tile_scheduler.finish(worker, id, rays);
+        for (auto film : getSplatFilms())
+            film->finishChunk((size_t)id);
+    }
+
+    inline void beginMaterialQueue(size_t material_count, size_t entity_count, size_t payload_count, bool is_payload_soa)
+    {
+        material_queue.reset(material_count, entity_count, MinPrimaryStreamSize, payload_count, is_payload_soa);
+    }
+
+    /// Move the rays [begin, end) of the current primary stream of the calling thread into the queue
+    inline void pushMaterialRays(size_t material, size_t entity, size_t begin, size_t end)
+    {
+        const auto& stream = getPrimaryStream(0, 0);
+        material_queue.push(material, entity, stream.Data.data(), stream.BlockSize, begin, end);
+    }
+
+    /// Move queued rays into the current primary stream of the calling thread, starting at offset
+    inline size_t pullMaterialRays(size_t material, size_t entity, size_t offset, size_t max_count)
+    {
+        auto& stream = getPrimaryStream(0, 0);
+        return material_queue.pull(material, entity, stream.Data.data(), stream.BlockSize, offset, max_count);
+    }
+
+    inline void endTiles()
+    {
+        IG_ASSERT(material_queue.total() == 0, "Expected all queued rays to be shaded");
+
+        for (auto film : getSplatFilms())
+            film->endPass();
+
+        const auto stats = tile_scheduler.end();
+        if (setup.AcquireStats)
+            getThreadData()->stats.addTileSchedule(stats.Wall, stats.Tail, stats.Busy, stats.Steals, stats.Splits);
+
+        if (setup.DebugTrace)
+            IG_LOG(L_DEBUG) << "TRACE> Tiles finished in " << std::chrono::duration_cast<std::chrono::microseconds>(stats.Wall).count() << "us with a tail of "
+                            << std::chrono::duration_cast<std::chrono::microseconds>(stats.Tail).count() << "us" << std::endl;
+    }
+
     inline Statistics* getFullStats()
     {
         main_stats.reset();
         for (const auto& data : thread_data)
             main_stats.add(data->stats);
 
+        if (lazy_declared_count > 0)
+            main_stats.setLazyShaderCount(lazy_compiled_count, lazy_declared_count);
+
+        if (texture_cache.budget() > 0)
+            main_stats.setTextureCacheUsage(texture_cache.evictionCount(), texture_cache.residentBytes(), texture_cache.peakBytes(), texture_cache.budget());
+
         return &main_stats;
     }
 
@@ -1585,6 +2233,11 @@ void Device::assignScene(const SceneSettings& settings)
     sInterface->assignScene(settings);
 }
 
+void Device::updateEntities(const std::vector<uint32>& entity_ids)
+{
+    sInterface->updateEntities(entity_ids);
+}
+
 void Device::render(const TechniqueVariantShaderSet& shaderSet, const Device::RenderSettings& settings, const ParameterSet* parameterSet)
 {
     enableMathMode();
@@ -1595,10 +2248,13 @@ void Device::render(const TechniqueVariantShaderSet& shaderSet, const Device::Re
     sInterface->setupShaderSet(shaderSet);
     sInterface->updateSettings(settings);
     sInterface->current_settings   = settings;
+    sInterface->render_count++;
     sInterface->current_parameters = parameterSet;
+    sInterface->texture_cache.beginFrame();
 
     sInterface->ensureFramebuffer();
     sInterface->runDeviceShader();
+    sInterface->mergeSplatFilms();
     sInterface->present();
 
 #ifdef IG_HAS_DENOISER
@@ -1606,6 +2262,9 @@ void Device::render(const TechniqueVariantShaderSet& shaderSet, const Device::Re
         sInterface->denoise();
 #endif
 
+    // The replacement film is owned by the caller and only valid for this call
+    sInterface->current_settings.film = nullptr;
+
     sInterface->unregisterThread();
 
     disableMathMode();
@@ -1641,6 +2300,11 @@ void Device::clearFramebuffer(const std::string& name)
     sInterface->clearAOV(name);
 }
 
+bool Device::consumeLazyShaderUpdates()
+{
+    return sInterface->consumeLazyShaderUpdates();
+}
+
 const Statistics* Device::getStatistics()
 {
     return sInterface->getFullStats();
@@ -1787,6 +2451,35 @@ inline void get_stream(T* dev_stream, DeviceStream& stream, size_t min_component
         r_ptr[i] = ptr + i * capacity;
 }
 
+// Used instead of the hit and miss shaders if only the closest hits are requested.
+// The rays are terminated afterwards, and as no hit shader runs, no secondary rays are spawned either
+inline void write_ray_batch_hits(int dev, int first, int last)
+{
+    IG_ASSERT(!sInterface->is_gpu, "Intersect-only ray batches are only supported on the CPU");
+
+    PrimaryStream primary;
+    SecondaryStream secondary;
+    get_stream(&primary, sInterface->getPrimaryStream(dev, 0), MinPrimaryStreamSize);
+    get_stream(&secondary, sInterface->getSecondaryStream(dev, 0), MinSecondaryStreamSize);
+
+    const RayBatchResult& hits = *sInterface->current_settings.hits;
+    const size_t spi           = std::max<size_t>(1, sInterface->current_settings.spi);
+    for (int i = first; i < last; ++i) {
+        const size_t id = (size_t)primary.rays.id[i] / spi;
+        const bool hit  = primary.ent_id[i] >= 0;
+
+        if (hits.Distance)
+            hits.Distance[id] = hit ? primary.t[i] : std::numeric_limits<float>::infinity();
+        if (hits.EntityID)
+            hits.EntityID[id] = hit ? primary.ent_id[i] : -1;
+        if (hits.PrimitiveID)
+            hits.PrimitiveID[id] = hit ? primary.prim_id[i] : -1;
+
+        primary.rays.id[i]   = -1;
+        secondary.rays.id[i] = -1;
+    }
+}
+
 } // namespace IG
 
 using IG::sInterface;
@@ -1804,6 +2497,18 @@ IG_EXPORT void ignis_get_aov_image(int dev, const char* name, float** aov_pixels
     *aov_pixels = IG::sInterface->getAOVImageForDevice(name).Data;
 }
 
+IG_EXPORT void ignis_cpu_get_splat_film(const char* name, uint8_t** handle)
+{
+    *handle = reinterpret_cast<uint8_t*>(sInterface->getSplatFilm(name ? std::string(name) : std::string{}));
+}
+
+IG_EXPORT void ignis_cpu_splat(uint8_t* handle, int32_t pixel, float r, float g, float b)
+{
+    IG_ASSERT(IG::tlSplatChunk >= 0, "Expected splats to be made inside a tile pass");
+    const float rgb[3] = { r, g, b };
+    reinterpret_cast<IG::SplatFilm*>(handle)->splat((size_t)IG::tlSplatChunk, (size_t)pixel, rgb);
+}
+
 IG_EXPORT void ignis_mark_aov_as_used(const char* name, int iter)
 {
     sInterface->markAOVAsUsed(name, iter);
@@ -1865,8 +2570,8 @@ IG_EXPORT void ignis_load_dyntable(int dev, const char* name, DynTableData* dtb)
 IG_EXPORT void ignis_load_fixtable(int dev, const char* name, uint8_t** data, int32_t* size)
 {
     auto& buf = sInterface->loadFixtable(dev, name);
-    *data     = const_cast<uint8_t*>(buf.Data.data());
-    *size     = (int32_t)buf.Data.size();
+    *data     = const_cast<uint8_t*>(buf.ptr());
+    *size     = (int32_t)buf.size();
 }
 
 IG_EXPORT void ignis_load_rays(int dev, StreamRay** list)
@@ -1874,6 +2579,12 @@ IG_EXPORT void ignis_load_rays(int dev, StreamRay** list)
     *list = const_cast<StreamRay*>(sInterface->loadRayList(dev).data());
 }
 
+IG_EXPORT void ignis_load_ray_batch(int dev, StreamRayBatch* batch)
+{
+    IG_UNUSED(dev);
+    sInterface->loadRayBatch(batch);
+}
+
 IG_EXPORT void ignis_load_image(int32_t dev, const char* file, float** pixels, int32_t* width, int32_t* height, int32_t expected_channels)
 {
     auto& img = sInterface->loadImage(dev, file, expected_channels);
@@ -1887,6 +2598,73 @@ IG_EXPORT void ignis_load_image_by_id(int32_t dev, int32_t id, float** pixels, i
     return ignis_load_image(dev, sInterface->lookupResource(id).c_str(), pixels, width, height, expected_channels);
 }
 
+IG_EXPORT void ignis_load_mip_image(int32_t dev, const char* file, float** pixels, int32_t* width, int32_t* height, int32_t* levels, int32_t expected_channels)
+{
+    auto& img = sInterface->loadMipImage(dev, file, expected_channels);
+    *pixels   = const_cast<float*>(img.Data.data());
+    *width    = (int32_t)img.Width;
+    *height   = (int32_t)img.Height;
+    *levels   = (int32_t)img.Levels;
+}
+
+IG_EXPORT void ignis_load_mip_image_by_id(int32_t dev, int32_t id, float** pixels, int32_t* width, int32_t* height, int32_t* levels, int32_t expected_channels)
+{
+    return ignis_load_mip_image(dev, sInterface->lookupResource(id).c_str(), pixels, width, height, levels, expected_channels);
+}
+
+IG_EXPORT void ignis_load_half_image(int32_t dev, const char* file, uint8_t** pixels, int32_t* width, int32_t* height, int32_t expected_channels)
+{
+    auto& img = sInterface->loadHalfImage(dev, file, expected_channels);
+    *pixels   = reinterpret_cast<uint8_t*>(const_cast<uint16_t*>(img.Data.data()));
+    *width    = (int32_t)img.Width;
+    *height   = (int32_t)img.Height;
+}
+
+IG_EXPORT void ignis_load_half_image_by_id(int32_t dev, int32_t id, uint8_t** pixels, int32_t* width, int32_t* height, int32_t expected_channels)
+{
+    return ignis_load_half_image(dev, sInterface->lookupResource(id).c_str(), pixels, width, height, expected_channels);
+}
+
+IG_EXPORT void ignis_load_compressed_image(int32_t dev, const char* file, uint8_t** blocks, int32_t* width, int32_t* height, int32_t* format, int32_t expected_channels, bool linear)
+{
+    auto& img = sInterface->loadCompressedImage(dev, file, expected_channels, linear);
+    *blocks   = const_cast<uint8_t*>(img.Data.data());
+    *width    = (int32_t)img.Width;
+    *height   = (int32_t)img.Height;
+    *format   = (int32_t)img.Format;
+}
+
+IG_EXPORT void ignis_load_compressed_image_by_id(int32_t dev, int32_t id, uint8_t** blocks, int32_t* width, int32_t* height, int32_t* format, int32_t expected_channels, bool linear)
+{
+    return ignis_load_compressed_image(dev, sInterface->lookupResource(id).c_str(), blocks, width, height, format, expected_channels, linear);
+}
+
+IG_EXPORT void ignis_load_tiled_image(int32_t dev, const char* file, int32_t* handle, int32_t* width, int32_t* height, int32_t* tile_size, int32_t expected_channels)
+{
+    auto& img  = sInterface->loadTiledImage(dev, file, expected_channels);
+    *handle    = img.Handle;
+    *width     = (int32_t)img.Width;
+    *height    = (int32_t)img.Height;
+    *tile_size = (int32_t)img.TileSize;
+}
+
+IG_EXPORT void ignis_load_tiled_image_by_id(int32_t dev, int32_t id, int32_t* handle, int32_t* width, int32_t* height, int32_t* tile_size, int32_t expected_channels)
+{
+    return ignis_load_tiled_image(dev, sInterface->lookupResource(id).c_str(), handle, width, height, tile_size, expected_channels);
+}
+
+IG_EXPORT void ignis_request_image_tile(int32_t dev, int32_t handle, int32_t tile, float** pixels)
+{
+    IG_UNUSED(dev); // Tiles are only requested from CPU kernels
+
+    IG::TexturePageCache::Access access;
+    *pixels = const_cast<float*>(sInterface->texture_cache.request(handle, (size_t)tile, access));
+
+    // Every texel fetch requests its tile, only the first request of a tile in a frame is counted
+    if (sInterface->setup.AcquireStats && access != IG::TexturePageCache::Access::Repeated)
+        sInterface->getThreadData()->stats.increase(access == IG::TexturePageCache::Access::Miss ? IG::Quantity::TextureTileMissCount : IG::Quantity::TextureTileHitCount, 1);
+}
+
 IG_EXPORT void ignis_load_packed_image(int32_t dev, const char* file, uint8_t** pixels, int32_t* width, int32_t* height, int32_t expected_channels, bool linear)
 {
     auto& img = sInterface->loadPackedImage(dev, file, expected_channels, linear);
@@ -1970,6 +2748,16 @@ IG_EXPORT void ignis_gpu_swap_secondary_streams(int dev)
     sInterface->swapGPUSecondaryStreams(dev);
 }
 
+IG_EXPORT void ignis_cpu_swap_primary_streams()
+{
+    sInterface->swapCPUPrimaryStreams();
+}
+
+IG_EXPORT void ignis_cpu_swap_secondary_streams()
+{
+    sInterface->swapCPUSecondaryStreams();
+}
+
 IG_EXPORT void ignis_register_thread()
 {
     IG::enableMathMode();
@@ -1999,12 +2787,18 @@ IG_EXPORT int ignis_handle_ray_generation(int dev, int next_id, int size, int xm
 
 IG_EXPORT void ignis_handle_miss_shader(int dev, int first, int last)
 {
-    sInterface->runMissShader(dev, first, last);
+    if (sInterface->current_settings.hits != nullptr)
+        IG::write_ray_batch_hits(dev, first, last);
+    else
+        sInterface->runMissShader(dev, first, last);
 }
 
 IG_EXPORT void ignis_handle_hit_shader(int dev, int entity_id, int first, int last)
 {
-    sInterface->runHitShader(dev, entity_id, first, last);
+    if (sInterface->current_settings.hits != nullptr)
+        IG::write_ray_batch_hits(dev, first, last);
+    else
+        sInterface->runHitShader(dev, entity_id, first, last);
 }
 
 IG_EXPORT void ignis_handle_advanced_shadow_shader(int dev, int material_id, int first, int last, bool is_hit)
@@ -2065,4 +2859,70 @@ IG_EXPORT void ignis_stats_add(int id, int value)
 
     sInterface->getThreadData()->stats.increase((IG::Quantity)id, static_cast<uint64_t>(value));
 }
+
+IG_EXPORT void ignis_stats_record(int id, float value)
+{
+    if (!sInterface->setup.AcquireStats)
+        return;
+
+    sInterface->getThreadData()->stats.record((IG::Measurement)id, value);
+}
+
+IG_EXPORT int ignis_cpu_begin_tiles(int width, int height, int tile_size, int num_cores)
+{
+    return (int)sInterface->beginTiles((size_t)width, (size_t)height, (size_t)tile_size, (size_t)std::max(0, num_cores));
+}
+
+IG_EXPORT int ignis_cpu_next_tile(int worker, CPUTile* tile)
+{
+    IG::TileScheduler::Tile next;
+    const int id = sInterface->nextTile((size_t)worker, next);
+    if (id >= 0) {
+        tile->xmin = next.XMin;
+        tile->ymin = next.YMin;
+        tile->xmax = next.XMax;
+        tile->ymax = next.YMax;
+    }
+    return id;
+}
+
+IG_EXPORT void ignis_cpu_finish_tile(int worker, int id, int rays)
+{
+    sInterface->finishTile((size_t)worker, id, (IG::uint64)std::max(0, rays));
+}
+
+IG_EXPORT void ignis_cpu_end_tiles()
+{
+    sInterface->endTiles();
+}
+
+IG_EXPORT void ignis_cpu_begin_material_queue(int num_materials, int num_entities, int payload_count, bool is_payload_soa)
+{
+    sInterface->beginMaterialQueue((size_t)std::max(0, num_materials), (size_t)std::max(0, num_entities), (size_t)std::max(0, payload_count), is_payload_soa);
+}
+
+IG_EXPORT void ignis_cpu_push_material_rays(int material, int entity, int begin, int end)
+{
+    sInterface->pushMaterialRays((size_t)material, (size_t)entity, (size_t)begin, (size_t)end);
+}
+
+IG_EXPORT int ignis_cpu_pull_material_rays(int material, int entity, int offset, int max_count)
+{
+    return (int)sInterface->pullMaterialRays((size_t)material, (size_t)entity, (size_t)offset, (size_t)std::max(0, max_count));
+}
+
+IG_EXPORT int ignis_cpu_queued_material_rays(int material)
+{
+    return (int)sInterface->material_queue.queued((size_t)material);
+}
+
+IG_EXPORT int ignis_cpu_queued_entity_rays(int entity)
+{
+    return (int)sInterface->material_queue.queuedEntity((size_t)entity);
+}
+
+IG_EXPORT int ignis_cpu_queued_rays()
+{
+    return (int)sInterface->material_queue.total();
+}
 }
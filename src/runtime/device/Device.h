@@ -8,6 +8,7 @@
 
 namespace IG {
 
+class CacheManager;
 class Statistics;
 struct SceneDatabase;
 
@@ -20,6 +21,8 @@ public:
         bool AcquireStats  = false;
         bool DebugTrace    = false;
         bool IsInteractive = false;
+
+        size_t TextureCacheBudget = 0; // Bytes of texture tiles kept resident by the page cache. Only used by tiled images on the CPU
     };
 
     struct SceneSettings {
@@ -27,10 +30,16 @@ public:
         const std::vector<std::string>* aov_map       = nullptr;
         const std::vector<std::string>* resource_map  = nullptr;
         const std::vector<int32>* entity_per_material = nullptr; // Contains number of entities per unique material
+        std::shared_ptr<CacheManager> cache_manager   = nullptr; // Used to keep generated resources, e.g., mip pyramids, across runs. Can be null
+
+        /// Compiles the hit shader of the given variant and material on demand. Only set if lazy shader compilation is enabled
+        std::function<void*(uint32 /* variant */, uint32 /* material */)> hit_shader_compiler = nullptr;
     };
 
     struct RenderSettings {
-        const Ray* rays  = nullptr; // If non-null, width contains the number of rays and height is set to 1
+        const RayBatch* rays       = nullptr; // If non-null, width contains the number of rays and height is set to 1
+        const RayBatchResult* hits = nullptr; // If non-null, hit and miss shaders are skipped and the closest hits are written instead. Only supported on the CPU
+        float* film                = nullptr; // If non-null, replaces the framebuffer for this call. Has to be of framebuffer size. Only supported on the CPU
         size_t spi       = 8;
         size_t width     = 0;
         size_t height    = 0;
@@ -50,6 +59,8 @@ public:
     ~Device();
 
     void assignScene(const SceneSettings& settings);
+    /// Upload the given entities and the scene bvhs after their transforms were updated in the assigned scene database
+    void updateEntities(const std::vector<uint32>& entity_ids);
     void render(const TechniqueVariantShaderSet& shader_set, const RenderSettings& settings, const ParameterSet* parameter_set);
     void resize(size_t width, size_t height);
 
@@ -65,6 +76,10 @@ public:
     void clearFramebuffer(const std::string& name);
     void clearAllFramebuffer();
 
+    /// @brief Returns true if a hit shader compiled in the background replaced the fallback shader since the last call.
+    /// Everything rendered in the meantime used the fallback shader and should be discarded
+    [[nodiscard]] bool consumeLazyShaderUpdates();
+
     [[nodiscard]] const Statistics* getStatistics();
 
     void tonemap(uint32_t*, const TonemapSettings&);
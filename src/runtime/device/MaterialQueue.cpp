@@ -0,0 +1,112 @@
+#include "MaterialQueue.h"
+#include "Logger.h"
+
+#include <algorithm>
+
+namespace IG {
+MaterialQueue::MaterialQueue()
+    : mMaterialCounts()
+    , mBins()
+    , mTotal(0)
+    , mMaterialCount(0)
+    , mEntityCount(0)
+    , mComponentCount(0)
+    , mPayloadCount(0)
+    , mSoAPayload(false)
+{
+}
+
+MaterialQueue::~MaterialQueue()
+{
+}
+
+void MaterialQueue::reset(size_t materialCount, size_t entityCount, size_t componentCount, size_t payloadCount, bool soaPayload)
+{
+    if (materialCount != mMaterialCount) {
+        mMaterialCounts = std::make_unique<std::atomic<size_t>[]>(materialCount);
+        mMaterialCount  = materialCount;
+    }
+
+    if (entityCount != mEntityCount) {
+        mBins        = std::make_unique<Bin[]>(entityCount);
+        mEntityCount = entityCount;
+    }
+
+    // The records of the last pass are only left if the pass was aborted. Keep the memory, as the next pass is likely similar
+    for (size_t i = 0; i < mMaterialCount; ++i)
+        mMaterialCounts[i] = 0;
+    for (size_t i = 0; i < mEntityCount; ++i) {
+        mBins[i].Records.clear();
+        mBins[i].Count = 0;
+    }
+    mTotal = 0;
+
+    mComponentCount = componentCount;
+    mPayloadCount   = payloadCount;
+    mSoAPayload     = soaPayload;
+}
+
+void MaterialQueue::push(size_t material, size_t entity, const float* stream, size_t capacity, size_t begin, size_t end)
+{
+    IG_ASSERT(material < mMaterialCount, "Expected material to be part of the current pass");
+    IG_ASSERT(entity < mEntityCount, "Expected entity to be part of the current pass");
+    IG_ASSERT(begin <= end && end <= capacity, "Expected range to be inside the stream");
+
+    const size_t count = end - begin;
+    if (count == 0)
+        return;
+
+    Bin& bin = mBins[entity];
+    {
+        std::lock_guard<std::mutex> _guard(bin.Mutex);
+
+        const size_t start = bin.Records.size();
+        bin.Records.resize(start + count * recordSize());
+
+        float* record = bin.Records.data() + start;
+        for (size_t i = begin; i < end; ++i) {
+            for (size_t c = 0; c < recordSize(); ++c)
+                *(record++) = stream[componentIndex(i, c, capacity)];
+        }
+
+        bin.Count += count;
+    }
+
+    mMaterialCounts[material] += count;
+    mTotal += count;
+}
+
+size_t MaterialQueue::pull(size_t material, size_t entity, float* stream, size_t capacity, size_t offset, size_t maxCount)
+{
+    IG_ASSERT(material < mMaterialCount, "Expected material to be part of the current pass");
+    IG_ASSERT(entity < mEntityCount, "Expected entity to be part of the current pass");
+    IG_ASSERT(offset + maxCount <= capacity, "Expected range to be inside the stream");
+
+    Bin& bin = mBins[entity];
+
+    size_t count = 0;
+    {
+        std::lock_guard<std::mutex> _guard(bin.Mutex);
+
+        // Take the most recently pushed rays, which keeps the removal cheap
+        count = std::min(maxCount, bin.Records.size() / recordSize());
+        if (count == 0)
+            return 0;
+
+        const size_t start  = bin.Records.size() - count * recordSize();
+        const float* record = bin.Records.data() + start;
+        for (size_t i = offset; i < offset + count; ++i) {
+            for (size_t c = 0; c < recordSize(); ++c)
+                stream[componentIndex(i, c, capacity)] = *(record++);
+        }
+
+        bin.Records.resize(start);
+        bin.Count -= count;
+    }
+
+    // Decrease the counters only after the rays are in the stream of the caller, such that a queue reported as empty is really empty
+    mMaterialCounts[material] -= count;
+    mTotal -= count;
+    return count;
+}
+} // namespace IG
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "IG_Config.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace IG {
+/// Queues of hits waiting to be shaded, one per material, which are shared by all CPU workers of a wavefront pass.
+/// Workers move hits of entities with too few rays to fill a vector into the queue and pull them back as soon as enough rays are queued,
+/// or when they ran out of tiles. The queue of a material is split by entity, as the CPU hit shader is called per entity.
+/// A ray is stored as a record of all the stream components followed by the payload, the layout of the stream is given by reset()
+class IG_LIB MaterialQueue {
+public:
+    MaterialQueue();
+    ~MaterialQueue();
+
+    /// @brief Prepare a new pass. All rays still queued are dropped
+    /// @param materialCount Number of materials
+    /// @param entityCount Number of entities
+    /// @param componentCount Number of components of a stream entry without the payload
+    /// @param payloadCount Number of payload components of a stream entry
+    /// @param soaPayload True if the payload is stored component by component, false if stored ray by ray
+    void reset(size_t materialCount, size_t entityCount, size_t componentCount, size_t payloadCount, bool soaPayload);
+
+    /// @brief Copy the rays [begin, end) of the stream into the queue. All rays have to hit the given entity. Thread-safe
+    void push(size_t material, size_t entity, const float* stream, size_t capacity, size_t begin, size_t end);
+
+    /// @brief Move at most maxCount rays of the given entity into the stream, starting at offset. Thread-safe
+    /// @return Number of rays moved
+    size_t pull(size_t material, size_t entity, float* stream, size_t capacity, size_t offset, size_t maxCount);
+
+    /// @brief Number of rays queued for the given material. Lock-free, therefore only a snapshot
+    [[nodiscard]] inline size_t queued(size_t material) const { return mMaterialCounts[material].load(); }
+    /// @brief Number of rays queued for the given entity. Lock-free, therefore only a snapshot
+    [[nodiscard]] inline size_t queuedEntity(size_t entity) const { return mBins[entity].Count.load(); }
+    /// @brief Number of rays queued in total. Lock-free, therefore only a snapshot
+    [[nodiscard]] inline size_t total() const { return mTotal.load(); }
+
+    /// @brief Number of floats per stored ray
+    [[nodiscard]] inline size_t recordSize() const { return mComponentCount + mPayloadCount; }
+
+private:
+    struct Bin {
+        std::mutex Mutex;
+        std::vector<float> Records;
+        std::atomic<size_t> Count = 0;
+    };
+
+    inline size_t componentIndex(size_t i, size_t c, size_t capacity) const
+    {
+        if (c < mComponentCount || mSoAPayload)
+            return c * capacity + i;
+        else
+            return mComponentCount * capacity + i * mPayloadCount + (c - mComponentCount);
+    }
+
+    std::unique_ptr<std::atomic<size_t>[]> mMaterialCounts;
+    std::unique_ptr<Bin[]> mBins; // Per entity
+    std::atomic<size_t> mTotal;
+    size_t mMaterialCount;
+    size_t mEntityCount;
+
+    size_t mComponentCount;
+    size_t mPayloadCount;
+    bool mSoAPayload;
+};
+} // namespace IG
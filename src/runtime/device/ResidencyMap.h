@@ -0,0 +1,68 @@
+#pragma once
+
+#include "IG_Config.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include <tbb/concurrent_unordered_map.h>
+#include <tbb/task_arena.h>
+
+namespace IG {
+/// Thread-safe cache for device resources which are loaded on demand.
+/// Lookups of already resident resources are lock-free. A missing resource is constructed exactly once by the first thread requesting it,
+/// while other threads only wait if they request the very same resource. Different resources are loaded in parallel.
+/// References returned by the map stay valid until the map is cleared.
+template <typename T>
+class ResidencyMap {
+public:
+    ResidencyMap()  = default;
+    ~ResidencyMap() = default;
+
+    /// @brief Get the resource with the given key or construct it via the given loader if not yet resident.
+    /// @param key Unique key of the resource
+    /// @param loader Function returning a T. Will be called at most once per key, except if it throws
+    /// @return Reference to the resident resource
+    template <typename Func>
+    inline const T& getOrLoad(const std::string& key, Func&& loader)
+    {
+        auto it = mEntries.find(key);
+        if (it == mEntries.end())
+            it = mEntries.emplace(key, std::make_unique<Entry>()).first; // If another thread was faster, our entry is just dropped
+
+        Entry* entry = it->second.get();
+        std::call_once(entry->Flag, [&]() {
+            // The loader might make use of parallel constructs itself (e.g., image decoding).
+            // Isolate it to prevent this thread from stealing outer tasks which might request the same resource again.
+            tbb::this_task_arena::isolate([&]() { entry->Value = loader(); });
+        });
+        return entry->Value;
+    }
+
+    /// @brief Get the resource with the given key if already resident. This is not thread-safe and should only be called if no other thread accesses the map
+    /// @return Pointer to the resource or null if not yet requested
+    [[nodiscard]] inline T* find(const std::string& key)
+    {
+        auto it = mEntries.find(key);
+        return it == mEntries.end() ? nullptr : &it->second->Value;
+    }
+
+    /// @brief Number of requested resources, including the ones currently loading
+    [[nodiscard]] inline size_t size() const { return mEntries.size(); }
+
+    /// @brief Remove the resource with the given key, such that it is loaded again on the next request. This is not thread-safe and should only be called if no other thread accesses the map
+    inline void erase(const std::string& key) { mEntries.unsafe_erase(key); }
+
+    /// @brief Remove all resources. This is not thread-safe and should only be called if no other thread accesses the map
+    inline void clear() { mEntries.clear(); }
+
+private:
+    struct Entry {
+        std::once_flag Flag;
+        T Value;
+    };
+
+    tbb::concurrent_unordered_map<std::string, std::unique_ptr<Entry>> mEntries;
+};
+} // namespace IG
@@ -40,6 +40,18 @@ public:
 
     inline ~ShallowArray() = default;
 
+    /// Synchronize the range [offset, offset + n) with the host array the array was created from.
+    /// The host array might have been reallocated in the meantime, but has to keep its size
+    inline void update(const T* ptr, size_t offset, size_t n)
+    {
+        if (device != 0) {
+            if (n != 0)
+                anydsl_copy(0, ptr, sizeof(T) * offset, device, device_mem.data(), sizeof(T) * offset, sizeof(T) * n);
+        } else {
+            host_mem = ptr;
+        }
+    }
+
     inline const anydsl::Array<T>& device_data() const { return device_mem; }
     inline const T* host_data() const { return host_mem; }
 
@@ -0,0 +1,202 @@
+#include "SplatFilm.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include <tbb/parallel_for.h>
+
+namespace IG {
+constexpr size_t TilePixelCount   = SplatFilm::TileSize * SplatFilm::TileSize;
+constexpr uint32 EmptyPixel       = std::numeric_limits<uint32>::max();
+constexpr size_t InitialChunkSize = 256; // Entries, has to be a power of two
+
+// Finalizer of MurmurHash3, spreads neighboring pixels over the whole table
+static inline uint32 hashPixel(uint32 pixel)
+{
+    pixel ^= pixel >> 16;
+    pixel *= 0x85ebca6b;
+    pixel ^= pixel >> 13;
+    pixel *= 0xc2b2ae35;
+    pixel ^= pixel >> 16;
+    return pixel;
+}
+
+SplatFilm::SplatFilm()
+    : mPixels(nullptr, &std::free)
+    , mDirty()
+    , mWidth(0)
+    , mHeight(0)
+    , mNextCommit(0)
+{
+}
+
+SplatFilm::~SplatFilm()
+{
+}
+
+void SplatFilm::resize(size_t width, size_t height)
+{
+    if (width == mWidth && height == mHeight)
+        return;
+
+    IG_ASSERT(width * height < EmptyPixel, "Expected pixel indices to fit into 32 bit");
+
+    mWidth  = width;
+    mHeight = height;
+
+    // Large allocations via calloc are mapped lazily, untouched tiles therefore cost no physical memory
+    mPixels.reset(static_cast<float*>(std::calloc(tileCount() * TilePixelCount * 3, sizeof(float))));
+    if (!mPixels && tileCount() > 0) {
+        IG_LOG(L_FATAL) << "Out of memory" << std::endl;
+        std::abort();
+    }
+
+    mDirty = std::make_unique<uint8[]>(tileCount());
+    std::fill_n(mDirty.get(), tileCount(), (uint8)0);
+
+    clearPass();
+}
+
+void SplatFilm::clearPass()
+{
+    mChunks.clear();
+    mOrder.clear();
+    mNextCommit = 0;
+}
+
+void SplatFilm::beginPass(const std::vector<int32>& order)
+{
+    clearPass();
+
+    mOrder = order;
+    mChunks.resize(order.size());
+}
+
+void SplatFilm::splat(size_t chunkID, size_t pixel, const float* rgb)
+{
+    IG_ASSERT(chunkID < mChunks.size(), "Expected chunk to be part of the current pass");
+    IG_ASSERT(pixel < mWidth * mHeight, "Expected pixel to be inside the film");
+
+    Chunk& chunk   = mChunks[chunkID];
+    auto& entries  = chunk.Entries;
+    const uint32 p = (uint32)pixel;
+
+    // Keep the load factor below one half
+    if (2 * (chunk.UsedEntries + 1) > entries.size()) {
+        std::vector<Entry> old = std::move(entries);
+        entries.assign(std::max(InitialChunkSize, 2 * old.size()), Entry{ EmptyPixel, { 0, 0, 0 } });
+
+        const size_t mask = entries.size() - 1;
+        for (const auto& entry : old) {
+            if (entry.Pixel == EmptyPixel)
+                continue;
+
+            size_t slot = hashPixel(entry.Pixel) & mask;
+            while (entries[slot].Pixel != EmptyPixel)
+                slot = (slot + 1) & mask;
+            entries[slot] = entry;
+        }
+    }
+
+    const size_t mask = entries.size() - 1;
+    size_t slot       = hashPixel(p) & mask;
+    while (entries[slot].Pixel != p && entries[slot].Pixel != EmptyPixel)
+        slot = (slot + 1) & mask;
+
+    Entry& entry = entries[slot];
+    if (entry.Pixel == EmptyPixel) {
+        entry.Pixel = p;
+        ++chunk.UsedEntries;
+    }
+
+    for (size_t i = 0; i < 3; ++i)
+        entry.RGB[i] += rgb[i];
+}
+
+void SplatFilm::finishChunk(size_t chunkID)
+{
+    IG_ASSERT(chunkID < mChunks.size(), "Expected chunk to be part of the current pass");
+
+    std::lock_guard<std::mutex> _guard(mMutex);
+    mChunks[chunkID].Finished = true;
+    commitFinished();
+}
+
+void SplatFilm::commitFinished()
+{
+    const size_t tilesX = tileCountX();
+    while (mNextCommit < mOrder.size()) {
+        Chunk& chunk = mChunks[mOrder[mNextCommit]];
+        if (!chunk.Finished)
+            break;
+
+        // Every pixel is contained at most once per chunk, therefore the order of the entries does not change the result
+        for (const auto& entry : chunk.Entries) {
+            if (entry.Pixel == EmptyPixel)
+                continue;
+
+            const size_t x    = entry.Pixel % mWidth;
+            const size_t y    = entry.Pixel / mWidth;
+            const size_t tile = (y / TileSize) * tilesX + x / TileSize;
+
+            float* pixel = mPixels.get() + tile * TilePixelCount * 3 + ((y % TileSize) * TileSize + x % TileSize) * 3;
+            for (size_t i = 0; i < 3; ++i)
+                pixel[i] += entry.RGB[i];
+            mDirty[tile] = 1;
+        }
+
+        // Release the memory right away, the next chunks might touch completely different pixels
+        std::vector<Entry>().swap(chunk.Entries);
+        chunk.UsedEntries = 0;
+
+        ++mNextCommit;
+    }
+}
+
+void SplatFilm::endPass()
+{
+    for (size_t i = 0; i < mChunks.size(); ++i) {
+        if (!mChunks[i].Finished)
+            finishChunk(i);
+    }
+    IG_ASSERT(mNextCommit == mOrder.size(), "Expected all chunks to be committed");
+}
+
+size_t SplatFilm::pendingBytes() const
+{
+    size_t bytes = 0;
+    for (const auto& chunk : mChunks)
+        bytes += chunk.Entries.capacity() * sizeof(Entry);
+    return bytes;
+}
+
+void SplatFilm::merge(float* target)
+{
+    const size_t tilesX = tileCountX();
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, tileCount()),
+        [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t tile = range.begin(); tile < range.end(); ++tile) {
+                if (!mDirty[tile])
+                    continue;
+
+                const size_t x0 = (tile % tilesX) * TileSize;
+                const size_t y0 = (tile / tilesX) * TileSize;
+                const size_t w  = std::min(TileSize, mWidth - x0);
+                const size_t h  = std::min(TileSize, mHeight - y0);
+
+                float* src = mPixels.get() + tile * TilePixelCount * 3;
+                for (size_t y = 0; y < h; ++y) {
+                    float* dst = target + ((y0 + y) * mWidth + x0) * 3;
+                    for (size_t i = 0; i < w * 3; ++i)
+                        dst[i] += src[y * TileSize * 3 + i];
+                }
+
+                std::memset(src, 0, TilePixelCount * 3 * sizeof(float));
+                mDirty[tile] = 0;
+            }
+        });
+}
+} // namespace IG
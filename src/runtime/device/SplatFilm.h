@@ -0,0 +1,78 @@
+#pragma once
+
+#include "IG_Config.h"
+
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace IG {
+/// Film for splats reaching arbitrary pixels, e.g., from light tracing.
+/// Splats are grouped by work chunk, i.e., the tile handed out by the CPU tile scheduler. Every chunk accumulates into a sparse map of the pixels it touched,
+/// which merges repeated splats to the same pixel. Finished chunks are committed to the film in a fixed order of the chunks,
+/// such that the result does not depend on the number of threads or the scheduling, as long as the splats of every chunk are made in a fixed order.
+/// The memory per chunk in flight is proportional to the number of distinct pixels it touched, and is released as soon as the chunk is committed
+class IG_LIB SplatFilm {
+public:
+    static constexpr size_t TileSize = 64; // Committed splats are stored tile by tile, which keeps untouched tiles out of the merge
+
+    SplatFilm();
+    ~SplatFilm();
+
+    /// @brief Resize the film if the given size differs from the current one. All splats are lost in that case
+    void resize(size_t width, size_t height);
+
+    [[nodiscard]] inline size_t width() const { return mWidth; }
+    [[nodiscard]] inline size_t height() const { return mHeight; }
+    [[nodiscard]] inline size_t tileCountX() const { return (mWidth + TileSize - 1) / TileSize; }
+    [[nodiscard]] inline size_t tileCountY() const { return (mHeight + TileSize - 1) / TileSize; }
+    [[nodiscard]] inline size_t tileCount() const { return tileCountX() * tileCountY(); }
+
+    /// @brief Prepare a new pass. The chunks are committed in the given order, which has to contain every chunk of the pass exactly once
+    void beginPass(const std::vector<int32>& order);
+
+    /// @brief Add the given rgb value to the pixel given in scanline order.
+    /// Only a single thread is allowed to splat to a chunk at a time, different chunks can be accessed concurrently
+    void splat(size_t chunk, size_t pixel, const float* rgb);
+    inline void splat(size_t chunk, size_t x, size_t y, const float* rgb) { splat(chunk, y * mWidth + x, rgb); }
+
+    /// @brief Mark the chunk as finished and commit every finished chunk next in order. Thread-safe
+    void finishChunk(size_t chunk);
+
+    /// @brief Finish all remaining chunks of the pass. Not thread-safe with respect to the other functions
+    void endPass();
+
+    /// @brief Add the committed splats to the given rgb film in scanline order and clear them afterwards. The target is expected to have the same size as the film
+    void merge(float* target);
+
+    /// @brief Bytes held by chunks not committed yet. Not thread-safe with respect to the other functions
+    [[nodiscard]] size_t pendingBytes() const;
+
+private:
+    struct Entry {
+        uint32 Pixel; // EmptyPixel if unused
+        float RGB[3];
+    };
+
+    struct Chunk {
+        std::vector<Entry> Entries; // Open addressing with linear probing, the size is a power of two
+        size_t UsedEntries = 0;
+        bool Finished      = false;
+    };
+
+    void commitFinished();
+    void clearPass();
+
+    std::unique_ptr<float, decltype(&std::free)> mPixels; // Committed splats, stored tile by tile
+    std::unique_ptr<uint8[]> mDirty;                       // Per tile, set by every commit
+    size_t mWidth;
+    size_t mHeight;
+
+    std::vector<Chunk> mChunks;
+    std::vector<int32> mOrder;
+    size_t mNextCommit; // Position in mOrder
+
+    std::mutex mMutex; // Guards the commits
+};
+} // namespace IG
@@ -16,6 +16,8 @@ Target::Target()
     , mDevice(0)
     , mThreadCount(0)
     , mVectorWidth(1)
+    , mCPURaySortMode(CPURaySortMode::Counting)
+    , mCPUWavefront(false)
 {
 }
 
@@ -83,6 +85,15 @@ GPUArchitecture Target::getGPUArchitectureFromString(const std::string& str)
         return GPUArchitecture::Unknown;
 }
 
+CPURaySortMode Target::getCPURaySortModeFromString(const std::string& str)
+{
+    const std::string lstr = to_lowercase(str);
+    if (lstr == "swap")
+        return CPURaySortMode::Swap;
+    else
+        return CPURaySortMode::Counting;
+}
+
 std::vector<std::string> Target::getAvailableCPUArchitectureNames()
 {
     return { "ARM", "x86" };
@@ -93,6 +104,11 @@ std::vector<std::string> Target::getAvailableGPUArchitectureNames()
     return { "AMD", "Intel", "Nvidia" };
 }
 
+std::vector<std::string> Target::getAvailableCPURaySortModeNames()
+{
+    return { "Swap", "Counting" };
+}
+
 static inline CPUArchitecture getCPUArchitecture()
 {
 #if defined(IG_CPU_ARM)
@@ -16,6 +16,12 @@ enum class CPUArchitecture {
     Unknown
 };
 
+/// Algorithm used to sort ray streams by material on the CPU
+enum class CPURaySortMode {
+    Swap,    // In-place sort, swapping entries one element at a time
+    Counting // Out-of-place counting sort into a back buffer
+};
+
 class IG_LIB Target {
 public:
     Target();
@@ -35,6 +41,11 @@ public:
     inline void setThreadCount(size_t d) { mThreadCount = d; }
     [[nodiscard]] inline size_t vectorWidth() const { return mVectorWidth; }
     inline void setVectorWidth(size_t d) { mVectorWidth = d; }
+    [[nodiscard]] inline CPURaySortMode cpuRaySortMode() const { return mCPURaySortMode; }
+    inline void setCPURaySortMode(CPURaySortMode mode) { mCPURaySortMode = mode; }
+    /// Keep a persistent ray stream per thread which is refilled across tiles instead of draining it at the end of each tile
+    [[nodiscard]] inline bool useCPUWavefront() const { return mCPUWavefront; }
+    inline void setCPUWavefront(bool b) { mCPUWavefront = b; }
 
     [[nodiscard]] std::string toString() const;
 
@@ -51,9 +62,11 @@ public:
 
     [[nodiscard]] static CPUArchitecture getCPUArchitectureFromString(const std::string& str);
     [[nodiscard]] static GPUArchitecture getGPUArchitectureFromString(const std::string& str);
+    [[nodiscard]] static CPURaySortMode getCPURaySortModeFromString(const std::string& str);
 
     [[nodiscard]] static std::vector<std::string> getAvailableCPUArchitectureNames();
     [[nodiscard]] static std::vector<std::string> getAvailableGPUArchitectureNames();
+    [[nodiscard]] static std::vector<std::string> getAvailableCPURaySortModeNames();
 
 private:
     bool mInitialized;
@@ -65,6 +78,8 @@ private:
     size_t mDevice;
     size_t mThreadCount;
     size_t mVectorWidth;
+    CPURaySortMode mCPURaySortMode;
+    bool mCPUWavefront;
 };
 
 } // namespace IG
\ No newline at end of file
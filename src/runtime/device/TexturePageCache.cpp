@@ -0,0 +1,262 @@
+#include "TexturePageCache.h"
+#include "Image.h"
+#include "Logger.h"
+
+#include <algorithm>
+
+namespace IG {
+// Width, height, channels and tile size
+constexpr size_t HeaderSize = 4 * sizeof(uint64);
+
+TexturePageCache::TexturePageCache(size_t budget)
+    : mBudget(budget)
+    , mFrame(1)
+    , mResident(0)
+    , mPeak(0)
+    , mEvictions(0)
+{
+}
+
+TexturePageCache::~TexturePageCache()
+{
+    clear();
+}
+
+void TexturePageCache::writeTiledImage(const Image& image, const Path& path, size_t tileSize)
+{
+    IG_ASSERT(tileSize > 0, "Expected valid tile size");
+
+    ImageInfo info;
+    info.Width    = image.width;
+    info.Height   = image.height;
+    info.Channels = image.channels;
+    info.TileSize = tileSize;
+
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream)
+        throw std::runtime_error("Could not open '" + path.generic_string() + "' for writing");
+
+    const uint64 header[4] = { info.Width, info.Height, info.Channels, info.TileSize };
+    stream.write(reinterpret_cast<const char*>(header), HeaderSize);
+
+    std::vector<float> tile(info.tileBytes() / sizeof(float));
+    for (size_t ty = 0; ty < info.tileCountY(); ++ty) {
+        for (size_t tx = 0; tx < info.tileCountX(); ++tx) {
+            copyTile(image, info, tx, ty, tile.data());
+            stream.write(reinterpret_cast<const char*>(tile.data()), info.tileBytes());
+        }
+    }
+
+    if (!stream)
+        throw std::runtime_error("Could not write tiled image '" + path.generic_string() + "'");
+}
+
+void TexturePageCache::copyTile(const Image& image, const ImageInfo& info, size_t tx, size_t ty, float* tile)
+{
+    std::fill(tile, tile + info.tileBytes() / sizeof(float), 0.0f);
+
+    const size_t x0 = tx * info.TileSize;
+    const size_t y0 = ty * info.TileSize;
+    const size_t w  = std::min(info.TileSize, info.Width - x0);
+    const size_t h  = std::min(info.TileSize, info.Height - y0);
+    for (size_t y = 0; y < h; ++y) {
+        const float* src = image.pixels.get() + ((y0 + y) * info.Width + x0) * info.Channels;
+        std::copy(src, src + w * info.Channels, tile + y * info.TileSize * info.Channels);
+    }
+}
+
+std::unique_ptr<TexturePageCache::Entry> TexturePageCache::createEntry(const ImageInfo& info)
+{
+    auto entry  = std::make_unique<Entry>();
+    entry->Info = info;
+
+    const size_t tileCount = info.tileCount();
+    entry->Tiles           = std::make_unique<std::atomic<float*>[]>(tileCount);
+    entry->Stamps          = std::make_unique<std::atomic<uint32>[]>(tileCount);
+    for (size_t i = 0; i < tileCount; ++i) {
+        entry->Tiles[i].store(nullptr, std::memory_order_relaxed);
+        entry->Stamps[i].store(0, std::memory_order_relaxed);
+    }
+
+    return entry;
+}
+
+int32 TexturePageCache::addEntry(std::unique_ptr<Entry>&& entry)
+{
+    const auto it = mEntries.push_back(std::move(entry));
+    return (int32)std::distance(mEntries.begin(), it);
+}
+
+int32 TexturePageCache::registerImage(const Path& path)
+{
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream) {
+        IG_LOG(L_ERROR) << "Could not open tiled image '" << path << "'" << std::endl;
+        return -1;
+    }
+
+    uint64 header[4] = { 0, 0, 0, 0 };
+    stream.read(reinterpret_cast<char*>(header), HeaderSize);
+    if (!stream || header[0] == 0 || header[1] == 0 || header[2] == 0 || header[3] == 0) {
+        IG_LOG(L_ERROR) << "Invalid tiled image '" << path << "'" << std::endl;
+        return -1;
+    }
+
+    ImageInfo info;
+    info.Width    = header[0];
+    info.Height   = header[1];
+    info.Channels = header[2];
+    info.TileSize = header[3];
+
+    auto entry    = createEntry(info);
+    entry->Stream = std::move(stream);
+    return addEntry(std::move(entry));
+}
+
+int32 TexturePageCache::registerResidentImage(const Image& image, size_t tileSize)
+{
+    IG_ASSERT(tileSize > 0, "Expected valid tile size");
+
+    ImageInfo info;
+    info.Width    = image.width;
+    info.Height   = image.height;
+    info.Channels = image.channels;
+    info.TileSize = tileSize;
+
+    // The tiles are never added to the eviction queue, therefore they stay resident until clear()
+    auto entry = createEntry(info);
+    for (size_t ty = 0; ty < info.tileCountY(); ++ty) {
+        for (size_t tx = 0; tx < info.tileCountX(); ++tx) {
+            float* tile = new float[info.tileBytes() / sizeof(float)];
+            copyTile(image, info, tx, ty, tile);
+            entry->Tiles[ty * info.tileCountX() + tx].store(tile, std::memory_order_relaxed);
+        }
+    }
+
+    return addEntry(std::move(entry));
+}
+
+const TexturePageCache::ImageInfo& TexturePageCache::info(int32 handle) const
+{
+    IG_ASSERT(handle >= 0 && (size_t)handle < mEntries.size(), "Expected valid image handle");
+    return mEntries[handle]->Info;
+}
+
+const float* TexturePageCache::request(int32 handle, size_t tile, Access& access)
+{
+    IG_ASSERT(handle >= 0 && (size_t)handle < mEntries.size(), "Expected valid image handle");
+    Entry& entry = *mEntries[handle];
+    IG_ASSERT(tile < entry.Info.tileCount(), "Expected tile index to be in bounds");
+
+    // Mark the tile as used before accessing it. Together with tryEvict() this guarantees that a tile used in the current frame stays resident.
+    // Both rely on sequentially consistent ordering, the exchange is only issued once per frame to prevent contention on popular tiles
+    const uint32 frame     = mFrame.load(std::memory_order_relaxed);
+    const bool firstAccess = entry.Stamps[tile].load() != frame && entry.Stamps[tile].exchange(frame) != frame;
+
+    access = firstAccess ? Access::Hit : Access::Repeated;
+
+    float* pixels = entry.Tiles[tile].load();
+    if (pixels)
+        return pixels;
+
+    const size_t bytes = entry.Info.tileBytes();
+    {
+        std::lock_guard<std::mutex> _guard(entry.Mutex);
+        pixels = entry.Tiles[tile].load();
+        if (pixels) {
+            access = Access::Repeated; // Another thread was faster and counts the miss
+            return pixels;
+        }
+
+        pixels = new float[bytes / sizeof(float)];
+        entry.Stream.seekg(HeaderSize + tile * bytes);
+        entry.Stream.read(reinterpret_cast<char*>(pixels), bytes);
+        if (!entry.Stream) {
+            IG_LOG(L_ERROR) << "Could not read tile " << tile << " of tiled image " << handle << std::endl;
+            std::fill(pixels, pixels + bytes / sizeof(float), 0.0f);
+            entry.Stream.clear();
+        }
+
+        entry.Tiles[tile].store(pixels);
+    }
+
+    access = Access::Miss;
+
+    std::lock_guard<std::mutex> _guard(mMutex);
+    mQueue.push_back(TileRef{ handle, (uint32)tile });
+
+    const size_t resident = mResident.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    if (resident > mPeak.load(std::memory_order_relaxed))
+        mPeak.store(resident, std::memory_order_relaxed);
+
+    if (resident > mBudget)
+        evict();
+
+    return pixels;
+}
+
+size_t TexturePageCache::beginFrame()
+{
+    std::lock_guard<std::mutex> _guard(mMutex);
+    mFrame.fetch_add(1);
+
+    // Order by last use, such that the least recently used tiles are evicted first
+    const auto stamp = [&](const TileRef& ref) { return mEntries[ref.Handle]->Stamps[ref.Tile].load(std::memory_order_relaxed); };
+    std::stable_sort(mQueue.begin(), mQueue.end(), [&](const TileRef& a, const TileRef& b) { return stamp(a) < stamp(b); });
+
+    return evict();
+}
+
+size_t TexturePageCache::evict()
+{
+    // Every tile is visited at most once, tiles used in the current frame are moved to the back of the queue
+    size_t evicted   = 0;
+    size_t remaining = mQueue.size();
+    while (remaining > 0 && mResident.load(std::memory_order_relaxed) > mBudget) {
+        const TileRef ref = mQueue.front();
+        mQueue.pop_front();
+        --remaining;
+
+        if (tryEvict(ref))
+            ++evicted;
+        else
+            mQueue.push_back(ref);
+    }
+
+    mEvictions.fetch_add(evicted, std::memory_order_relaxed);
+    return evicted;
+}
+
+bool TexturePageCache::tryEvict(const TileRef& ref)
+{
+    Entry& entry = *mEntries[ref.Handle];
+    std::lock_guard<std::mutex> _guard(entry.Mutex);
+
+    // Unpublish first, then check for concurrent use. A shader either sees the missing tile and waits for the entry lock, or we see its stamp
+    float* pixels = entry.Tiles[ref.Tile].exchange(nullptr);
+    if (!pixels)
+        return true;
+
+    if (entry.Stamps[ref.Tile].load() == mFrame.load()) {
+        entry.Tiles[ref.Tile].store(pixels);
+        return false;
+    }
+
+    delete[] pixels;
+    mResident.fetch_sub(entry.Info.tileBytes(), std::memory_order_relaxed);
+    return true;
+}
+
+void TexturePageCache::clear()
+{
+    std::lock_guard<std::mutex> _guard(mMutex);
+    for (auto& entry : mEntries) {
+        for (size_t i = 0; i < entry->Info.tileCount(); ++i)
+            delete[] entry->Tiles[i].exchange(nullptr);
+    }
+
+    mEntries.clear();
+    mQueue.clear();
+    mResident.store(0);
+}
+} // namespace IG
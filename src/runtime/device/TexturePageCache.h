@@ -0,0 +1,114 @@
+#pragma once
+
+#include "IG_Config.h"
+
+#include <atomic>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+#include <tbb/concurrent_vector.h>
+
+namespace IG {
+struct Image;
+
+/// Demand-paged cache for textures stored in a tiled file format.
+/// Textures are converted once into a tiled file and single tiles are read from it the first time they are requested by a shader.
+/// Tiles exceeding the memory budget are evicted in least recently used order, with the granularity of a frame.
+/// Tiles requested in the current frame are never evicted, as shaders might still access them.
+/// The budget is therefore exceeded temporarily if a single frame touches more tiles than fit into it.
+class IG_LIB TexturePageCache {
+public:
+    static constexpr size_t DefaultTileSize = 64;
+
+    /// Outcome of a tile request. Only the first request of a tile in a frame is a hit or miss, such that single texel fetches are not counted
+    enum class Access {
+        Repeated = 0, // Tile was already requested in the current frame
+        Hit,          // Tile was resident
+        Miss          // Tile had to be read from the file
+    };
+
+    struct ImageInfo {
+        size_t Width    = 0;
+        size_t Height   = 0;
+        size_t Channels = 0;
+        size_t TileSize = 0;
+
+        [[nodiscard]] inline size_t tileCountX() const { return (Width + TileSize - 1) / TileSize; }
+        [[nodiscard]] inline size_t tileCountY() const { return (Height + TileSize - 1) / TileSize; }
+        [[nodiscard]] inline size_t tileCount() const { return tileCountX() * tileCountY(); }
+        [[nodiscard]] inline size_t tileBytes() const { return TileSize * TileSize * Channels * sizeof(float); }
+    };
+
+    /// @param budget Maximum number of bytes of tiles kept resident
+    explicit TexturePageCache(size_t budget);
+    ~TexturePageCache();
+
+    /// @brief Write the given image as a tiled file. Tiles at the right and bottom border are padded with zeros
+    static void writeTiledImage(const Image& image, const Path& path, size_t tileSize = DefaultTileSize);
+
+    /// @brief Open a tiled file written by writeTiledImage. Thread-safe with respect to all other functions except clear()
+    /// @return Handle used to request tiles or -1 if the file could not be opened
+    int32 registerImage(const Path& path);
+
+    /// @brief Register the image with all tiles kept in memory, without any file. The tiles are never evicted and do not count towards the budget.
+    /// Intended for small fallback images. Thread-safe with respect to all other functions except clear()
+    /// @return Handle used to request tiles
+    int32 registerResidentImage(const Image& image, size_t tileSize = DefaultTileSize);
+
+    [[nodiscard]] const ImageInfo& info(int32 handle) const;
+
+    /// @brief Get the pixels of the given tile, reading them from the file if not resident. Thread-safe.
+    /// The returned memory stays valid at least until the next call to beginFrame()
+    /// @param handle Handle returned by registerImage
+    /// @param tile Index of the tile in row major order
+    /// @param access Set to the outcome of the request
+    [[nodiscard]] const float* request(int32 handle, size_t tile, Access& access);
+
+    /// @brief Start a new frame and evict tiles until the budget is met. Must not be called while shaders request tiles
+    /// @return Number of evicted tiles
+    size_t beginFrame();
+
+    /// @brief Number of tiles evicted since construction, including the ones evicted by beginFrame()
+    [[nodiscard]] inline size_t evictionCount() const { return mEvictions.load(std::memory_order_relaxed); }
+    [[nodiscard]] inline size_t residentBytes() const { return mResident.load(std::memory_order_relaxed); }
+    [[nodiscard]] inline size_t peakBytes() const { return mPeak.load(std::memory_order_relaxed); }
+    [[nodiscard]] inline size_t budget() const { return mBudget; }
+
+    /// @brief Release all tiles and images. Handles are invalid afterwards. Must not be called while shaders request tiles
+    void clear();
+
+private:
+    struct Entry {
+        ImageInfo Info;
+        std::ifstream Stream;
+        std::mutex Mutex; // Guards the stream and the publication of tiles
+        std::unique_ptr<std::atomic<float*>[]> Tiles;
+        std::unique_ptr<std::atomic<uint32>[]> Stamps; // Frame of the last request
+    };
+
+    struct TileRef {
+        int32 Handle;
+        uint32 Tile;
+    };
+
+    static void copyTile(const Image& image, const ImageInfo& info, size_t tx, size_t ty, float* tile);
+    static std::unique_ptr<Entry> createEntry(const ImageInfo& info);
+    int32 addEntry(std::unique_ptr<Entry>&& entry);
+
+    size_t evict();
+    bool tryEvict(const TileRef& ref);
+
+    const size_t mBudget;
+    tbb::concurrent_vector<std::unique_ptr<Entry>> mEntries;
+
+    std::mutex mMutex; // Guards the queue
+    std::deque<TileRef> mQueue;
+
+    std::atomic<uint32> mFrame;
+    std::atomic<size_t> mResident;
+    std::atomic<size_t> mPeak;
+    std::atomic<size_t> mEvictions;
+};
+} // namespace IG
@@ -0,0 +1,231 @@
+#include "TileScheduler.h"
+
+#include <algorithm>
+#include <numeric>
+#include <thread>
+
+namespace IG {
+using Clock = std::chrono::high_resolution_clock;
+
+// A pass should have at least this many tiles to balance out the tail.
+// The tiles do not depend on the number of workers, such that splats are grouped the same way for every thread count
+constexpr size_t MinTilesPerPass = 256;
+// Heavy tiles are split in at most this many strips
+constexpr size_t MaxSplitsPerTile = 8;
+
+TileScheduler::TileScheduler()
+    : mSteals(0)
+    , mSplits(0)
+{
+}
+
+TileScheduler::~TileScheduler()
+{
+}
+
+size_t TileScheduler::begin(size_t key, size_t width, size_t height, size_t tileSize, size_t workers)
+{
+    if (workers == 0)
+        workers = std::max<size_t>(1, std::thread::hardware_concurrency());
+
+    const size_t numTilesX = (width + tileSize - 1) / tileSize;
+    const size_t numTilesY = (height + tileSize - 1) / tileSize;
+    const size_t numTiles  = numTilesX * numTilesY;
+
+    // Costs of the previous pass are only meaningful if the layout did not change
+    Layout& layout = mLayouts[key];
+    if (layout.Width != width || layout.Height != height || layout.TileSize != tileSize || layout.Costs.size() != numTiles) {
+        layout.Width    = width;
+        layout.Height   = height;
+        layout.TileSize = tileSize;
+        layout.Costs.clear();
+        layout.Costs.reserve(numTiles);
+
+        // Without any measurement we assume the cost to be proportional to the number of pixels
+        for (size_t y = 0; y < numTilesY; ++y) {
+            for (size_t x = 0; x < numTilesX; ++x) {
+                const size_t w = std::min(tileSize, width - x * tileSize);
+                const size_t h = std::min(tileSize, height - y * tileSize);
+                layout.Costs.push_back(std::max<uint64>(1, w * h));
+            }
+        }
+    }
+    mCurrentLayout = &layout;
+
+    const uint64 totalCost = std::accumulate(layout.Costs.begin(), layout.Costs.end(), uint64(0));
+    const uint64 meanCost  = numTiles > 0 ? totalCost / numTiles : 0;
+    const uint64 splitCost = std::max<uint64>(2 * meanCost, totalCost / MinTilesPerPass);
+
+    // Construct tiles and split the heavy ones into horizontal strips
+    mTiles.clear();
+    mSplits = 0;
+    for (size_t y = 0; y < numTilesY; ++y) {
+        for (size_t x = 0; x < numTilesX; ++x) {
+            const int32 base = (int32)(y * numTilesX + x);
+            const int32 xmin = (int32)(x * tileSize);
+            const int32 ymin = (int32)(y * tileSize);
+            const int32 xmax = (int32)std::min(width, (x + 1) * tileSize);
+            const int32 ymax = (int32)std::min(height, (y + 1) * tileSize);
+            const uint64 cost = layout.Costs[base];
+
+            size_t parts = 1;
+            if (splitCost > 0 && cost > splitCost)
+                parts = std::min<size_t>({ (size_t)((cost + splitCost - 1) / splitCost), (size_t)(ymax - ymin), MaxSplitsPerTile });
+
+            if (parts <= 1) {
+                mTiles.push_back(Tile{ xmin, ymin, xmax, ymax, base, cost });
+            } else {
+                const int32 tileHeight = ymax - ymin;
+                for (size_t i = 0; i < parts; ++i) {
+                    const int32 s = ymin + (int32)(i * tileHeight / parts);
+                    const int32 e = ymin + (int32)((i + 1) * tileHeight / parts);
+                    mTiles.push_back(Tile{ xmin, s, xmax, e, base, std::max<uint64>(1, cost * (e - s) / tileHeight) });
+                }
+                mSplits += parts - 1;
+            }
+        }
+    }
+
+    // Distribute the most expensive tiles first, always to the worker with the least load (LPT)
+    mOrder.resize(mTiles.size());
+    std::iota(mOrder.begin(), mOrder.end(), 0);
+    std::stable_sort(mOrder.begin(), mOrder.end(), [&](int32 a, int32 b) { return mTiles[a].Cost > mTiles[b].Cost; });
+
+    if (mQueues.size() != workers) {
+        mQueues.clear();
+        for (size_t i = 0; i < workers; ++i)
+            mQueues.emplace_back(std::make_unique<Queue>());
+    }
+
+    std::vector<uint64> load(workers, 0);
+    for (auto& queue : mQueues) {
+        queue->Items.clear();
+        queue->Busy = Timer::duration(0);
+        queue->Done = false;
+    }
+
+    for (int32 id : mOrder) {
+        const size_t worker = std::distance(load.begin(), std::min_element(load.begin(), load.end()));
+        load[worker] += mTiles[id].Cost;
+        mQueues[worker]->Items.push_back(id);
+    }
+
+    for (size_t i = 0; i < workers; ++i)
+        mQueues[i]->Remaining = load[i];
+
+    mMeasuredRays = std::make_unique<std::atomic<uint64>[]>(numTiles);
+    for (size_t i = 0; i < numTiles; ++i)
+        mMeasuredRays[i] = 0;
+
+    mSteals = 0;
+    mStart  = Clock::now();
+    return workers;
+}
+
+bool TileScheduler::pop(size_t worker, int32& id)
+{
+    Queue& queue = *mQueues[worker];
+    std::lock_guard<std::mutex> _guard(queue.Mutex);
+    if (queue.Items.empty())
+        return false;
+
+    id = queue.Items.front();
+    queue.Items.pop_front();
+    queue.Remaining -= mTiles[id].Cost;
+    return true;
+}
+
+bool TileScheduler::steal(size_t worker, int32& id)
+{
+    while (true) {
+        // Steal from the worker with the most remaining work. The loads are only approximate, therefore retry if the victim ran empty in the meantime
+        size_t victim = worker;
+        uint64 max    = 0;
+        for (size_t i = 0; i < mQueues.size(); ++i) {
+            const uint64 remaining = mQueues[i]->Remaining;
+            if (i != worker && remaining > max) {
+                victim = i;
+                max    = remaining;
+            }
+        }
+
+        if (victim == worker)
+            return false;
+
+        // Take the cheapest tile of the victim, as it is the last one the victim would process itself
+        Queue& queue = *mQueues[victim];
+        std::lock_guard<std::mutex> _guard(queue.Mutex);
+        if (queue.Items.empty())
+            continue;
+
+        id = queue.Items.back();
+        queue.Items.pop_back();
+        queue.Remaining -= mTiles[id].Cost;
+        mSteals++;
+        return true;
+    }
+}
+
+int32 TileScheduler::next(size_t worker, Tile& tile)
+{
+    IG_ASSERT(worker < mQueues.size(), "Invalid worker id");
+
+    int32 id = -1;
+    if (!pop(worker, id) && !steal(worker, id)) {
+        Queue& queue = *mQueues[worker];
+        queue.Idle   = Clock::now();
+        queue.Done   = true;
+        return -1;
+    }
+
+    tile                        = mTiles[id];
+    mQueues[worker]->TileStart = Clock::now();
+    return id;
+}
+
+void TileScheduler::finish(size_t worker, int32 id, uint64 rays)
+{
+    IG_ASSERT(worker < mQueues.size(), "Invalid worker id");
+    IG_ASSERT(id >= 0 && (size_t)id < mTiles.size(), "Invalid tile id");
+
+    Queue& queue = *mQueues[worker];
+    queue.Busy += Clock::now() - queue.TileStart;
+    mMeasuredRays[mTiles[id].Base] += rays;
+}
+
+TileScheduler::PassStats TileScheduler::end()
+{
+    IG_ASSERT(mCurrentLayout != nullptr, "Expected begin() to be called first");
+
+    const auto now = Clock::now();
+
+    PassStats stats;
+    stats.Wall   = now - mStart;
+    stats.Steals = mSteals;
+    stats.Splits = mSplits;
+    stats.Busy.reserve(mQueues.size());
+
+    auto firstIdle = now;
+    auto lastIdle  = mStart;
+    for (const auto& queue : mQueues) {
+        stats.Busy.push_back(queue->Busy);
+
+        // A worker might not have been started at all if the underlying thread pool is smaller than requested
+        if (queue->Done) {
+            firstIdle = std::min(firstIdle, queue->Idle);
+            lastIdle  = std::max(lastIdle, queue->Idle);
+        }
+    }
+    stats.Tail = lastIdle > firstIdle ? lastIdle - firstIdle : Timer::duration(0);
+
+    // Update costs for the next pass with the same layout
+    for (size_t i = 0; i < mCurrentLayout->Costs.size(); ++i) {
+        const uint64 rays = mMeasuredRays[i];
+        if (rays > 0)
+            mCurrentLayout->Costs[i] = rays;
+    }
+
+    mCurrentLayout = nullptr;
+    return stats;
+}
+} // namespace IG
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Timer.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace IG {
+/// Schedules the tiles of a CPU render pass onto a fixed number of workers.
+/// Tiles are ordered by their cost, which is the number of rays traced in the tile during the previous pass with the same layout.
+/// Heavy tiles are split into smaller strips, and workers running out of work steal the remaining strips from other workers.
+class TileScheduler {
+public:
+    struct Tile {
+        int32 XMin;
+        int32 YMin;
+        int32 XMax;
+        int32 YMax;
+        int32 Base; // Index of the tile in the regular tile grid
+        uint64 Cost;
+    };
+
+    struct PassStats {
+        Timer::duration Wall = Timer::duration(0);
+        Timer::duration Tail = Timer::duration(0); // Time between the first and the last worker running out of work
+        std::vector<Timer::duration> Busy;         // Per worker
+        size_t Steals = 0;
+        size_t Splits = 0;
+    };
+
+    TileScheduler();
+    ~TileScheduler();
+
+    /// @brief Prepare a new pass. The cost of the tiles is reset if the layout changed since the last pass
+    /// @param key Identifies the workload, e.g., the technique variant. Different keys do not share costs
+    /// @param width Width of the region to render
+    /// @param height Height of the region to render
+    /// @param tileSize Edge length of a regular tile
+    /// @param workers Number of workers. Zero will use the hardware concurrency
+    /// @return The actual number of workers
+    size_t begin(size_t key, size_t width, size_t height, size_t tileSize, size_t workers);
+
+    /// @brief Get the next tile for the given worker. Thread-safe with respect to other workers
+    /// @return Index of the tile to be used in finish() or -1 if no work is left
+    int32 next(size_t worker, Tile& tile);
+
+    /// @brief Mark the tile acquired by next() as finished. Thread-safe with respect to other workers
+    void finish(size_t worker, int32 id, uint64 rays);
+
+    /// @brief Number of tiles in the current pass. Tile indices given by next() are below this number
+    [[nodiscard]] inline size_t tileCount() const { return mTiles.size(); }
+    /// @brief Tile indices of the current pass in the order they are distributed, i.e., sorted by cost.
+    /// Only depends on the tile costs, not on the number of workers
+    [[nodiscard]] inline const std::vector<int32>& order() const { return mOrder; }
+
+    /// @brief End the current pass and update the tile costs
+    /// @return Timings of the finished pass
+    PassStats end();
+
+private:
+    struct Queue {
+        std::mutex Mutex;
+        std::deque<int32> Items; // Sorted by cost, front is the most expensive
+        std::atomic<uint64> Remaining{ 0 };
+        Timer::duration Busy = Timer::duration(0);
+        Timer::time_point TileStart;
+        Timer::time_point Idle;
+        bool Done = false;
+    };
+
+    bool pop(size_t worker, int32& id);
+    bool steal(size_t worker, int32& id);
+
+    struct Layout {
+        size_t Width    = 0;
+        size_t Height   = 0;
+        size_t TileSize = 0;
+        std::vector<uint64> Costs; // Per regular tile
+    };
+    std::unordered_map<size_t, Layout> mLayouts;
+    Layout* mCurrentLayout = nullptr;
+
+    std::vector<Tile> mTiles;
+    std::vector<int32> mOrder;
+    std::vector<std::unique_ptr<Queue>> mQueues;
+    std::unique_ptr<std::atomic<uint64>[]> mMeasuredRays; // Per regular tile
+    std::atomic<size_t> mSteals;
+    size_t mSplits;
+    Timer::time_point mStart;
+};
+} // namespace IG
@@ -1,11 +1,14 @@
 #include "AreaLight.h"
+#include "CDF.h"
 #include "Logger.h"
 #include "loader/LoaderEntity.h"
 #include "loader/LoaderShape.h"
 #include "loader/LoaderUtils.h"
 #include "loader/Parser.h"
 #include "loader/ShadingTree.h"
+#include "serialization/FileSerializer.h"
 #include "serialization/VectorSerializer.h"
+#include "shape/TriMeshProvider.h"
 #include "table/SceneDatabase.h"
 
 namespace IG {
@@ -34,8 +37,40 @@ static inline float approximate_ellipsoid_area(const Transformf& transform, floa
     return 4 * Pi * std::pow((std::pow(w * h, P) + std::pow(w * d, P) + std::pow(h * d, P)) / 3, 1 / P);
 }
 
+// The triangle samplers of all area lights share a single buffer, such that embedded lights can reference them by offset
+struct TriangleSamplerData {
+    std::vector<float> Data;
+    Path File;
+};
+
+static std::shared_ptr<TriangleSamplerData> get_triangle_sampler_data(const LoaderContext& ctx)
+{
+    const std::string exported_id = "_area_light_triangle_samplers_";
+
+    const auto data = ctx.Cache->ExportedData.find(exported_id);
+    if (data != ctx.Cache->ExportedData.end())
+        return std::any_cast<std::shared_ptr<TriangleSamplerData>>(data->second);
+
+    auto samplers                        = std::make_shared<TriangleSamplerData>();
+    ctx.Cache->ExportedData[exported_id] = samplers;
+    return samplers;
+}
+
+Path AreaLight::setupTriangleSamplers(const LoaderContext& ctx)
+{
+    auto samplers = get_triangle_sampler_data(ctx);
+    if (samplers->File.empty()) {
+        samplers->File = ctx.CacheManager->directory() / "area_light_triangles.bin";
+
+        FileSerializer serializer(samplers->File, false);
+        serializer.write(samplers->Data, true);
+    }
+    return samplers->File;
+}
+
 AreaLight::AreaLight(const std::string& name, const LoaderContext& ctx, const std::shared_ptr<SceneObject>& light)
     : Light(name, light->pluginType())
+    , mTriangleSamplerOffset(0)
     , mLight(light)
 {
     mEntity   = light->property("entity").getString();
@@ -66,9 +101,13 @@ AreaLight::AreaLight(const std::string& name, const LoaderContext& ctx, const st
         Vector3f y_axis   = entity->Transform.linear() * shape.YAxis;
         Vector3f normal   = x_axis.cross(y_axis).normalized();
 
-        mPosition  = origin + x_axis * 0.5f + y_axis * 0.5f;
-        mDirection = normal;
-        mArea      = x_axis.cross(y_axis).norm();
+        mPosition    = origin + x_axis * 0.5f + y_axis * 0.5f;
+        mDirection   = normal;
+        mArea        = x_axis.cross(y_axis).norm();
+        mBoundingBox = BoundingBox(origin);
+        mBoundingBox.extend(origin + x_axis);
+        mBoundingBox.extend(origin + y_axis);
+        mBoundingBox.extend(origin + x_axis + y_axis);
     } break;
     case RepresentationType::Sphere: {
         IG_LOG(L_DEBUG) << "Using specialized sphere sampler for area light '" << name << "'" << std::endl;
@@ -76,9 +115,10 @@ AreaLight::AreaLight(const std::string& name, const LoaderContext& ctx, const st
         const auto& shape = ctx.Shapes->getSphereShape(entity->ShapeID);
         Vector3f origin   = entity->Transform * shape.Origin;
 
-        mPosition  = origin;
-        mDirection = Vector3f::Zero();
-        mArea      = approximate_ellipsoid_area(entity->Transform, shape.Radius);
+        mPosition    = origin;
+        mDirection   = Vector3f::Zero();
+        mArea        = approximate_ellipsoid_area(entity->Transform, shape.Radius);
+        mBoundingBox = BoundingBox(shape.Origin - Vector3f::Constant(shape.Radius), shape.Origin + Vector3f::Constant(shape.Radius)).transformed(entity->Transform);
     } break;
     default:
     case RepresentationType::None:
@@ -86,9 +126,10 @@ AreaLight::AreaLight(const std::string& name, const LoaderContext& ctx, const st
             const auto& shape    = ctx.Shapes->getShape(entity->ShapeID);
             const auto& trishape = ctx.Shapes->getTriShape(entity->ShapeID);
 
-            mPosition  = entity->Transform * shape.BoundingBox.center();
-            mDirection = Vector3f::Zero();
-            mArea      = trishape.Area * approximate_area_scale(entity->Transform, shape.BoundingBox);
+            mPosition    = entity->Transform * shape.BoundingBox.center();
+            mDirection   = Vector3f::Zero();
+            mArea        = trishape.Area * approximate_area_scale(entity->Transform, shape.BoundingBox);
+            mBoundingBox = shape.BoundingBox.transformed(entity->Transform);
         } else {
             IG_LOG(L_ERROR) << "Given entity '" << mEntity << "' primitive type is not triangular" << std::endl;
         }
@@ -104,6 +145,17 @@ void AreaLight::precompute(ShadingTree& tree)
     if (!mUsingPower)
         mColor_Cache *= mArea * Pi;
     mIsSimple = output.WasConstant;
+
+    if (mRepresentation == RepresentationType::None) {
+        const auto& ctx   = tree.context();
+        const auto entity = ctx.Entities->getEmissiveEntity(mEntity);
+        if (entity.has_value() && ctx.Shapes->isTriShape(entity->ShapeID)) {
+            // Triangles are selected proportional to their area, which matches their power for uniform emission
+            auto samplers          = get_triangle_sampler_data(ctx);
+            mTriangleSamplerOffset = samplers->Data.size() / 4;
+            CDF::computeAliasForArray(TriMeshProvider::computeFaceAreas(ctx, entity->ShapeID, entity->Transform), samplers->Data);
+        }
+    }
 }
 
 float AreaLight::computeFlux(ShadingTree& tree) const
@@ -170,7 +222,10 @@ void AreaLight::serialize(const SerializationInput& input) const
                          << ", " << tri.NormalCount
                          << ", " << tri.TexCount << ");" << std::endl
                          << "  let ae_" << light_id << " = make_shape_area_emitter(" << LoaderUtils::inlineEntity(*entity)
-                         << ", make_trimesh_shape(trimesh_" << light_id << "));" << std::endl;
+                         << ", make_trimesh_shape(trimesh_" << light_id << ")"
+                         << ", cdf::make_alias_table_1d_from_buffer(device.load_buffer(\"" << setupTriangleSamplers(input.Tree.context()).generic_u8string() << "\")"
+                         << ", " << tri.FaceCount
+                         << ", " << mTriangleSamplerOffset << "));" << std::endl;
         } else {
             // Error already messaged
             input.Tree.signalError();
@@ -264,7 +319,7 @@ void AreaLight::embed(const EmbedInput& input) const
             input.Serializer.write(normalMat, true);                          // +3x3 = 33
             input.Serializer.write((uint32)entity->ShapeID);                  // +1   = 34
             input.Serializer.write((float)std::abs(normalMat.determinant())); // +1   = 35
-            input.Serializer.write((uint32)0 /*Padding*/);                    // +1   = 36
+            input.Serializer.write((uint32)mTriangleSamplerOffset);           // +1   = 36
             input.Serializer.write(radiance);                                 // +3   = 39
             input.Serializer.write((uint32)0 /*Padding*/);                    // +1   = 40
         } else {
@@ -12,6 +12,8 @@ public:
     virtual std::optional<Vector3f> position() const override { return mPosition; }
     virtual std::optional<Vector3f> direction() const override { return mRepresentation == RepresentationType::Plane ? std::make_optional(mDirection) : std::nullopt; }
     virtual std::optional<std::string> entity() const override { return mEntity; }
+    virtual BoundingBox boundingBox() const override { return mBoundingBox; }
+    virtual LightCone emissionCone() const override { return mRepresentation == RepresentationType::Plane ? LightCone::Hemisphere(mDirection) : LightCone::Sphere(); }
     virtual void precompute(ShadingTree&) override;
     virtual float computeFlux(ShadingTree&) const override;
 
@@ -20,9 +22,14 @@ public:
     virtual std::optional<std::string> getEmbedClass() const override;
     virtual void embed(const EmbedInput& input) const override;
 
+    /// @brief Write the triangle samplers of all mesh based area lights to a single buffer and return its path
+    static Path setupTriangleSamplers(const LoaderContext& ctx);
+
 private:
     Vector3f mPosition;
     Vector3f mDirection; // ~ Normal
+    BoundingBox mBoundingBox;
+    size_t mTriangleSamplerOffset; // Given in entries of four floats
     float mArea;
     std::string mEntity;
     bool mUsingPower;
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "LightCone.h"
 #include "SceneObjectProxy.h"
+#include "math/BoundingBox.h"
 
 namespace IG {
 class ShadingTree;
@@ -23,6 +25,11 @@ public:
     virtual std::optional<Vector3f> direction() const { return std::nullopt; }
     virtual std::optional<std::string> entity() const { return std::nullopt; }
 
+    /// @brief Spatial extent of a finite light, used by the light hierarchy
+    virtual BoundingBox boundingBox() const { return BoundingBox(position().value_or(Vector3f::Zero())); }
+    /// @brief Directions a finite light emits into, used by the light hierarchy
+    virtual LightCone emissionCone() const { return LightCone::Sphere(); }
+
     virtual void precompute(ShadingTree&) { }
     virtual float computeFlux(ShadingTree&) const { return 0; }
 
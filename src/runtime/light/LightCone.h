@@ -0,0 +1,61 @@
+#pragma once
+
+#include "IG_Config.h"
+
+namespace IG {
+/// @brief Bound of the directions a light or a group of lights emits into.
+/// Based on:
+/// Conty Estevez, A., Kulla, C. (2018). Importance Sampling of Many Lights with Adaptive Tree Splitting.
+/// Proc. ACM Comput. Graph. Interact. Tech. 1, 2, Article 25. https://doi.org/10.1145/3233305
+struct LightCone {
+    Vector3f Axis = Vector3f::UnitZ();
+    float ThetaO  = Pi;  // Spread of the normals around the axis
+    float ThetaE  = Pi2; // Spread of the emission around a normal
+
+    inline LightCone() = default;
+    inline LightCone(const Vector3f& axis, float thetaO, float thetaE)
+        : Axis(axis)
+        , ThetaO(thetaO)
+        , ThetaE(thetaE)
+    {
+    }
+
+    /// @brief Cone emitting into all directions, like a point light
+    [[nodiscard]] inline static LightCone Sphere() { return LightCone(Vector3f::UnitZ(), Pi, Pi2); }
+    /// @brief Cone of a one-sided diffuse emitter with the given normal
+    [[nodiscard]] inline static LightCone Hemisphere(const Vector3f& normal) { return LightCone(normal, 0, Pi2); }
+
+    /// @brief Orientation measure used by the surface area orientation heuristic
+    [[nodiscard]] inline float measure() const
+    {
+        const float thetaW = std::min(ThetaO + ThetaE, Pi);
+        const float cosO   = std::cos(ThetaO);
+        const float sinO   = std::sin(ThetaO);
+        return 2 * Pi * (1 - cosO) + Pi2 * (2 * thetaW * sinO - std::cos(ThetaO - 2 * thetaW) - 2 * ThetaO * sinO + cosO);
+    }
+
+    /// @brief Smallest cone containing both given cones
+    [[nodiscard]] inline static LightCone merge(const LightCone& a, const LightCone& b)
+    {
+        if (b.ThetaO > a.ThetaO)
+            return merge(b, a);
+
+        const float thetaD = std::acos(std::clamp(a.Axis.dot(b.Axis), -1.0f, 1.0f));
+        const float thetaE = std::max(a.ThetaE, b.ThetaE);
+        if (std::min(thetaD + b.ThetaO, Pi) <= a.ThetaO)
+            return LightCone(a.Axis, a.ThetaO, thetaE);
+
+        const float thetaO = (a.ThetaO + thetaD + b.ThetaO) / 2;
+        if (thetaO >= Pi)
+            return LightCone(a.Axis, Pi, thetaE);
+
+        // Rotate the axis of a towards b such that both cones are covered
+        const Vector3f rotAxis = a.Axis.cross(b.Axis);
+        if (rotAxis.squaredNorm() <= FltEps)
+            return LightCone(a.Axis, Pi, thetaE); // Opposite axes
+
+        const Vector3f axis = Eigen::AngleAxisf(thetaO - a.ThetaO, rotAxis.normalized()) * a.Axis;
+        return LightCone(axis.normalized(), thetaO, thetaE);
+    }
+};
+} // namespace IG
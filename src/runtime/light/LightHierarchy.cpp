@@ -1,84 +1,42 @@
 #include "LightHierarchy.h"
 #include "Light.h"
-#include "container/PointBvh.h"
+#include "LightTree.h"
 #include "loader/LoaderContext.h"
 #include "loader/ShadingTree.h"
 #include "serialization/FileSerializer.h"
 
 #include "Logger.h"
 
+#include <chrono>
+
 namespace IG {
-class LightEntry : public ISerializable {
+class LightNodeEntry : public ISerializable {
 public:
-    Vector3f Position;
-    Vector3f Direction;
-    float Flux;
-    int32 ID;
+    LightTree::Node Node;
 
-    inline LightEntry() = default;
-    inline LightEntry(const Vector3f& pos, const Vector3f& dir, float flux, int32 id)
+    inline explicit LightNodeEntry(const LightTree::Node& node)
         : ISerializable()
-        , Position(pos)
-        , Direction(dir)
-        , Flux(flux)
-        , ID(id)
+        , Node(node)
     {
     }
-    virtual ~LightEntry() = default;
+    virtual ~LightNodeEntry() = default;
 
     inline void serialize(Serializer& serializer) override
     {
-        serializer.write(Position);
-        serializer.write(Flux);
-        serializer.write(Direction);
-        serializer.write(ID);
-        // 8 floats
+        serializer.write(Node.BBox.min);
+        serializer.write(Node.Flux);
+        serializer.write(Node.BBox.max);
+        serializer.write(Node.Index);
+        serializer.write(Node.Cone.Axis);
+        serializer.write(std::cos(Node.Cone.ThetaO));
+        serializer.write(std::cos(Node.Cone.ThetaE));
+        serializer.write((uint32)0 /*Padding*/);
+        serializer.write((uint32)0 /*Padding*/);
+        serializer.write((uint32)0 /*Padding*/);
+        // 16 floats
     }
 };
 
-template <>
-struct DefaultPositionGetter<LightEntry> {
-    inline Vector3f operator()(const LightEntry& p) const
-    {
-        return p.Position;
-    }
-};
-
-using LightBvh = PointBvh<LightEntry>;
-
-inline static LightEntry populateInnerNodes(size_t id, uint32 code, uint32 depth, const LightBvh& bvh, std::vector<LightEntry>& entries, std::vector<uint32>& codes)
-{
-    const auto& node = bvh.innerNodes().at(id);
-    auto& entry      = entries[id];
-    if (node.isLeaf()) {
-        const auto leaf = bvh.leafNodes().at(node.Index);
-        entry           = leaf;
-        codes[leaf.ID]  = code;
-    } else {
-        const auto left  = populateInnerNodes(node.leftIndex(), code, depth + 1, bvh, entries, codes);
-        const auto right = populateInnerNodes(node.rightIndex(), code | (0x1 << depth), depth + 1, bvh, entries, codes);
-
-        entry.Position = node.BBox.center();
-        entry.ID       = -int32(node.leftIndex() + 1);
-
-        // Handle delta cases
-        if (left.Flux < 0 && right.Flux < 0) {
-            entry.Direction = Vector3f::UnitZ();
-            entry.Flux      = left.Flux + right.Flux;
-        } else if (left.Flux < 0) {
-            entry.Direction = Vector3f::UnitZ();
-            entry.Flux      = -(-left.Flux + right.Flux);
-        } else if (right.Flux < 0) {
-            entry.Direction = Vector3f::UnitZ();
-            entry.Flux      = -(left.Flux - right.Flux);
-        } else {
-            entry.Direction = (left.Direction + right.Direction).normalized();
-            entry.Flux      = left.Flux + right.Flux;
-        }
-    }
-    return entry;
-}
-
 Path LightHierarchy::setup(const std::vector<std::shared_ptr<Light>>& lights, ShadingTree& tree)
 {
     if (lights.empty())
@@ -91,40 +49,39 @@ Path LightHierarchy::setup(const std::vector<std::shared_ptr<Light>>& lights, Sh
     if (data != tree.context().Cache->ExportedData.end())
         return std::any_cast<Path>(data->second);
 
-    // Setup bvh
-    LightBvh bvh;
-    for (const auto& l : lights) {
-        const auto p = l->position();
-        IG_ASSERT(p.has_value(), "Expected all finite lights to return a valid position");
-        const bool has_dir = l->direction().has_value();
-        const Vector3f dir = l->direction().value_or(Vector3f::UnitZ());
-        const float flux   = l->computeFlux(tree);
+    const auto start = std::chrono::high_resolution_clock::now();
 
-        bvh.store(LightEntry(p.value(), dir, has_dir ? flux : -flux, (int32)l->id()));
+    std::vector<LightTree::Entry> entries;
+    entries.reserve(lights.size());
+    for (const auto& l : lights) {
+        IG_ASSERT(l->position().has_value(), "Expected all finite lights to return a valid position");
+        entries.push_back(LightTree::Entry{ l->boundingBox(), l->emissionCone(), l->computeFlux(tree), (uint32)l->id() });
     }
 
-    // Compute flux and average direction for inner nodes
-    std::vector<LightEntry> innerNodes(bvh.innerNodes().size());
-    std::vector<uint32> codes(lights.size(), 0);
-    populateInnerNodes(0, 0, 0, bvh, innerNodes, codes);
+    LightTree lightTree;
+    lightTree.build(entries);
 
-    if (L_DEBUG == IG_LOGGER.verbosity()) {
-        IG_LOG(L_DEBUG) << "Light Hierarchy:" << std::endl;
-        for (const auto& node : innerNodes)
-            IG_LOG(L_DEBUG) << (node.ID < 0 ? "Node" : "Leaf") << ": [" << node.Position.transpose() << ", " << node.Direction.transpose() << ", " << node.Flux << ", " << node.ID << "];" << std::endl;
+    const auto& nodes = lightTree.nodes();
+    IG_LOG(L_DEBUG) << "Building light hierarchy with " << nodes.size() << " nodes, depth " << lightTree.depth()
+                    << " and " << (nodes.size() * 16 + lightTree.codes().size()) * sizeof(float) / 1024.0f << " KiB took "
+                    << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count() / 1000.0f << " seconds" << std::endl;
 
-        // for (const auto& code : codes)
-        //     IG_LOG(L_DEBUG) << code << std::endl;
+    if (L_DEBUG == IG_LOGGER.verbosity() && nodes.size() <= 64) {
+        IG_LOG(L_DEBUG) << "Light Hierarchy:" << std::endl;
+        for (const auto& node : nodes)
+            IG_LOG(L_DEBUG) << (node.isLeaf() ? "Leaf" : "Node") << ": [" << node.BBox.min.transpose() << ", " << node.BBox.max.transpose() << ", "
+                            << node.Cone.Axis.transpose() << ", " << node.Cone.ThetaO << ", " << node.Cone.ThetaE << ", " << node.Flux << ", " << node.Index << "];" << std::endl;
     }
 
     const Path path = tree.context().CacheManager->directory() / "light_hierarchy.bin";
 
     FileSerializer serializer(path, false);
-    serializer.write(codes, true); // Codes are used to backtrack for the pdf. TODO: Currently this is limited to max depth 32!
+    serializer.write(lightTree.codes(), true); // Codes are used to backtrack for the pdf
     serializer.writeAlignmentPad(sizeof(float) * 4);
-    serializer.write(innerNodes, true);
+    for (const auto& node : nodes)
+        serializer.write(LightNodeEntry(node));
 
     tree.context().Cache->ExportedData[exported_id] = path;
     return path;
 }
-} // namespace IG
\ No newline at end of file
+} // namespace IG
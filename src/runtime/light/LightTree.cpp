@@ -0,0 +1,155 @@
+#include "LightTree.h"
+
+#include <algorithm>
+#include <array>
+
+namespace IG {
+constexpr size_t BinCount = 12;
+
+struct LightBin {
+    size_t Count     = 0;
+    BoundingBox BBox = BoundingBox::Empty();
+    LightCone Cone;
+    float Flux = 0;
+
+    inline void extend(const BoundingBox& bbox, const LightCone& cone, float flux, size_t count)
+    {
+        Cone = Count == 0 ? cone : LightCone::merge(Cone, cone);
+        BBox.extend(bbox);
+        Flux += flux;
+        Count += count;
+    }
+
+    inline void extend(const LightBin& other)
+    {
+        if (other.Count > 0)
+            extend(other.BBox, other.Cone, other.Flux, other.Count);
+    }
+
+    /// Surface area orientation heuristic without the normalization by the parent
+    [[nodiscard]] inline float cost() const { return Flux * Cone.measure() * BBox.halfArea(); }
+};
+
+static inline uint32 ceilLog2(size_t n)
+{
+    uint32 k = 0;
+    while ((size_t(1) << k) < n)
+        ++k;
+    return k;
+}
+
+void LightTree::build(std::vector<Entry>& entries)
+{
+    mNodes.clear();
+    mCodes.assign(entries.size(), 0);
+    mDepth = 0;
+
+    if (entries.empty())
+        return;
+
+    mNodes.reserve(2 * entries.size() - 1);
+    mNodes.emplace_back();
+    buildNode(entries, 0, 0, entries.size(), 0, 0);
+}
+
+void LightTree::buildNode(std::vector<Entry>& entries, size_t nodeID, size_t begin, size_t end, uint32 code, uint32 depth)
+{
+    mDepth = std::max(mDepth, depth);
+
+    if (end - begin == 1) {
+        const Entry& entry = entries[begin];
+        IG_ASSERT(entry.ID < mCodes.size(), "Expected light ids to be smaller than the number of lights");
+
+        mNodes[nodeID]   = Node{ entry.BBox, entry.Cone, entry.Flux, (int32)entry.ID };
+        mCodes[entry.ID] = code;
+        return;
+    }
+
+    BoundingBox bbox = BoundingBox::Empty();
+    for (size_t i = begin; i < end; ++i)
+        bbox.extend(entries[i].BBox);
+
+    const size_t mid  = split(entries, begin, end, bbox, depth);
+    const size_t left = mNodes.size();
+    mNodes.emplace_back();
+    mNodes.emplace_back();
+
+    buildNode(entries, left, begin, mid, code, depth + 1);
+    buildNode(entries, left + 1, mid, end, code | (0x1u << depth), depth + 1);
+
+    // Merge bottom-up, such that the bounds of a node contain the bounds of its children
+    const Node& leftNode  = mNodes[left];
+    const Node& rightNode = mNodes[left + 1];
+    mNodes[nodeID]        = Node{ bbox, LightCone::merge(leftNode.Cone, rightNode.Cone), leftNode.Flux + rightNode.Flux, -int32(left + 1) };
+}
+
+size_t LightTree::split(std::vector<Entry>& entries, size_t begin, size_t end, const BoundingBox& parent, uint32 depth) const
+{
+    BoundingBox centroids = BoundingBox::Empty();
+    for (size_t i = begin; i < end; ++i)
+        centroids.extend(entries[i].BBox.center());
+
+    // Unbalanced splits are only allowed as long as the paths still fit into the codes
+    const auto fits = [&](size_t count) { return depth + 1 + ceilLog2(count) <= MaxDepth; };
+
+    const Vector3f extent       = centroids.diameter();
+    const Vector3f parentExtent = parent.diameter();
+
+    const auto binOf = [&](const Entry& entry, int axis) {
+        const float scale = BinCount / extent[axis];
+        return std::min(BinCount - 1, (size_t)((entry.BBox.center()[axis] - centroids.min[axis]) * scale));
+    };
+
+    float bestCost = FltInf;
+    int bestAxis   = -1;
+    size_t bestBin = 0;
+    for (int axis = 0; axis < 3; ++axis) {
+        if (extent[axis] <= 0)
+            continue;
+
+        std::array<LightBin, BinCount> bins;
+        for (size_t i = begin; i < end; ++i)
+            bins[binOf(entries[i], axis)].extend(entries[i].BBox, entries[i].Cone, entries[i].Flux, 1);
+
+        std::array<LightBin, BinCount> rightBins;
+        LightBin right;
+        for (size_t b = BinCount - 1; b > 0; --b) {
+            right.extend(bins[b]);
+            rightBins[b] = right;
+        }
+
+        // Penalize splits along short axes, which would produce thin slabs
+        const float regularizer = parentExtent.maxCoeff() / parentExtent[axis];
+
+        LightBin left;
+        for (size_t b = 0; b < BinCount - 1; ++b) {
+            left.extend(bins[b]);
+            const LightBin& rightBin = rightBins[b + 1];
+            if (left.Count == 0 || rightBin.Count == 0 || !fits(std::max(left.Count, rightBin.Count)))
+                continue;
+
+            const float cost = regularizer * (left.cost() + rightBin.cost());
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestBin  = b;
+            }
+        }
+    }
+
+    if (bestAxis >= 0) {
+        const auto it = std::partition(entries.begin() + begin, entries.begin() + end,
+                                       [&](const Entry& entry) { return binOf(entry, bestAxis) <= bestBin; });
+        return (size_t)std::distance(entries.begin(), it);
+    }
+
+    // Fallback to a balanced split, e.g., if all lights share the same center
+    int axis;
+    extent.maxCoeff(&axis);
+
+    const size_t mid = begin + (end - begin) / 2;
+    std::nth_element(entries.begin() + begin, entries.begin() + mid, entries.begin() + end,
+                     [&](const Entry& a, const Entry& b) { return a.BBox.center()[axis] < b.BBox.center()[axis]; });
+    return mid;
+}
+} // namespace IG
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "LightCone.h"
+#include "math/BoundingBox.h"
+
+namespace IG {
+/// @brief Binary tree over finite lights with spatial and directional bounds, built with the surface area orientation heuristic (SAOH).
+/// Every leaf contains exactly one light. The two children of an inner node are always stored consecutively.
+/// Based on:
+/// Conty Estevez, A., Kulla, C. (2018). Importance Sampling of Many Lights with Adaptive Tree Splitting.
+class IG_LIB LightTree {
+public:
+    /// Paths from the root to the leaves are encoded with 32 bits
+    static constexpr uint32 MaxDepth = 32;
+
+    struct Entry {
+        BoundingBox BBox;
+        LightCone Cone;
+        float Flux;
+        uint32 ID; // Has to be smaller than the number of entries
+    };
+
+    struct Node {
+        BoundingBox BBox;
+        LightCone Cone;
+        float Flux;
+        int32 Index; // Light id for leaves, -(left child + 1) for inner nodes
+
+        [[nodiscard]] inline bool isLeaf() const { return Index >= 0; }
+        [[nodiscard]] inline size_t leftIndex() const { return size_t(-Index - 1); }
+        [[nodiscard]] inline size_t rightIndex() const { return leftIndex() + 1; }
+    };
+
+    /// @brief Build the tree. The given entries are reordered
+    void build(std::vector<Entry>& entries);
+
+    [[nodiscard]] inline const std::vector<Node>& nodes() const { return mNodes; }
+
+    /// @brief Path from the root to the leaf of each light, indexed by light id. Bit i is set if the right child is taken at depth i
+    [[nodiscard]] inline const std::vector<uint32>& codes() const { return mCodes; }
+
+    /// @brief Maximum depth of a leaf, with the root being at depth zero
+    [[nodiscard]] inline uint32 depth() const { return mDepth; }
+
+private:
+    void buildNode(std::vector<Entry>& entries, size_t nodeID, size_t begin, size_t end, uint32 code, uint32 depth);
+    size_t split(std::vector<Entry>& entries, size_t begin, size_t end, const BoundingBox& parent, uint32 depth) const;
+
+    std::vector<Node> mNodes;
+    std::vector<uint32> mCodes;
+    uint32 mDepth = 0;
+};
+} // namespace IG
@@ -12,6 +12,8 @@ SpotLight::SpotLight(const std::string& name, const std::shared_ptr<SceneObject>
     mPosition   = light->property("position").getVector3();
     mDirection  = LoaderUtils::getDirection(*mLight);
     mUsingPower = light->hasProperty("power");
+
+    mCutoff_Cache = Pi;
 }
 
 static inline float power_factor(float cutoff, float falloff)
@@ -30,6 +32,9 @@ void SpotLight::precompute(ShadingTree& tree)
     if (!mUsingPower)
         mColor_Cache *= factor;
     mIsSimple = output.WasConstant && cutoff.WasConstant && falloff.WasConstant;
+
+    // A varying cutoff can not be bounded beforehand
+    mCutoff_Cache = cutoff.WasConstant ? std::clamp(cutoff.Value * Deg2Rad, 0.0f, Pi) : Pi;
 }
 
 float SpotLight::computeFlux(ShadingTree& tree) const
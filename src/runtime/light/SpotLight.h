@@ -10,6 +10,7 @@ public:
     virtual bool isDelta() const override { return true; }
     virtual std::optional<Vector3f> position() const override { return mPosition; }
     virtual std::optional<Vector3f> direction() const override { return mDirection; }
+    virtual LightCone emissionCone() const override { return LightCone(mDirection, 0, mCutoff_Cache); }
     virtual void precompute(ShadingTree&) override;
     virtual float computeFlux(ShadingTree&) const override;
 
@@ -24,6 +25,7 @@ private:
     bool mUsingPower;
 
     Vector3f mColor_Cache;
+    float mCutoff_Cache;
     bool mIsSimple;
 
     std::shared_ptr<SceneObject> mLight;
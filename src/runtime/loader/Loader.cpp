@@ -80,6 +80,8 @@ std::optional<LoaderContext> Loader::load(const LoaderOptions& opts)
     IG_LOG(L_DEBUG) << "Got " << ctx.Entities->entityCount() << " entities" << std::endl;
 
     ctx.Database.MaterialCount = ctx.Materials.size(); // TODO: Refactor this
+    ctx.Database.SceneBBox     = ctx.SceneBBox;
+    ctx.Database.SceneRadius   = ctx.SceneDiameter / 2;
 
     ctx.Camera->setup(ctx);
     if (!ctx.Camera->hasCamera())
@@ -143,6 +145,11 @@ std::optional<LoaderContext> Loader::load(const LoaderOptions& opts)
                 variant.HitShaders.emplace_back(std::move(output));
             }
 
+            if (opts.LazyShaderCompilation) {
+                setup(
+                    "fallback hit", [&]() { return HitShader::setupFallback(ctx); }, variant.FallbackHitShader);
+            }
+
             // Generate advanced shadow shaders if requested
             if (info.ShadowHandlingMode != ShadowHandlingMode::Simple) {
                 const size_t max_materials = info.ShadowHandlingMode == ShadowHandlingMode::Advanced ? 1 : ctx.Materials.size();
@@ -4,6 +4,7 @@
 #include "LoaderOptions.h"
 #include "LoaderTechnique.h"
 #include "RuntimeSettings.h"
+#include "Statistics.h"
 #include "device/Target.h"
 #include "math/BoundingBox.h"
 #include "table/SceneDatabase.h"
@@ -31,6 +32,17 @@ inline bool operator==(const Material& a, const Material& b)
     return a.BSDF == b.BSDF && a.MediumInner == b.MediumInner && a.MediumOuter == b.MediumOuter && a.Entity == b.Entity; // Ignore Count
 }
 
+struct MaterialHash {
+    inline size_t operator()(const Material& mat) const
+    {
+        // Same fields as the equal operator
+        size_t seed = std::hash<std::string>{}(mat.BSDF);
+        for (size_t h : { std::hash<int>{}(mat.MediumInner), std::hash<int>{}(mat.MediumOuter), std::hash<std::string>{}(mat.Entity) })
+            seed ^= h + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        return seed;
+    }
+};
+
 struct LoaderCache {
     std::unordered_map<std::string, std::any> ExportedData;                    // Cache with already exported data and auxillary info
     std::unordered_map<std::string, std::any> ExprComputation;                 // Cache with already computed expressions
@@ -81,6 +93,8 @@ public:
     BoundingBox SceneBBox;
     float SceneDiameter = 0.0f;
 
+    Statistics Stats; // Timings of the loading phases
+
     Path handlePath(const Path& path, const SceneObject& obj) const;
 
     std::unordered_map<std::string, size_t> RegisteredResources;
@@ -1,3 +1,5 @@
+#define IG_PARALLEL_LOAD
+
 #include "LoaderEntity.h"
 #include "Loader.h"
 #include "LoaderLight.h"
@@ -5,9 +7,15 @@
 #include "LoaderShape.h"
 #include "Logger.h"
 #include "bvh/SceneBVHAdapter.h"
-#include "serialization/VectorSerializer.h"
 
+#include <array>
 #include <chrono>
+#include <unordered_set>
+
+#ifdef IG_PARALLEL_LOAD
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#endif
 
 namespace IG {
 void LoaderEntity::prepare(const LoaderContext& ctx)
@@ -15,6 +23,7 @@ void LoaderEntity::prepare(const LoaderContext& ctx)
     IG_UNUSED(ctx);
 }
 
+/// The leaves carry their own local matrix and do not reference the entity table, therefore they are the same for the default and the compact entity layout
 template <size_t N>
 inline static void setup_bvh(std::vector<EntityObject>& input, SceneBVH& bvh)
 {
@@ -29,6 +38,107 @@ inline static void setup_bvh(std::vector<EntityObject>& input, SceneBVH& bvh)
     std::memcpy(bvh.Leaves.data(), objs.data(), bvh.Leaves.size());
 }
 
+constexpr size_t EntityEntrySize = 36 * sizeof(float);
+
+static void writeEntity(uint8* data, const SceneEntity& entity)
+{
+    // The normal matrix is the transposed linear part of the inverse, which is required anyway
+    const Matrix34f toLocal  = entity.Transform.inverse().matrix().block<3, 4>(0, 0);
+    const Matrix34f toGlobal = entity.Transform.matrix().block<3, 4>(0, 0);
+    const uint32 ids[]       = { entity.ShapeID, entity.MaterialID, 0 };
+
+    float* dst                      = reinterpret_cast<float*>(data);
+    Eigen::Map<Matrix34f>(dst + 0)  = toLocal;                               // +12 = 12, To Local
+    Eigen::Map<Matrix34f>(dst + 12) = toGlobal;                              // +12 = 24, To Global
+    Eigen::Map<Matrix3f>(dst + 24)  = toLocal.block<3, 3>(0, 0).transpose(); // +9  = 33, To Global [Normal]
+    std::memcpy(dst + 33, ids, sizeof(ids));                                 // +3  = 36, Shape, Material, Padding
+}
+
+constexpr size_t CompactEntityEntrySize = 4 * sizeof(uint32);
+constexpr size_t TransformEntrySize     = 12 * sizeof(float);
+
+static void writeCompactEntity(uint8* data, const SceneEntity& entity)
+{
+    const uint32 ids[] = { entity.TransformID, entity.ShapeID, entity.MaterialID, 0 };
+    std::memcpy(data, ids, sizeof(ids));
+}
+
+static void writeTransform(uint8* data, const Transformf& transform)
+{
+    // Only the global transform is stored, the inverse and normal matrix are derived on demand in the shader
+    Eigen::Map<Matrix34f>(reinterpret_cast<float*>(data)) = transform.matrix().block<3, 4>(0, 0);
+}
+
+using TransformKey = std::array<uint32, 12>;
+struct TransformKeyHash {
+    inline size_t operator()(const TransformKey& key) const
+    {
+        return std::hash<std::string_view>{}(std::string_view(reinterpret_cast<const char*>(key.data()), sizeof(TransformKey)));
+    }
+};
+
+/// Deduplicate the transforms of all entities bitwise and write the compact entity records
+static size_t setupCompactEntities(SceneDatabase& database, uint8* entityData)
+{
+    auto& transformTable = database.FixTables["entity_transforms"];
+    database.TransformUseCount.clear();
+
+    std::unordered_map<TransformKey, uint32, TransformKeyHash> transformIDs;
+    for (size_t id = 0; id < database.Entities.size(); ++id) {
+        auto& entity = database.Entities[id];
+
+        TransformKey key;
+        const Matrix34f global = entity.Transform.matrix().block<3, 4>(0, 0);
+        std::memcpy(key.data(), global.data(), sizeof(TransformKey));
+
+        const auto [it, inserted] = transformIDs.try_emplace(key, (uint32)database.TransformUseCount.size());
+        if (inserted) {
+            writeTransform(transformTable.addEntries(1, TransformEntrySize), entity.Transform);
+            database.TransformUseCount.push_back(0);
+        }
+
+        entity.TransformID = it->second;
+        database.TransformUseCount[entity.TransformID] += 1;
+        writeCompactEntity(entityData + id * CompactEntityEntrySize, entity);
+    }
+
+    return database.TransformUseCount.size();
+}
+
+/// Build the scene bvhs of the given providers or all if none are given
+static void setupSceneBVHs(SceneDatabase& database, const Target& target, const std::unordered_set<std::string_view>& providers)
+{
+    std::unordered_map<std::string_view, std::vector<EntityObject>> in_objs;
+    for (size_t id = 0; id < database.Entities.size(); ++id) {
+        const auto& entity = database.Entities[id];
+        if (!providers.empty() && providers.count(entity.Provider) == 0)
+            continue;
+
+        EntityObject obj;
+        obj.BBox       = entity.ShapeBBox.transformed(entity.Transform);
+        obj.Local      = entity.Transform.inverse().matrix();
+        obj.EntityID   = (int32)id;
+        obj.ShapeID    = (int32)entity.ShapeID;
+        obj.MaterialID = (int32)entity.MaterialID;
+        obj.User1ID    = entity.User1ID;
+        obj.User2ID    = entity.User2ID;
+        obj.Flags      = entity.Flags; // Only added to bvh
+
+        in_objs[entity.Provider].emplace_back(obj);
+    }
+
+    for (auto& p : in_objs) {
+        auto& bvh = database.SceneBVHs[p.first];
+        if (target.isGPU()) {
+            setup_bvh<2>(p.second, bvh);
+        } else if (target.vectorWidth() < 8) {
+            setup_bvh<4>(p.second, bvh);
+        } else {
+            setup_bvh<8>(p.second, bvh);
+        }
+    }
+}
+
 bool LoaderEntity::load(LoaderContext& ctx)
 {
     // Fill entity list
@@ -36,69 +146,68 @@ bool LoaderEntity::load(LoaderContext& ctx)
 
     const auto start1 = std::chrono::high_resolution_clock::now();
 
-    auto& entityTable = ctx.Database.FixTables["entities"];
-    entityTable.reserve(ctx.Options.Scene->entities().size() * 36);
-
     // First group all entities to groups of unique materials
     std::vector<std::vector<std::pair<std::string, std::shared_ptr<SceneObject>>>> material_groups;
-    for (const auto& pair : ctx.Options.Scene->entities()) {
-        const auto child = pair.second;
+    {
+        const auto sectionClosure = ctx.Stats.section(SectionType::EntityGrouping);
 
-        // Query bsdf
-        const std::string bsdfName = child->property("bsdf").getString();
-        if (bsdfName.empty()) {
-            IG_LOG(L_ERROR) << "Entity " << pair.first << " has no bsdf" << std::endl;
-            continue;
-        } else if (!ctx.Options.Scene->bsdf(bsdfName)) {
-            IG_LOG(L_ERROR) << "Entity " << pair.first << " has unknown bsdf " << bsdfName << std::endl;
-            continue;
-        }
-
-        // Query medium interface
-        const std::string mediumInnerName = child->property("inner_medium").getString();
-        int mediumInner                   = -1;
+        std::unordered_map<Material, size_t, MaterialHash> material_ids;
+        for (const auto& pair : ctx.Options.Scene->entities()) {
+            const auto child = pair.second;
 
-        if (!mediumInnerName.empty()) {
-            if (!ctx.Options.Scene->medium(mediumInnerName)) {
-                IG_LOG(L_ERROR) << "Entity " << pair.first << " has unknown medium " << mediumInnerName << std::endl;
+            // Query bsdf
+            const std::string bsdfName = child->property("bsdf").getString();
+            if (bsdfName.empty()) {
+                IG_LOG(L_ERROR) << "Entity " << pair.first << " has no bsdf" << std::endl;
+                continue;
+            } else if (!ctx.Options.Scene->bsdf(bsdfName)) {
+                IG_LOG(L_ERROR) << "Entity " << pair.first << " has unknown bsdf " << bsdfName << std::endl;
                 continue;
-            } else {
-                mediumInner = (int)ctx.Media->acquire(mediumInnerName);
             }
-        }
 
-        const std::string mediumOuterName = child->property("outer_medium").getString();
-        int mediumOuter                   = -1;
+            // Query medium interface
+            const std::string mediumInnerName = child->property("inner_medium").getString();
+            int mediumInner                   = -1;
+
+            if (!mediumInnerName.empty()) {
+                if (!ctx.Options.Scene->medium(mediumInnerName)) {
+                    IG_LOG(L_ERROR) << "Entity " << pair.first << " has unknown medium " << mediumInnerName << std::endl;
+                    continue;
+                } else {
+                    mediumInner = (int)ctx.Media->acquire(mediumInnerName);
+                }
+            }
 
-        if (!mediumOuterName.empty()) {
-            if (!ctx.Options.Scene->medium(mediumOuterName)) {
-                IG_LOG(L_ERROR) << "Entity " << pair.first << " has unknown medium " << mediumOuterName << std::endl;
-                continue;
-            } else {
-                mediumOuter = (int)ctx.Media->acquire(mediumOuterName);
+            const std::string mediumOuterName = child->property("outer_medium").getString();
+            int mediumOuter                   = -1;
+
+            if (!mediumOuterName.empty()) {
+                if (!ctx.Options.Scene->medium(mediumOuterName)) {
+                    IG_LOG(L_ERROR) << "Entity " << pair.first << " has unknown medium " << mediumOuterName << std::endl;
+                    continue;
+                } else {
+                    mediumOuter = (int)ctx.Media->acquire(mediumOuterName);
+                }
             }
-        }
 
-        if (ctx.Lights->isAreaLight(pair.first)) {
-            material_groups.emplace_back().emplace_back(pair);
-            ctx.Materials.push_back(Material{ bsdfName, mediumInner, mediumOuter, pair.first, 1 });
-        } else {
-            Material mat{ bsdfName, mediumInner, mediumOuter, {}, 1 };
-            auto it = std::find(ctx.Materials.begin(), ctx.Materials.end(), mat);
-            if (it == ctx.Materials.end()) {
+            // Emissive entities always get a material on their own, as the entity is part of the key
+            Material mat{ bsdfName, mediumInner, mediumOuter, ctx.Lights->isAreaLight(pair.first) ? pair.first : std::string{}, 1 };
+            const auto [it, inserted] = material_ids.try_emplace(mat, ctx.Materials.size());
+            if (inserted) {
                 material_groups.emplace_back().emplace_back(pair);
-                ctx.Materials.push_back(mat);
+                ctx.Materials.push_back(std::move(mat));
             } else {
-                it->Count += 1;
-                const auto id = std::distance(ctx.Materials.begin(), it);
-                material_groups.at(id).emplace_back(pair);
+                ctx.Materials.at(it->second).Count += 1;
+                material_groups.at(it->second).emplace_back(pair);
             }
         }
     }
 
-    // Load entities in the order of their material
-    std::unordered_map<ShapeProvider*, std::vector<EntityObject>> in_objs;
-    mEntityCount = 0;
+    // Assign ids in the order of their material
+    std::vector<std::shared_ptr<SceneObject>> objects;
+    objects.reserve(ctx.Options.Scene->entities().size());
+    ctx.Database.Entities.reserve(ctx.Options.Scene->entities().size());
+    ctx.Database.EntityIDs.reserve(ctx.Options.Scene->entities().size());
     for (size_t materialID = 0; materialID < material_groups.size(); ++materialID) {
         for (const auto& pair : material_groups.at(materialID)) {
             const auto child = pair.second;
@@ -114,66 +223,91 @@ bool LoaderEntity::load(LoaderContext& ctx)
             }
 
             const uint32 shapeID = ctx.Shapes->getShapeID(shapeName);
+            const size_t id      = objects.size();
 
             // Query (inner) medium interface for reference
             const std::string mediumInnerName = child->property("inner_medium").getString();
-            ctx.Media->handleReferenceEntity(mediumInnerName, pair.first, mEntityCount);
-
-            // Populate flags
-            uint32 entity_flags = 0;
-            if (child->property("camera_visible").getBool(true))
-                entity_flags |= 0x1;
-            if (child->property("light_visible").getBool(true))
-                entity_flags |= 0x2;
-            if (child->property("bounce_visible").getBool(true))
-                entity_flags |= 0x4;
-            if (child->property("shadow_visible").getBool(true))
-                entity_flags |= 0x8;
-
-            // Extract entity information
-            Transformf transform = child->property("transform").getTransform();
-            transform.makeAffine();
+            ctx.Media->handleReferenceEntity(mediumInnerName, pair.first, id);
 
             const auto& shape = ctx.Shapes->getShape(shapeID);
 
-            const Transformf invTransform = transform.inverse();
-            const BoundingBox& shapeBox   = shape.BoundingBox;
-            const BoundingBox entityBox   = shapeBox.transformed(transform);
-
-            // Extend scene box
-            ctx.SceneBBox.extend(entityBox);
-
-            // Make sure the entity is added to the emissive list if it is associated with an area light
-            if (ctx.Lights->isAreaLight(pair.first))
-                mEmissiveEntities.insert({ pair.first, Entity{ mEntityCount, transform, pair.first, shapeID, (uint32)materialID, ctx.Materials.at(materialID).BSDF } });
-
-            const Matrix34f toLocal       = invTransform.matrix().block<3, 4>(0, 0);
-            const Matrix34f toGlobal      = transform.matrix().block<3, 4>(0, 0);
-            const Matrix3f toGlobalNormal = toGlobal.block<3, 3>(0, 0).inverse().transpose();
-
-            // Write data to dyntable
-            auto& entityData = entityTable.addEntry(0);
-            VectorSerializer entitySerializer(entityData, false);
-            entitySerializer.write(toLocal, true);        // +12 = 12, To Local
-            entitySerializer.write(toGlobal, true);       // +12 = 24, To Global
-            entitySerializer.write(toGlobalNormal, true); // +9  = 33, To Global [Normal]
-            entitySerializer.write((uint32)shapeID);      // +1  = 34
-            entitySerializer.write((uint32)materialID);   // +1  = 35
-            entitySerializer.write((uint32)0);            // +1  = 36, Padding
-
-            // Extract information for BVH building
-            EntityObject obj;
-            obj.BBox       = entityBox;
-            obj.Local      = invTransform.matrix();
-            obj.EntityID   = (int32)mEntityCount;
-            obj.ShapeID    = shapeID;
-            obj.MaterialID = (int32_t)materialID;
-            obj.User1ID    = shape.User1ID;
-            obj.User2ID    = shape.User2ID;
-            obj.Flags      = entity_flags; // Only added to bvh
-
-            in_objs[shape.Provider].emplace_back(obj);
-            mEntityCount++;
+            // Keep the information required for the bvh and later updates. The transform is filled below
+            SceneEntity entity;
+            entity.Provider    = shape.Provider->identifier();
+            entity.ShapeBBox   = shape.BoundingBox;
+            entity.ShapeID     = shapeID;
+            entity.MaterialID  = (uint32)materialID;
+            entity.User1ID     = shape.User1ID;
+            entity.User2ID     = shape.User2ID;
+            entity.Flags       = 0;
+            entity.TransformID = 0;
+            entity.Emissive    = ctx.Materials.at(materialID).hasEmission();
+
+            ctx.Database.EntityIDs[pair.first] = (uint32)id;
+            ctx.Database.Entities.push_back(entity);
+            objects.push_back(child);
+        }
+    }
+
+    mEntityCount = objects.size();
+
+    // Extract transforms and write data to the fixtable. Every entity is touched by exactly one thread
+    {
+        const auto sectionClosure = ctx.Stats.section(SectionType::EntitySerialization);
+
+        const bool compact    = ctx.Options.CompactEntities;
+        uint8* entityData     = ctx.Database.FixTables["entities"].addEntries(mEntityCount, compact ? CompactEntityEntrySize : EntityEntrySize);
+        const auto load_range = [&](size_t begin, size_t end) {
+            for (size_t id = begin; id < end; ++id) {
+                const auto& child = objects[id];
+                auto& entity      = ctx.Database.Entities[id];
+
+                // Populate flags
+                if (child->property("camera_visible").getBool(true))
+                    entity.Flags |= 0x1;
+                if (child->property("light_visible").getBool(true))
+                    entity.Flags |= 0x2;
+                if (child->property("bounce_visible").getBool(true))
+                    entity.Flags |= 0x4;
+                if (child->property("shadow_visible").getBool(true))
+                    entity.Flags |= 0x8;
+
+                entity.Transform = child->property("transform").getTransform();
+                entity.Transform.makeAffine();
+
+                if (!compact)
+                    writeEntity(entityData + id * EntityEntrySize, entity);
+            }
+        };
+
+#ifdef IG_PARALLEL_LOAD
+        const int threadCount = ctx.Options.Target.threadCount() > 0 ? (int)ctx.Options.Target.threadCount() : tbb::task_arena::automatic;
+        tbb::task_arena arena(threadCount);
+        arena.execute([&]() {
+            tbb::parallel_for(tbb::blocked_range<size_t>(0, mEntityCount), [&](const tbb::blocked_range<size_t>& range) { load_range(range.begin(), range.end()); });
+        });
+#else
+        load_range(0, mEntityCount);
+#endif
+
+        // Deduplication requires all transforms to be known, therefore the compact records are written afterwards
+        if (compact) {
+            const size_t uniqueTransforms = setupCompactEntities(ctx.Database, entityData);
+            IG_LOG(L_DEBUG) << "Compact entity layout uses " << uniqueTransforms << " unique transforms for " << mEntityCount << " entities, requiring "
+                            << (mEntityCount * CompactEntityEntrySize + uniqueTransforms * TransformEntrySize) << " instead of " << (mEntityCount * EntityEntrySize) << " bytes" << std::endl;
+        }
+    }
+
+    for (size_t id = 0; id < mEntityCount; ++id) {
+        const auto& entity = ctx.Database.Entities[id];
+
+        // Extend scene box
+        ctx.SceneBBox.extend(entity.ShapeBBox.transformed(entity.Transform));
+
+        // Make sure the entity is added to the emissive list if it is associated with an area light
+        if (entity.Emissive) {
+            const auto& material = ctx.Materials.at(entity.MaterialID);
+            mEmissiveEntities.insert({ material.Entity, Entity{ id, entity.Transform, material.Entity, entity.ShapeID, entity.MaterialID, material.BSDF } });
         }
     }
 
@@ -189,18 +323,83 @@ bool LoaderEntity::load(LoaderContext& ctx)
     // Build bvh (keep in mind that this BVH has no pre-padding as in the case for shape BVHs)
     IG_LOG(L_DEBUG) << "Generating BVH for scene" << std::endl;
     const auto start2 = std::chrono::high_resolution_clock::now();
-    for (auto& p : in_objs) {
-        auto& bvh = ctx.Database.SceneBVHs[p.first->identifier()];
-        if (ctx.Options.Target.isGPU()) {
-            setup_bvh<2>(p.second, bvh);
-        } else if (ctx.Options.Target.vectorWidth() < 8) {
-            setup_bvh<4>(p.second, bvh);
+    {
+        const auto sectionClosure = ctx.Stats.section(SectionType::SceneBVHBuild);
+        setupSceneBVHs(ctx.Database, ctx.Options.Target, {});
+    }
+    IG_LOG(L_DEBUG) << "Building Scene BVH took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start2).count() / 1000.0f << " seconds" << std::endl;
+
+    return true;
+}
+
+bool LoaderEntity::updateTransforms(SceneDatabase& database, const Target& target, const std::vector<std::pair<std::string, Transformf>>& transforms, std::vector<uint32>& updatedEntities)
+{
+    // Check all entities first, such that nothing is modified on error
+    std::vector<uint32> ids;
+    ids.reserve(transforms.size());
+    for (const auto& pair : transforms) {
+        const auto it = database.EntityIDs.find(pair.first);
+        if (it == database.EntityIDs.end()) {
+            IG_LOG(L_ERROR) << "Can not update transform of unknown entity " << pair.first << std::endl;
+            return false;
+        } else if (database.Entities.at(it->second).Emissive) {
+            IG_LOG(L_ERROR) << "Can not update transform of emissive entity " << pair.first << ", as it is embedded into the lights. Reload the scene instead" << std::endl;
+            return false;
+        }
+        ids.push_back(it->second);
+    }
+
+    const auto start = std::chrono::high_resolution_clock::now();
+
+    // The transform table is only present with the compact entity layout
+    const bool compact     = database.FixTables.count("entity_transforms") > 0;
+    const size_t entrySize = compact ? CompactEntityEntrySize : EntityEntrySize;
+
+    auto& entityTable = database.FixTables.at("entities");
+    IG_ASSERT(entityTable.currentOffset() == entityTable.entryCount() * entrySize, "Expected entity table to be densely packed");
+
+    uint8* entityData = entityTable.accessData();
+
+    std::unordered_set<std::string_view> providers;
+    BoundingBox bbox = BoundingBox::Empty();
+    for (size_t i = 0; i < ids.size(); ++i) {
+        auto& entity     = database.Entities[ids[i]];
+        entity.Transform = transforms[i].second;
+        entity.Transform.makeAffine();
+
+        if (compact) {
+            auto& transformTable = database.FixTables.at("entity_transforms");
+
+            // Shared transforms are split up, such that other entities are not affected. The old slot is kept to keep all other ids stable
+            if (database.TransformUseCount[entity.TransformID] > 1) {
+                database.TransformUseCount[entity.TransformID] -= 1;
+                entity.TransformID = (uint32)database.TransformUseCount.size();
+                database.TransformUseCount.push_back(1);
+                writeTransform(transformTable.addEntries(1, TransformEntrySize), entity.Transform);
+            } else {
+                writeTransform(transformTable.accessData() + entity.TransformID * TransformEntrySize, entity.Transform);
+            }
+
+            writeCompactEntity(entityData + ids[i] * CompactEntityEntrySize, entity);
         } else {
-            setup_bvh<8>(p.second, bvh);
+            writeEntity(entityData + ids[i] * EntityEntrySize, entity);
         }
+
+        providers.insert(entity.Provider);
+        bbox.extend(entity.ShapeBBox.transformed(entity.Transform));
     }
-    IG_LOG(L_DEBUG) << "Building Scene BVH took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start2).count() / 1000.0f << " seconds" << std::endl;
 
+    // Only the scene bvhs containing updated entities are rebuilt, the shape bvhs are left untouched
+    if (!providers.empty())
+        setupSceneBVHs(database, target, providers);
+
+    // The scene bounding box is embedded into the shaders and therefore not updated
+    if (!bbox.isEmpty() && (!database.SceneBBox.isInside(bbox.min) || !database.SceneBBox.isInside(bbox.max)))
+        IG_LOG(L_WARNING) << "Updated entities leave the scene bounding box the scene was loaded with. Techniques and lights depending on it might be affected" << std::endl;
+
+    IG_LOG(L_DEBUG) << "Updating " << ids.size() << " entity transforms took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count() / 1000.0f << " seconds" << std::endl;
+
+    updatedEntities = std::move(ids);
     return true;
 }
 
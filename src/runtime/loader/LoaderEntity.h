@@ -33,6 +33,15 @@ public:
     void prepare(const LoaderContext& ctx);
     bool load(LoaderContext& ctx);
 
+    /// @brief Update the transforms of already loaded entities and rebuild the scene bvhs containing them. The shape bvhs are not touched.
+    /// Emissive entities can not be updated, as their transforms are embedded into the lights as well
+    /// @param database Database the entities were loaded into
+    /// @param target Target the scene was loaded for
+    /// @param transforms Pairs of entity name and new transform
+    /// @param updatedEntities Ids of the updated entities, in the order of the given transforms
+    /// @return False if an entity is unknown or can not be updated. Nothing is modified in that case
+    static bool updateTransforms(SceneDatabase& database, const Target& target, const std::vector<std::pair<std::string, Transformf>>& transforms, std::vector<uint32>& updatedEntities);
+
     [[nodiscard]] inline size_t entityCount() const { return mEntityCount; }
 
     [[nodiscard]] std::optional<Entity> getEmissiveEntity(const std::string& name) const;
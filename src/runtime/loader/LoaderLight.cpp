@@ -175,7 +175,7 @@ std::string LoaderLight::generateFinite(ShadingTree& tree)
             stream << "  let e_" << var_name << " = ";
 
             if (p.first == "SimpleAreaLight")
-                stream << "load_simple_area_lights(" << p.second << ", " << offset << ", device, shapes);" << std::endl;
+                stream << "load_simple_area_lights(" << p.second << ", " << offset << ", device, shapes, device.load_buffer(\"" << AreaLight::setupTriangleSamplers(tree.context()).generic_u8string() << "\"));" << std::endl;
             else if (p.first == "SimplePlaneLight")
                 stream << "load_simple_plane_lights(" << p.second << ", " << offset << ", device);" << std::endl;
             else if (p.first == "SimplePointLight")
@@ -435,7 +435,7 @@ std::string LoaderLight::generateLightSelector(std::string type, ShadingTree& tr
         if (hierarchy.empty()) {
             stream << uniformSelector << std::endl;
         } else {
-            stream << "  let light_selector = make_hierarchy_light_selector(infinite_lights, finite_lights, device.load_buffer(\"" << hierarchy.generic_u8string() << "\"));" << std::endl;
+            stream << "  let light_selector = make_hierarchy_light_selector(infinite_lights, finite_lights, device.load_buffer(\"" << hierarchy.generic_u8string() << "\"), " << computeInfiniteRatio(tree) << ");" << std::endl;
         }
     } else if (type == "simple") {
         auto cdf = generateLightSelectionCDF(tree);
@@ -443,7 +443,7 @@ std::string LoaderLight::generateLightSelector(std::string type, ShadingTree& tr
             stream << uniformSelector << std::endl;
         } else {
             stream << "  let light_cdf = cdf::make_cdf_1d_from_buffer(device.load_buffer(\"" << cdf.generic_u8string() << "\"), finite_lights.count, 0);" << std::endl
-                   << "  let light_selector = make_cdf_light_selector(infinite_lights, finite_lights, light_cdf);" << std::endl;
+                   << "  let light_selector = make_cdf_light_selector(infinite_lights, finite_lights, light_cdf, " << computeInfiniteRatio(tree) << ");" << std::endl;
         }
     } else { // Default
         stream << uniformSelector << std::endl;
@@ -452,6 +452,26 @@ std::string LoaderLight::generateLightSelector(std::string type, ShadingTree& tr
     return stream.str();
 }
 
+// Keep both groups selectable, as the flux of infinite lights is only a rough estimate
+constexpr float MinInfiniteRatio = 0.1f;
+constexpr float MaxInfiniteRatio = 0.9f;
+float LoaderLight::computeInfiniteRatio(ShadingTree& tree) const
+{
+    float infiniteFlux = 0;
+    for (const auto& light : mInfiniteLights)
+        infiniteFlux += light->computeFlux(tree);
+
+    float finiteFlux = 0;
+    for (const auto& light : mFiniteLights)
+        finiteFlux += light->computeFlux(tree);
+
+    const float totalFlux = infiniteFlux + finiteFlux;
+    if (!(totalFlux > 0) || !std::isfinite(totalFlux))
+        return 0.5f;
+
+    return std::clamp(infiniteFlux / totalFlux, MinInfiniteRatio, MaxInfiniteRatio);
+}
+
 Path LoaderLight::generateLightSelectionCDF(ShadingTree& tree)
 {
     const std::string exported_id = "_light_cdf_";
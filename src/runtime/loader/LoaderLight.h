@@ -43,6 +43,7 @@ private:
     [[nodiscard]] std::string generateFinite(ShadingTree& tree);
 
     [[nodiscard]] Path generateLightSelectionCDF(ShadingTree& tree);
+    [[nodiscard]] float computeInfiniteRatio(ShadingTree& tree) const;
 
     std::vector<std::shared_ptr<Light>> mInfiniteLights;
     std::vector<std::shared_ptr<Light>> mFiniteLights;
@@ -21,8 +21,14 @@ struct LoaderOptions {
     size_t SamplesPerIteration; // Only a recommendation!
     bool IsTracer;
     RuntimeOptions::SpecializationMode Specialization;
+    RuntimeOptions::BvhQuality BvhBuildQuality;
+    bool CompressBvh;
+    bool CompactEntities;
+    bool TiledTextures;    // Load image textures via the texture page cache
+    bool CompressTextures; // Load image textures block compressed or as half floats
     bool EnableTonemapping;
     bool EnableCache;
+    bool LazyShaderCompilation;
     DenoiserSettings Denoiser;
     GlareOptions Glare;
 
@@ -3,9 +3,12 @@
 #include "LoaderShape.h"
 #include "Loader.h"
 #include "Logger.h"
+#include "SHA256.h"
 #include "StringUtils.h"
+#include "serialization/VectorSerializer.h"
 #include "shape/SphereProvider.h"
 #include "shape/TriMeshProvider.h"
+#include "table/SceneBlob.h"
 
 #include <algorithm>
 #include <chrono>
@@ -13,6 +16,7 @@
 
 #ifdef IG_PARALLEL_LOAD
 #include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
 #endif
 
 namespace IG {
@@ -81,6 +85,114 @@ void LoaderShape::prepare(const LoaderContext& ctx)
     }
 }
 
+static inline void hashRaw(SHA256& hash, const void* data, size_t size)
+{
+    hash.update(reinterpret_cast<const uint8*>(data), size);
+}
+
+// Strings referencing files, e.g., external meshes or displacement maps, are identified by the modification time and size of the file
+static void hashFileStamp(SHA256& hash, const LoaderContext& ctx, const SceneObject& obj, const std::string& str)
+{
+    if (str.empty())
+        return;
+
+    std::error_code ec;
+    Path path = str;
+    if (path.is_relative()) {
+        if (!obj.baseDir().empty() && std::filesystem::exists(obj.baseDir() / path, ec))
+            path = obj.baseDir() / path;
+        else if (!ctx.Options.FilePath.empty())
+            path = ctx.Options.FilePath.parent_path() / path;
+    }
+
+    if (!std::filesystem::is_regular_file(path, ec))
+        return;
+
+    const int64 time = (int64)std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+    const uint64 size = (uint64)std::filesystem::file_size(path, ec);
+    hashRaw(hash, &time, sizeof(time));
+    hashRaw(hash, &size, sizeof(size));
+}
+
+static void hashProperty(SHA256& hash, const LoaderContext& ctx, const SceneObject& obj, const SceneProperty& prop)
+{
+    const uint32 type = (uint32)prop.type();
+    hashRaw(hash, &type, sizeof(type));
+
+    switch (prop.type()) {
+    case SceneProperty::PT_BOOL: {
+        const uint8 v = prop.getBool() ? 1 : 0;
+        hashRaw(hash, &v, sizeof(v));
+    } break;
+    case SceneProperty::PT_INTEGER: {
+        const int32 v = prop.getInteger();
+        hashRaw(hash, &v, sizeof(v));
+    } break;
+    case SceneProperty::PT_NUMBER: {
+        const float v = prop.getNumber();
+        hashRaw(hash, &v, sizeof(v));
+    } break;
+    case SceneProperty::PT_STRING:
+        hash.update(prop.getString());
+        hashFileStamp(hash, ctx, obj, prop.getString());
+        break;
+    case SceneProperty::PT_TRANSFORM: {
+        const Matrix4f m = prop.getTransform().matrix();
+        hashRaw(hash, m.data(), sizeof(float) * m.size());
+    } break;
+    case SceneProperty::PT_VECTOR2:
+        hashRaw(hash, prop.getVector2().data(), sizeof(float) * 2);
+        break;
+    case SceneProperty::PT_VECTOR3:
+        hashRaw(hash, prop.getVector3().data(), sizeof(float) * 3);
+        break;
+    case SceneProperty::PT_INTEGER_ARRAY:
+        hashRaw(hash, prop.getIntegerArray().data(), sizeof(SceneProperty::Integer) * prop.getIntegerArray().size());
+        break;
+    case SceneProperty::PT_NUMBER_ARRAY:
+        hashRaw(hash, prop.getNumberArray().data(), sizeof(SceneProperty::Number) * prop.getNumberArray().size());
+        break;
+    default:
+        break;
+    }
+}
+
+/// Key of the shape blob. Any change to the shape descriptions, the referenced files or the target layout invalidates the blob
+static std::string computeBlobKey(const LoaderContext& ctx, std::vector<std::string> names)
+{
+    SHA256 hash;
+    const uint32 version     = SceneBlob::Version;
+    const uint32 isGPU       = ctx.Options.Target.isGPU() ? 1 : 0;
+    const uint32 vectorWidth = (uint32)ctx.Options.Target.vectorWidth();
+    const uint32 bvhQuality  = (uint32)ctx.Options.BvhBuildQuality;
+    const uint32 compressBvh = ctx.Options.CompressBvh ? 1 : 0;
+    hashRaw(hash, &version, sizeof(version));
+    hashRaw(hash, &isGPU, sizeof(isGPU));
+    hashRaw(hash, &vectorWidth, sizeof(vectorWidth));
+    hashRaw(hash, &bvhQuality, sizeof(bvhQuality));
+    hashRaw(hash, &compressBvh, sizeof(compressBvh));
+
+    std::sort(names.begin(), names.end());
+    for (const auto& name : names) {
+        const auto obj = ctx.Options.Scene->shape(name);
+        hash.update(name);
+        hash.update(obj->pluginType());
+
+        std::vector<std::string> keys;
+        keys.reserve(obj->properties().size());
+        for (const auto& prop : obj->properties())
+            keys.push_back(prop.first);
+        std::sort(keys.begin(), keys.end());
+
+        for (const auto& key : keys) {
+            hash.update(key);
+            hashProperty(hash, ctx, *obj, obj->properties().at(key));
+        }
+    }
+
+    return hash.final();
+}
+
 bool LoaderShape::load(LoaderContext& ctx)
 {
     ShapeMTAccessor acc;
@@ -96,6 +208,18 @@ bool LoaderShape::load(LoaderContext& ctx)
     // Make sure this table is preloaded
     ctx.Database.DynTables.emplace("shapes", DynTable{});
 
+    // Warm start: Use the tables from the blob directly without parsing any shape
+    const Path blobPath = ctx.CacheManager->directory() / "_shapes.blob";
+    std::string blobKey;
+    if (ctx.CacheManager->isEnabled()) {
+        const auto start = std::chrono::high_resolution_clock::now();
+        blobKey          = computeBlobKey(ctx, names);
+        if (loadFromBlob(ctx, blobPath, blobKey)) {
+            IG_LOG(L_DEBUG) << "Mapping of shapes from cache took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count() / 1000.0f << " seconds" << std::endl;
+            return true;
+        }
+    }
+
     const auto load_shape = [&](size_t i) {
         const std::string name = names.at(i);
         const auto child       = ctx.Options.Scene->shape(name);
@@ -115,17 +239,194 @@ bool LoaderShape::load(LoaderContext& ctx)
     IG_LOG(L_DEBUG) << "Loading shapes..." << std::endl;
     const auto start1 = std::chrono::high_resolution_clock::now();
 #ifdef IG_PARALLEL_LOAD
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, names.size()),
-                      [&](const tbb::blocked_range<size_t>& range) {
-                          for (size_t i = range.begin(); i != range.end(); ++i)
-                              load_shape(i);
-                      });
+    // Shapes and their bvhs are built concurrently, restricted to the threads given by the target.
+    // Mesh sizes vary a lot, therefore every shape is a task on its own
+    const int threadCount = ctx.Options.Target.threadCount() > 0 ? (int)ctx.Options.Target.threadCount() : tbb::task_arena::automatic;
+    tbb::task_arena arena(threadCount);
+    arena.execute([&]() {
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, names.size(), 1),
+            [&](const tbb::blocked_range<size_t>& range) {
+                for (size_t i = range.begin(); i != range.end(); ++i)
+                    load_shape(i);
+            },
+            tbb::simple_partitioner());
+    });
 #else
     for (size_t i = 0; i < names.size(); ++i)
         load_shape(i);
 #endif
     IG_LOG(L_DEBUG) << "Loading of shapes took " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start1).count() / 1000.0f << " seconds" << std::endl;
 
+    if (ctx.CacheManager->isEnabled())
+        saveToBlob(ctx, blobPath, blobKey);
+
+    return true;
+}
+
+// Registries of the loader are stored as user data in the blob, ordered by shape id
+enum ShapeBlobFlags : uint8 {
+    SBF_Tri    = 0x1,
+    SBF_Plane  = 0x2,
+    SBF_Sphere = 0x4
+};
+
+void LoaderShape::saveToBlob(const LoaderContext& ctx, const Path& path, const std::string& key) const
+{
+    std::vector<std::string> names(mShapes.size());
+    for (const auto& p : mIDs)
+        names[p.second] = p.first;
+
+    SceneBlob::Content content;
+    VectorSerializer serializer(content.UserData, false);
+    serializer.write((uint32)mShapes.size());
+    for (size_t id = 0; id < mShapes.size(); ++id) {
+        const Shape& shape = mShapes[id];
+
+        std::string provider;
+        for (const auto& p : mShapeProviders) {
+            if (p.second.get() == shape.Provider)
+                provider = p.first;
+        }
+
+        serializer.write(names[id]);
+        serializer.write(provider);
+        serializer.write(shape.User1ID);
+        serializer.write(shape.User2ID);
+        serializer.write(shape.BoundingBox.min);
+        serializer.write(shape.BoundingBox.max);
+        serializer.write((uint64)shape.TableOffset);
+
+        const uint8 flags = (isTriShape((uint32)id) ? SBF_Tri : 0) | (isPlaneShape((uint32)id) ? SBF_Plane : 0) | (isSphereShape((uint32)id) ? SBF_Sphere : 0);
+        serializer.write(flags);
+        if (flags & SBF_Tri) {
+            const TriShape& tri = getTriShape((uint32)id);
+            serializer.write((uint64)tri.VertexCount);
+            serializer.write((uint64)tri.NormalCount);
+            serializer.write((uint64)tri.TexCount);
+            serializer.write((uint64)tri.FaceCount);
+            serializer.write(tri.Area);
+        }
+        if (flags & SBF_Plane) {
+            const PlaneShape& plane = getPlaneShape((uint32)id);
+            serializer.write(plane.Origin);
+            serializer.write(plane.XAxis);
+            serializer.write(plane.YAxis);
+            for (const auto& uv : plane.TexCoords)
+                serializer.write(uv);
+        }
+        if (flags & SBF_Sphere) {
+            const SphereShape& sphere = getSphereShape((uint32)id);
+            serializer.write(sphere.Origin);
+            serializer.write(sphere.Radius);
+        }
+    }
+
+    // Shape providers only populate the shape dyntable and their own fixtables
+    content.DynTables.push_back("shapes");
+    for (const auto& p : ctx.Database.FixTables)
+        content.FixTables.push_back(p.first);
+
+    if (SceneBlob::save(path, key, ctx.Database, content))
+        IG_LOG(L_DEBUG) << "Stored shapes in cache " << path << std::endl;
+}
+
+bool LoaderShape::loadFromBlob(LoaderContext& ctx, const Path& path, const std::string& key)
+{
+    SceneBlob::Content content;
+    if (!SceneBlob::load(path, key, ctx.Database, content))
+        return false;
+
+    VectorSerializer serializer(content.UserData, true);
+
+    uint32 count = 0;
+    serializer.read(count);
+
+    std::vector<std::pair<std::string, Shape>> shapes;
+    shapes.reserve(count);
+    std::unordered_map<uint32, TriShape> triShapes;
+    std::unordered_map<uint32, PlaneShape> planeShapes;
+    std::unordered_map<uint32, SphereShape> sphereShapes;
+    bool valid = true;
+    for (uint32 id = 0; id < count && valid; ++id) {
+        std::string name;
+        std::string provider;
+        Shape shape;
+        uint64 tableOffset = 0;
+        serializer.read(name);
+        serializer.read(provider);
+        serializer.read(shape.User1ID);
+        serializer.read(shape.User2ID);
+        serializer.read(shape.BoundingBox.min);
+        serializer.read(shape.BoundingBox.max);
+        serializer.read(tableOffset);
+        shape.TableOffset = (size_t)tableOffset;
+
+        const auto it  = mShapeProviders.find(provider);
+        valid          = it != mShapeProviders.end();
+        shape.Provider = valid ? it->second.get() : nullptr;
+
+        uint8 flags = 0;
+        serializer.read(flags);
+        if (flags & SBF_Tri) {
+            uint64 vertexCount, normalCount, texCount, faceCount;
+            TriShape tri;
+            serializer.read(vertexCount);
+            serializer.read(normalCount);
+            serializer.read(texCount);
+            serializer.read(faceCount);
+            serializer.read(tri.Area);
+            tri.VertexCount = (size_t)vertexCount;
+            tri.NormalCount = (size_t)normalCount;
+            tri.TexCount    = (size_t)texCount;
+            tri.FaceCount   = (size_t)faceCount;
+            triShapes[id]   = tri;
+        }
+        if (flags & SBF_Plane) {
+            PlaneShape plane;
+            serializer.read(plane.Origin);
+            serializer.read(plane.XAxis);
+            serializer.read(plane.YAxis);
+            for (auto& uv : plane.TexCoords)
+                serializer.read(uv);
+            planeShapes[id] = plane;
+        }
+        if (flags & SBF_Sphere) {
+            SphereShape sphere;
+            serializer.read(sphere.Origin);
+            serializer.read(sphere.Radius);
+            sphereShapes[id] = sphere;
+        }
+
+        shapes.emplace_back(name, shape);
+    }
+
+    if (!valid) {
+        // The blob was written with providers not available now. Drop the installed views and load everything from scratch
+        IG_LOG(L_WARNING) << "Ignoring incompatible shape cache " << path << std::endl;
+        for (const auto& name : content.DynTables)
+            ctx.Database.DynTables[name] = DynTable{};
+        for (const auto& name : content.FixTables)
+            ctx.Database.FixTables.erase(name);
+        return false;
+    }
+
+    for (const auto& p : shapes)
+        addShape(p.first, p.second);
+    for (const auto& p : triShapes)
+        addTriShape(p.first, p.second);
+    for (const auto& p : planeShapes)
+        addPlaneShape(p.first, p.second);
+    for (const auto& p : sphereShapes)
+        addSphereShape(p.first, p.second);
+
+    // Properties are not accessed by the providers, mark them as used nevertheless to prevent warnings
+    for (const auto& p : ctx.Options.Scene->shapes()) {
+        for (const auto& prop : p.second->properties())
+            p.second->property(prop.first);
+    }
+
+    IG_LOG(L_DEBUG) << "Mapped " << shapes.size() << " shapes from cache " << path << std::endl;
     return true;
 }
 
@@ -45,6 +45,9 @@ public:
     [[nodiscard]] inline ShapeProvider* getProvider(const std::string& name) const { return mShapeProviders.at(name).get(); }
 
 private:
+    bool loadFromBlob(LoaderContext& ctx, const Path& path, const std::string& key);
+    void saveToBlob(const LoaderContext& ctx, const Path& path, const std::string& key) const;
+
     std::unordered_map<std::string, std::unique_ptr<ShapeProvider>> mShapeProviders;
 
     std::vector<Shape> mShapes;
@@ -59,10 +59,27 @@ void ImagePattern::serialize(const SerializationInput& input) const
     const size_t channel_count = Image::extractChannelCount(filename);
 
     input.Stream << "  let img_" << tex_id << "_res_id = device.get_local_parameter_i32(\"img_" << tex_id << "\", 0);" << std::endl;
-    if (!force_unpacked && Image::isPacked(filename))
-        input.Stream << "  let img_" << tex_id << " = device.load_packed_image_by_id(img_" << tex_id << "_res_id, " << channel_count << ", " << (linear ? "true" : "false") << ");" << std::endl;
+
+    // Mip maps are only available for float images, the level is selected by the footprint of the ray cone
+    if (filter_type == "trilinear") {
+        input.Stream << "  let img_" << tex_id << " = device.load_mip_image_by_id(img_" << tex_id << "_res_id, " << channel_count << ");" << std::endl
+                     << "  let tex_" << tex_id << " : Texture = make_mip_image_texture("
+                     << wrap << ", "
+                     << "img_" << tex_id << ", "
+                     << LoaderUtils::inlineTransformAs2d(transform) << ");" << std::endl;
+
+        input.Tree.endClosure();
+        return;
+    }
+
+    // Tiles are read on first use and evicted if the memory budget is exceeded, regardless of the file format
+    const bool compress = input.Tree.context().Options.CompressTextures;
+    if (input.Tree.context().Options.TiledTextures)
+        input.Stream << "  let img_" << tex_id << " = device.load_tiled_image_by_id(img_" << tex_id << "_res_id, " << channel_count << ");" << std::endl;
+    else if (!force_unpacked && Image::isPacked(filename))
+        input.Stream << "  let img_" << tex_id << " = device." << (compress ? "load_compressed_image_by_id" : "load_packed_image_by_id") << "(img_" << tex_id << "_res_id, " << channel_count << ", " << (linear ? "true" : "false") << ");" << std::endl;
     else
-        input.Stream << "  let img_" << tex_id << " = device.load_image_by_id(img_" << tex_id << "_res_id, " << channel_count << ");" << std::endl;
+        input.Stream << "  let img_" << tex_id << " = device." << (compress ? "load_half_image_by_id" : "load_image_by_id") << "(img_" << tex_id << "_res_id, " << channel_count << ");" << std::endl;
 
     input.Stream << "  let tex_" << tex_id << " : Texture = make_image_texture("
                  << wrap << ", "
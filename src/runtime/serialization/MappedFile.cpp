@@ -0,0 +1,108 @@
+#include "MappedFile.h"
+#include "Logger.h"
+
+#ifdef IG_OS_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace IG {
+struct MappedFileInternal {
+#ifdef IG_OS_WINDOWS
+    HANDLE File    = INVALID_HANDLE_VALUE;
+    HANDLE Mapping = nullptr;
+#else
+    int File = -1;
+#endif
+};
+
+MappedFile::MappedFile()
+    : mInternal(std::make_unique<MappedFileInternal>())
+    , mData(nullptr)
+    , mSize(0)
+{
+}
+
+MappedFile::MappedFile(const Path& path)
+    : MappedFile()
+{
+    open(path);
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const Path& path)
+{
+    if (isValid())
+        return false;
+
+    std::error_code ec;
+    const size_t size = (size_t)std::filesystem::file_size(path, ec);
+    if (ec || size == 0)
+        return false;
+
+#ifdef IG_OS_WINDOWS
+    mInternal->File = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (mInternal->File == INVALID_HANDLE_VALUE)
+        return false;
+
+    mInternal->Mapping = CreateFileMappingW(mInternal->File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mInternal->Mapping == nullptr) {
+        close();
+        return false;
+    }
+
+    void* ptr = MapViewOfFile(mInternal->Mapping, FILE_MAP_READ, 0, 0, 0);
+    if (ptr == nullptr) {
+        close();
+        return false;
+    }
+#else
+    mInternal->File = ::open(path.c_str(), O_RDONLY);
+    if (mInternal->File < 0)
+        return false;
+
+    void* ptr = mmap(nullptr, size, PROT_READ, MAP_SHARED, mInternal->File, 0);
+    if (ptr == MAP_FAILED) {
+        IG_LOG(L_WARNING) << "Could not map file " << path << " into memory" << std::endl;
+        close();
+        return false;
+    }
+#endif
+
+    mData = reinterpret_cast<const uint8*>(ptr);
+    mSize = size;
+    return true;
+}
+
+void MappedFile::close()
+{
+#ifdef IG_OS_WINDOWS
+    if (mData)
+        UnmapViewOfFile(mData);
+    if (mInternal->Mapping)
+        CloseHandle(mInternal->Mapping);
+    if (mInternal->File != INVALID_HANDLE_VALUE)
+        CloseHandle(mInternal->File);
+    mInternal->Mapping = nullptr;
+    mInternal->File    = INVALID_HANDLE_VALUE;
+#else
+    if (mData)
+        munmap(const_cast<uint8*>(mData), mSize);
+    if (mInternal->File >= 0)
+        ::close(mInternal->File);
+    mInternal->File = -1;
+#endif
+
+    mData = nullptr;
+    mSize = 0;
+}
+} // namespace IG
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "IG_Config.h"
+
+namespace IG {
+struct MappedFileInternal;
+
+/// Read-only memory mapping of a whole file.
+/// Pages are only loaded by the operating system when accessed, therefore opening even large files is cheap
+class IG_LIB MappedFile {
+public:
+    MappedFile();
+    explicit MappedFile(const Path& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const Path& path);
+    void close();
+
+    [[nodiscard]] inline bool isValid() const { return mData != nullptr; }
+    [[nodiscard]] inline const uint8* data() const { return mData; }
+    [[nodiscard]] inline size_t size() const { return mSize; }
+
+private:
+    std::unique_ptr<MappedFileInternal> mInternal;
+    const uint8* mData;
+    size_t mSize;
+};
+} // namespace IG
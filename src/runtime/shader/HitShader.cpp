@@ -10,13 +10,14 @@
 #include "loader/LoaderUtils.h"
 #include "loader/ShadingTree.h"
 
+#include <functional>
 #include <sstream>
 
 namespace IG {
-std::string HitShader::setup(size_t mat_id, LoaderContext& ctx)
+static std::string generateHitShader(LoaderContext& ctx, const std::function<std::string(ShadingTree&, bool)>& materialGenerator)
 {
     std::stringstream stream;
-    
+
     stream << "#[export] fn ig_hit_shader(settings: &Settings, mat_id: i32, first: i32, last: i32) -> () {" << std::endl
            << "  " << ShaderUtils::constructDevice(ctx) << std::endl
            << "  let payload_info = " << ShaderUtils::inlinePayloadInfo(ctx) << ";" << std::endl
@@ -35,7 +36,7 @@ std::string HitShader::setup(size_t mat_id, LoaderContext& ctx)
     if (requireMedia)
         stream << ctx.Media->generate(tree) << std::endl;
 
-    stream << ShaderUtils::generateMaterialShader(tree, mat_id, requireLights, "shader") << std::endl;
+    stream << materialGenerator(tree, requireLights) << std::endl;
 
     // Include camera if necessary
     if (ctx.CurrentTechniqueVariantInfo().RequiresExplicitCamera)
@@ -52,4 +53,39 @@ std::string HitShader::setup(size_t mat_id, LoaderContext& ctx)
     return stream.str();
 }
 
+std::string HitShader::setup(size_t mat_id, LoaderContext& ctx)
+{
+    return generateHitShader(ctx, [&](ShadingTree& tree, bool requireLights) {
+        return ShaderUtils::generateMaterialShader(tree, mat_id, requireLights, "shader");
+    });
+}
+
+std::string HitShader::setupFallback(LoaderContext& ctx)
+{
+    return generateHitShader(ctx, [&](ShadingTree&, bool requireLights) {
+        if (!requireLights)
+            return std::string("  let shader : MaterialShader = @|ctx| make_material(mat_id, make_diffuse_bsdf(ctx.surf, 0, make_gray_color(0.8)), no_medium_interface());");
+
+        // Emissive materials keep their emission, else light sources stay black until their actual shader is available
+        std::stringstream stream;
+        stream << "  let fallback_light_id = match(mat_id) {" << std::endl;
+        for (size_t mat_id = 0; mat_id < ctx.Materials.size(); ++mat_id) {
+            const Material& material = ctx.Materials.at(mat_id);
+            if (material.hasEmission() && ctx.Lights->isAreaLight(material.Entity))
+                stream << "    " << mat_id << " => " << ctx.Lights->getAreaLightID(material.Entity) << "," << std::endl;
+        }
+        stream << "    _ => -1" << std::endl
+               << "  };" << std::endl
+               << "  let shader : MaterialShader = @|ctx| {" << std::endl
+               << "    let bsdf = make_diffuse_bsdf(ctx.surf, 0, make_gray_color(0.8));" << std::endl
+               << "    if fallback_light_id >= 0 {" << std::endl
+               << "      make_emissive_material(mat_id, bsdf, no_medium_interface(), finite_lights.get(fallback_light_id))" << std::endl
+               << "    } else {" << std::endl
+               << "      make_material(mat_id, bsdf, no_medium_interface())" << std::endl
+               << "    }" << std::endl
+               << "  };" << std::endl;
+
+        return stream.str();
+    });
+}
 } // namespace IG
\ No newline at end of file
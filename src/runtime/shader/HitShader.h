@@ -5,5 +5,7 @@
 namespace IG {
 struct HitShader {
     static std::string setup(size_t mat_id, LoaderContext& ctx);
+    /// Generic hit shader which shades all materials with a neutral diffuse material
+    static std::string setupFallback(LoaderContext& ctx);
 };
 } // namespace IG
\ No newline at end of file
@@ -1,6 +1,9 @@
 #include "ScriptCompiler.h"
+#include "CacheManager.h"
 #include "Logger.h"
 #include "RuntimeInfo.h"
+#include "SHA256.h"
+#include "config/Build.h"
 #include <fstream>
 
 #include <anydsl_jit.h>
@@ -15,6 +18,12 @@ ScriptCompiler::ScriptCompiler()
     : mStdLibOverride()
     , mOptimizationLevel(3)
     , mVerbose(false)
+    , mTargetName()
+    , mCacheManager(nullptr)
+    , mModules()
+    , mCompiledCount(0)
+    , mReusedCount(0)
+    , mPersistedCount(0)
 {
 }
 
@@ -22,11 +31,43 @@ ScriptCompiler::~ScriptCompiler()
 {
 }
 
+static inline std::string computeScriptHash(const std::string& script, const std::string& target, size_t optimizationLevel)
+{
+    SHA256 hash;
+    hash.update(script);
+    return hash.final() + "_" + target + "_O" + std::to_string(optimizationLevel);
+}
+
 void* ScriptCompiler::compile(const std::string& script, const std::string& function) const
 {
+    // Hashing is done outside the lock to allow multiple threads to prepare their requests in parallel
+    const std::string hash = computeScriptHash(script, mTargetName, mOptimizationLevel);
+
     // AnyDSL has no support for multi-threaded compile process :/
     std::lock_guard<std::mutex> _guard(mCompileMutex);
 
+    int ret = -1;
+    if (const auto it = mModules.find(hash); it != mModules.end()) {
+        ret = it->second;
+        mReusedCount++;
+    } else {
+        ret = compileModule(script, hash);
+        if (ret < 0)
+            return nullptr;
+
+        mModules[hash] = ret;
+        mCompiledCount++;
+    }
+
+    void* callback = anydsl_lookup_function(ret, function.c_str());
+    if (callback == nullptr)
+        IG_LOG(L_ERROR) << "Could not find function '" << function << "' in compiled script" << std::endl;
+
+    return callback;
+}
+
+int ScriptCompiler::compileModule(const std::string& script, const std::string& hash) const
+{
     static bool once = false;
     if (!once) {
         const auto module_path = RuntimeInfo::modulePath();
@@ -46,15 +87,20 @@ void* ScriptCompiler::compile(const std::string& script, const std::string& func
     anydsl_set_log_level(mVerbose ? 3 /* warn */ : 4 /* error */);
 #endif
 
-    const int ret = anydsl_compile(script.c_str(), (uint32_t)script.length(), (uint32_t)mOptimizationLevel);
-    if (ret < 0)
-        return nullptr;
+    // The JIT caches modules by their source only. The comment makes the target and the optimization level part of it.
+    // It is appended to keep the line numbers of error messages intact
+    const std::string source = script + "\n// " + hash + "\n";
 
-    void* callback = anydsl_lookup_function(ret, function.c_str());
-    if (callback == nullptr)
-        IG_LOG(L_ERROR) << "Could not find function '" << function << "' in compiled script" << std::endl;
+    // The entry only tracks whether the JIT will find the module in its cache. Modules from other builds might be incompatible
+    const std::string name    = "shader_" + hash;
+    const std::string version = Build::getGitString();
+    if (mCacheManager && mCacheManager->check(name, version))
+        mPersistedCount++;
 
-    return callback;
+    const int ret = anydsl_compile(source.c_str(), (uint32_t)source.length(), (uint32_t)mOptimizationLevel);
+    if (ret >= 0 && mCacheManager)
+        mCacheManager->update(name, version);
+    return ret;
 }
 
 std::string ScriptCompiler::prepare(const std::string& script) const
@@ -2,9 +2,16 @@
 
 #include "IG_Config.h"
 
+#include <atomic>
 #include <mutex>
+#include <unordered_map>
 
 namespace IG {
+class CacheManager;
+
+/// Compiles shaders with the AnyDSL JIT.
+/// The JIT persists the compiled modules in the cache directory, see RuntimeInfo::cacheDirectory, keyed by the script.
+/// The target and optimization level are made part of the script, such that they are part of that key as well
 class IG_LIB ScriptCompiler {
 public:
     ScriptCompiler();
@@ -16,15 +23,41 @@ public:
     inline void setVerbose(bool verbose) { mVerbose = verbose; }
     inline bool isVerbose() const { return mVerbose; }
 
+    /// Name of the target the scripts are compiled for, e.g., Target::toString()
+    inline void setTargetName(const std::string& name) { mTargetName = name; }
+    inline const std::string& targetName() const { return mTargetName; }
+
+    /// Cache used to keep track of the scripts compiled in previous runs. Can be null
+    inline void setCacheManager(CacheManager* cache) { mCacheManager = cache; }
+
     std::string prepare(const std::string& script) const;
+
+    /// Compile the given script and return the function with the given name.
+    /// Identical scripts (with respect to their SHA256, the target and the optimization level) are only compiled once.
+    /// This function can be called from multiple threads, but the actual JIT process is serialized.
     void* compile(const std::string& script, const std::string& function) const;
     void loadStdLibFromDirectory(const Path& dir);
 
+    /// Number of scripts which were actually passed to the JIT
+    inline size_t compiledCount() const { return mCompiledCount; }
+    /// Number of compile requests which were satisfied by an already compiled identical script
+    inline size_t reusedCount() const { return mReusedCount; }
+    /// Number of scripts passed to the JIT which were already compiled in a previous run. The JIT loads those from its cache directory
+    inline size_t persistedCount() const { return mPersistedCount; }
+
 private:
+    int compileModule(const std::string& script, const std::string& hash) const;
+
     std::string mStdLibOverride;
     size_t mOptimizationLevel;
     bool mVerbose;
+    std::string mTargetName;
+    CacheManager* mCacheManager;
 
     mutable std::mutex mCompileMutex;
+    mutable std::unordered_map<std::string, int> mModules; // Hash -> AnyDSL module id
+    mutable std::atomic<size_t> mCompiledCount;
+    mutable std::atomic<size_t> mReusedCount;
+    mutable std::atomic<size_t> mPersistedCount;
 };
 } // namespace IG
\ No newline at end of file
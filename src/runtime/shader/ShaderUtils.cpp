@@ -35,6 +35,8 @@ std::string ShaderUtils::constructDevice(const LoaderContext& ctx)
                << ctx.Options.Target.vectorWidth()
                << ", settings.thread_count"
                << ", 16"
+               << ", " << (ctx.Options.Target.cpuRaySortMode() == CPURaySortMode::Counting ? "true" : "false")
+               << ", " << (ctx.Options.Target.useCPUWavefront() ? "true" : "false")
                << ", true);";
     } else {
         // TODO: Customize kernel config for device?
@@ -55,12 +57,17 @@ std::string ShaderUtils::constructDevice(const LoaderContext& ctx)
 std::string ShaderUtils::generateDatabase(const LoaderContext& ctx)
 {
     std::stringstream stream;
-    stream << "  let entities = load_entity_table(device); maybe_unused(entities);" << std::endl
+    stream << "  let entities = " << generateEntityTable(ctx) << "; maybe_unused(entities);" << std::endl
            << generateShapeLookup(ctx)
            << "  maybe_unused(shapes);" << std::endl;
     return stream.str();
 }
 
+std::string ShaderUtils::generateEntityTable(const LoaderContext& ctx)
+{
+    return ctx.Options.CompactEntities ? "load_compact_entity_table(device)" : "load_entity_table(device)";
+}
+
 std::string ShaderUtils::generateShapeLookup(const LoaderContext& ctx)
 {
     std::vector<ShapeProvider*> provs;
@@ -9,6 +9,7 @@ class ShaderUtils {
 public:
     static std::string constructDevice(const LoaderContext& ctx);
     static std::string generateDatabase(const LoaderContext& ctx);
+    static std::string generateEntityTable(const LoaderContext& ctx);
     static std::string generateShapeLookup(const LoaderContext& ctx);
     static std::string generateShapeLookup(const std::string& varname, ShapeProvider* provider, const LoaderContext& ctx);
     static std::string generateMaterialShader(ShadingTree& tree, size_t mat_id, bool requireLights, const std::string_view& output_var);
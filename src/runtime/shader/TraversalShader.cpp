@@ -17,7 +17,7 @@ std::string TraversalShader::begin(const LoaderContext& ctx)
 
     stream << "#[export] fn ig_traversal_shader(settings: &Settings, size: i32) -> () {" << std::endl
            << "  " << ShaderUtils::constructDevice(ctx) << std::endl
-           << "  let entities = load_entity_table(device); maybe_unused(entities);" << std::endl;
+           << "  let entities = " << ShaderUtils::generateEntityTable(ctx) << "; maybe_unused(entities);" << std::endl;
 
     return stream.str();
 }
@@ -12,6 +12,8 @@
 
 #include "Logger.h"
 
+#include <chrono>
+
 #include <tbb/scalable_allocator.h>
 
 namespace IG {
@@ -304,11 +306,11 @@ struct BvhTemporary {
     std::vector<typename BvhNTriM<N, T>::Tri, tbb::scalable_allocator<typename BvhNTriM<N, T>::Tri>> tris;
 };
 
-template <size_t N, size_t T>
-static void serialize_bvh(Serializer& serializer, BvhTemporary<N, T>& bvh)
+template <typename NodeVector, typename TriVector>
+static void serialize_bvh(Serializer& serializer, NodeVector& nodes, TriVector& tris)
 {
-    uint32 node_count = (uint32)bvh.nodes.size();
-    uint32 tri_count  = (uint32)bvh.tris.size();
+    uint32 node_count = (uint32)nodes.size();
+    uint32 tri_count  = (uint32)tris.size();
     uint32 _pad       = 0;
 
     serializer | node_count;
@@ -317,16 +319,32 @@ static void serialize_bvh(Serializer& serializer, BvhTemporary<N, T>& bvh)
     serializer | _pad;      // Padding
 
     if (serializer.isReadMode()) {
-        serializer.read(bvh.nodes, node_count);
-        serializer.read(bvh.tris, tri_count);
+        serializer.read(nodes, node_count);
+        serializer.read(tris, tri_count);
     } else {
-        serializer.write(bvh.nodes, true);
-        serializer.write(bvh.tris, true);
+        serializer.write(nodes, true);
+        serializer.write(tris, true);
     }
 }
 
+static RuntimeOptions::BvhQuality get_bvh_quality(const std::string& name, SceneObject& elem, const LoaderContext& ctx)
+{
+    const std::string quality = to_lowercase(elem.property("bvh_quality").getString());
+    if (quality.empty())
+        return ctx.Options.BvhBuildQuality;
+    else if (quality == "fast")
+        return RuntimeOptions::BvhQuality::Fast;
+    else if (quality == "balanced")
+        return RuntimeOptions::BvhQuality::Balanced;
+    else if (quality == "high")
+        return RuntimeOptions::BvhQuality::High;
+
+    IG_LOG(L_WARNING) << "Shape '" << name << "': Unknown bvh quality '" << quality << "'. Using default instead" << std::endl;
+    return ctx.Options.BvhBuildQuality;
+}
+
 template <size_t N, size_t T>
-static uint64 setup_bvh(const TriMesh& mesh, LoaderContext& ctx, const std::string& name, std::mutex& mutex)
+static uint64 setup_bvh(const TriMesh& mesh, LoaderContext& ctx, const std::string& name, RuntimeOptions::BvhQuality quality, bool compress, std::mutex& mutex)
 {
     constexpr size_t MinFaceCountForCache = 500000;
     IG_ASSERT(mesh.faceCount() > 0, "Expected mesh to contain some triangles");
@@ -335,30 +353,49 @@ static uint64 setup_bvh(const TriMesh& mesh, LoaderContext& ctx, const std::stri
     bool inCache                     = false;
     const bool isEligible            = mesh.faceCount() > MinFaceCountForCache; // Do not waste effort for small meshes
     if (isEligible && ctx.CacheManager->isEnabled()) {
-        const std::string hash = mesh.computeHash();
+        const std::string hash = mesh.computeHash() + "_" + std::to_string((int)quality);
         inCache                = ctx.CacheManager->checkAndUpdate("bvh_" + name, hash);
     }
 
     BvhTemporary<N, T> bvh;
     if (!inCache || !std::filesystem::exists(path)) {
-        build_bvh<N, T>(mesh, bvh.nodes, bvh.tris);
+        const auto start    = std::chrono::high_resolution_clock::now();
+        const float sahCost = build_bvh<N, T>(mesh, bvh.nodes, bvh.tris, quality);
+        IG_LOG(L_DEBUG) << "Shape '" << name << "': Building bvh for " << mesh.faceCount() << " triangles took "
+                        << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start).count() / 1000.0f
+                        << " seconds [SAH=" << sahCost << "]" << std::endl;
 
         if (ctx.CacheManager->isEnabled() && isEligible) {
             FileSerializer serializer(path, false);
-            serialize_bvh(serializer, bvh);
+            serialize_bvh(serializer, bvh.nodes, bvh.tris);
         }
     } else {
         FileSerializer serializer(path, true);
-        serialize_bvh(serializer, bvh);
+        serialize_bvh(serializer, bvh.nodes, bvh.tris);
     }
 
+    // The cache always contains the full precision nodes, quantization is cheap in comparison to the build
+    std::vector<uint8> data;
+    VectorSerializer serializer(data, false);
+    if constexpr (N > 2) {
+        if (compress) {
+            std::vector<typename BvhNTriM<N, T>::QNode, tbb::scalable_allocator<typename BvhNTriM<N, T>::QNode>> qnodes;
+            quantize_nodes<N>(bvh.nodes, qnodes);
+            serialize_bvh(serializer, qnodes, bvh.tris);
+        } else {
+            serialize_bvh(serializer, bvh.nodes, bvh.tris);
+        }
+    } else {
+        serialize_bvh(serializer, bvh.nodes, bvh.tris);
+    }
+    IG_LOG(L_DEBUG) << "Shape '" << name << "': Bvh requires " << data.size() / 1024 << " KiB" << (compress && N > 2 ? " [compressed]" : "") << std::endl;
+
     {
         std::lock_guard<std::mutex> _guard(mutex);
         auto& bvhTable = ctx.Database.FixTables["trimesh_primbvh"];
         auto& bvhData  = bvhTable.addEntry(DefaultAlignment);
         uint64 offset  = bvhTable.currentOffset() / sizeof(float);
-        VectorSerializer serializer(bvhData, false);
-        serialize_bvh(serializer, bvh);
+        bvhData.insert(bvhData.end(), data.begin(), data.end());
         return offset;
     }
 }
@@ -549,13 +586,14 @@ void TriMeshProvider::handle(LoaderContext& ctx, ShapeMTAccessor& acc, const std
     IG_ASSERT((mesh.indices.size() % 4) == 0, "Expected index buffer count to be a multiple of 4!");
 
     // Setup bvh
-    uint64 bvh_offset = 0;
+    const auto bvhQuality = get_bvh_quality(name, elem, ctx);
+    uint64 bvh_offset     = 0;
     if (ctx.Options.Target.isGPU()) {
-        bvh_offset = setup_bvh<2, 1>(mesh, ctx, name, mBvhMutex);
+        bvh_offset = setup_bvh<2, 1>(mesh, ctx, name, bvhQuality, false, mBvhMutex);
     } else if (ctx.Options.Target.vectorWidth() < 8) {
-        bvh_offset = setup_bvh<4, 4>(mesh, ctx, name, mBvhMutex);
+        bvh_offset = setup_bvh<4, 4>(mesh, ctx, name, bvhQuality, ctx.Options.CompressBvh, mBvhMutex);
     } else {
-        bvh_offset = setup_bvh<8, 4>(mesh, ctx, name, mBvhMutex);
+        bvh_offset = setup_bvh<8, 4>(mesh, ctx, name, bvhQuality, ctx.Options.CompressBvh, mBvhMutex);
     }
 
     // Precompute approximative shapes outside the lock region
@@ -616,6 +654,28 @@ void TriMeshProvider::handle(LoaderContext& ctx, ShapeMTAccessor& acc, const std
     acc.DatabaseAccessMutex.unlock();
 }
 
+std::vector<float> TriMeshProvider::computeFaceAreas(const LoaderContext& ctx, uint32 shapeID, const Transformf& transform)
+{
+    const auto& shape = ctx.Shapes->getShape(shapeID);
+    const auto& tri   = ctx.Shapes->getTriShape(shapeID);
+
+    // See handle() for the layout. Vertices and normals are padded to four floats
+    const float* data     = reinterpret_cast<const float*>(ctx.Database.DynTables.at("shapes").data() + shape.TableOffset);
+    const float* vertices = data + 12;
+    const uint32* indices = reinterpret_cast<const uint32*>(vertices + 4 * (tri.VertexCount + tri.NormalCount));
+
+    const auto vertex = [&](uint32 i) { return transform * Vector3f(vertices[4 * i + 0], vertices[4 * i + 1], vertices[4 * i + 2]); };
+
+    std::vector<float> areas(tri.FaceCount);
+    for (size_t f = 0; f < tri.FaceCount; ++f) {
+        const Vector3f v0 = vertex(indices[4 * f + 0]);
+        const Vector3f v1 = vertex(indices[4 * f + 1]);
+        const Vector3f v2 = vertex(indices[4 * f + 2]);
+        areas[f]          = 0.5f * (v1 - v0).cross(v2 - v0).norm();
+    }
+    return areas;
+}
+
 std::string TriMeshProvider::generateShapeCode(const LoaderContext& ctx)
 {
     IG_UNUSED(ctx);
@@ -630,7 +690,7 @@ std::string TriMeshProvider::generateTraversalCode(const LoaderContext& ctx)
     if (ctx.Options.Target.isGPU()) {
         stream << "  let prim_bvhs = make_gpu_trimesh_bvh_table(device);" << std::endl;
     } else {
-        stream << "  let prim_bvhs = make_cpu_trimesh_bvh_table(device, " << ctx.Options.Target.vectorWidth() << ");" << std::endl;
+        stream << "  let prim_bvhs = make_cpu_trimesh_bvh_table(device, " << ctx.Options.Target.vectorWidth() << ", " << (ctx.Options.CompressBvh ? "true" : "false") << ");" << std::endl;
     }
 
     stream << "  let trace   = TraceAccessor { shapes = trimesh_shapes, entities = entities };" << std::endl
@@ -16,6 +16,9 @@ public:
     std::string generateShapeCode(const LoaderContext& ctx) override;
     std::string generateTraversalCode(const LoaderContext& ctx) override;
 
+    /// @brief Compute the area of every triangle of an already loaded shape after applying the given transform
+    [[nodiscard]] static std::vector<float> computeFaceAreas(const LoaderContext& ctx, uint32 shapeID, const Transformf& transform);
+
 private:
     std::mutex mBvhMutex;
 };
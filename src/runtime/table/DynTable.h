@@ -13,10 +13,25 @@ class DynTable {
 public:
     DynTable() = default;
 
-    [[nodiscard]] inline size_t entryCount() const { return mLookups.size(); }
+    /// @brief Construct a table referencing external memory, e.g., a mapped cache file. The owner keeps the memory alive.
+    /// The memory is only copied if the table is modified afterwards
+    [[nodiscard]] static inline DynTable makeView(const std::shared_ptr<const void>& owner, const LookupEntry* lookups, size_t lookupCount, const uint8* data, size_t size)
+    {
+        DynTable table;
+        table.mViewOwner       = owner;
+        table.mViewLookups     = lookups;
+        table.mViewLookupCount = lookupCount;
+        table.mViewData        = data;
+        table.mViewSize        = size;
+        return table;
+    }
+
+    [[nodiscard]] inline size_t entryCount() const { return isView() ? mViewLookupCount : mLookups.size(); }
     inline void reserve(size_t size) { mData.reserve(size); }
     [[nodiscard]] inline std::vector<uint8>& addLookup(uint32 typeID, uint32 flags, size_t alignment)
     {
+        materialize();
+
         if (alignment != 0 && !mData.empty()) {
             size_t defect = alignment - mData.size() % alignment;
             mData.resize(mData.size() + defect);
@@ -26,12 +41,31 @@ public:
         return mData;
     }
 
-    [[nodiscard]] inline const std::vector<LookupEntry>& lookups() const { return mLookups; }
-    [[nodiscard]] inline const std::vector<uint8>& data() const { return mData; }
-    [[nodiscard]] inline size_t currentOffset() const { return mData.size(); } // TODO: Maybe this should be given as multiple of 4?
+    [[nodiscard]] inline bool isView() const { return mViewOwner != nullptr; }
+    [[nodiscard]] inline const LookupEntry* lookups() const { return isView() ? mViewLookups : mLookups.data(); }
+    [[nodiscard]] inline const uint8* data() const { return isView() ? mViewData : mData.data(); }
+    [[nodiscard]] inline size_t currentOffset() const { return isView() ? mViewSize : mData.size(); } // TODO: Maybe this should be given as multiple of 4?
 
 private:
+    inline void materialize()
+    {
+        if (!isView())
+            return;
+
+        mLookups.assign(mViewLookups, mViewLookups + mViewLookupCount);
+        mData.assign(mViewData, mViewData + mViewSize);
+        mViewOwner.reset();
+        mViewLookups = nullptr;
+        mViewData    = nullptr;
+    }
+
     std::vector<LookupEntry> mLookups;
     std::vector<uint8> mData;
+
+    std::shared_ptr<const void> mViewOwner;
+    const LookupEntry* mViewLookups = nullptr;
+    size_t mViewLookupCount         = 0;
+    const uint8* mViewData          = nullptr;
+    size_t mViewSize                = 0;
 };
-} // namespace IG
\ No newline at end of file
+} // namespace IG
@@ -10,9 +10,23 @@ class FixTable {
 public:
     FixTable() = default;
 
+    /// @brief Construct a table referencing external memory, e.g., a mapped cache file. The owner keeps the memory alive.
+    /// The memory is only copied if the table is modified afterwards
+    [[nodiscard]] static inline FixTable makeView(const std::shared_ptr<const void>& owner, size_t entryCount, const uint8* data, size_t size)
+    {
+        FixTable table;
+        table.mCount     = entryCount;
+        table.mViewOwner = owner;
+        table.mViewData  = data;
+        table.mViewSize  = size;
+        return table;
+    }
+
     inline void reserve(size_t size) { mData.reserve(size); }
     [[nodiscard]] inline std::vector<uint8>& addEntry(size_t alignment)
     {
+        materialize();
+
         if (alignment != 0 && !mData.empty()) {
             size_t defect = alignment - mData.size() % alignment;
             mData.resize(mData.size() + defect);
@@ -22,12 +36,45 @@ public:
         return mData;
     }
 
-    [[nodiscard]] inline const std::vector<uint8>& data() const { return mData; }
-    [[nodiscard]] inline size_t currentOffset() const { return mData.size(); } // TODO: Maybe this should be given as multiple of 4?
+    /// @brief Add multiple entries of the same size at once. The returned memory is zero initialized and can be filled in parallel
+    [[nodiscard]] inline uint8* addEntries(size_t count, size_t entrySize)
+    {
+        materialize();
+
+        const size_t offset = mData.size();
+        mData.resize(offset + count * entrySize);
+        mCount += count;
+        return mData.data() + offset;
+    }
+
+    [[nodiscard]] inline bool isView() const { return mViewOwner != nullptr; }
+    [[nodiscard]] inline const uint8* data() const { return isView() ? mViewData : mData.data(); }
+    [[nodiscard]] inline size_t currentOffset() const { return isView() ? mViewSize : mData.size(); } // TODO: Maybe this should be given as multiple of 4?
     [[nodiscard]] inline size_t entryCount() const { return mCount; }
 
+    /// @brief Modifiable access to already added entries. Views are copied first, which invalidates previously returned data pointers
+    [[nodiscard]] inline uint8* accessData()
+    {
+        materialize();
+        return mData.data();
+    }
+
 private:
+    inline void materialize()
+    {
+        if (!isView())
+            return;
+
+        mData.assign(mViewData, mViewData + mViewSize);
+        mViewOwner.reset();
+        mViewData = nullptr;
+    }
+
     size_t mCount = 0;
     std::vector<uint8> mData;
+
+    std::shared_ptr<const void> mViewOwner;
+    const uint8* mViewData = nullptr;
+    size_t mViewSize       = 0;
 };
-} // namespace IG
\ No newline at end of file
+} // namespace IG
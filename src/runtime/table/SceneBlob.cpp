@@ -0,0 +1,190 @@
+#include "SceneBlob.h"
+#include "Logger.h"
+#include "serialization/MappedFile.h"
+
+#include <fstream>
+
+namespace IG {
+constexpr uint32 BlobMagic         = 0x42534749; // 'IGSB'
+constexpr size_t BlobPageAlignment = 4096;
+constexpr size_t BlobKeySize       = 64;
+constexpr size_t BlobNameSize      = 48;
+
+enum BlobSectionKind : uint32 {
+    BSK_DynTable = 0,
+    BSK_FixTable,
+    BSK_UserData
+};
+
+struct BlobHeader {
+    uint32 Magic;
+    uint32 Version;
+    uint32 SectionCount;
+    uint32 _Pad;
+    char Key[BlobKeySize];
+};
+
+struct BlobSection {
+    uint32 Kind;
+    uint32 _Pad;
+    char Name[BlobNameSize];
+    uint64 EntryCount;
+    uint64 LookupOffset; // Only used by dyntables
+    uint64 DataOffset;
+    uint64 DataSize;
+};
+
+static_assert(sizeof(BlobHeader) % 8 == 0 && sizeof(BlobSection) % 8 == 0, "Expected blob structures to be tightly packed");
+
+static inline uint64 alignBlobOffset(uint64 offset)
+{
+    return (offset + BlobPageAlignment - 1) / BlobPageAlignment * BlobPageAlignment;
+}
+
+static inline void writeBlobRange(std::ofstream& stream, uint64 offset, const void* data, size_t size)
+{
+    if (size == 0)
+        return;
+
+    stream.seekp((std::streamoff)offset);
+    stream.write(reinterpret_cast<const char*>(data), (std::streamsize)size);
+}
+
+bool SceneBlob::save(const Path& path, const std::string& key, const SceneDatabase& database, const Content& content)
+{
+    IG_ASSERT(key.size() <= BlobKeySize, "Expected key to be shorter than the reserved space");
+
+    // Layout the file first
+    std::vector<BlobSection> sections;
+    std::vector<std::pair<const void*, const void*>> sources; // Lookups and data
+    const auto addSection = [&](BlobSectionKind kind, const std::string& name, size_t entryCount, const void* lookups, const void* data, size_t size) {
+        IG_ASSERT(name.size() < BlobNameSize, "Expected table name to fit into the reserved space");
+
+        BlobSection section{};
+        section.Kind       = kind;
+        section.EntryCount = entryCount;
+        section.DataSize   = size;
+        std::strncpy(section.Name, name.c_str(), BlobNameSize - 1);
+        sections.push_back(section);
+        sources.emplace_back(lookups, data);
+    };
+
+    for (const auto& name : content.DynTables) {
+        const auto& table = database.DynTables.at(name);
+        addSection(BSK_DynTable, name, table.entryCount(), table.lookups(), table.data(), table.currentOffset());
+    }
+
+    for (const auto& name : content.FixTables) {
+        const auto& table = database.FixTables.at(name);
+        addSection(BSK_FixTable, name, table.entryCount(), nullptr, table.data(), table.currentOffset());
+    }
+
+    addSection(BSK_UserData, "", 0, nullptr, content.UserData.data(), content.UserData.size());
+
+    uint64 offset = sizeof(BlobHeader) + sections.size() * sizeof(BlobSection);
+    for (auto& section : sections) {
+        if (section.Kind == BSK_DynTable) {
+            section.LookupOffset = alignBlobOffset(offset);
+            offset               = section.LookupOffset + section.EntryCount * sizeof(LookupEntry);
+        }
+        section.DataOffset = alignBlobOffset(offset);
+        offset             = section.DataOffset + section.DataSize;
+    }
+
+    BlobHeader header{};
+    header.Magic        = BlobMagic;
+    header.Version      = Version;
+    header.SectionCount = (uint32)sections.size();
+    std::memcpy(header.Key, key.data(), std::min(key.size(), BlobKeySize));
+
+    // Write to a temporary file first, such that an interrupted write never leaves a valid looking blob behind
+    Path tmpPath = path;
+    tmpPath += ".tmp";
+    {
+        std::ofstream stream(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!stream) {
+            IG_LOG(L_ERROR) << "Could not write scene blob " << tmpPath << std::endl;
+            return false;
+        }
+
+        writeBlobRange(stream, 0, &header, sizeof(header));
+        writeBlobRange(stream, sizeof(header), sections.data(), sections.size() * sizeof(BlobSection));
+        for (size_t i = 0; i < sections.size(); ++i) {
+            if (sections[i].Kind == BSK_DynTable)
+                writeBlobRange(stream, sections[i].LookupOffset, sources[i].first, sections[i].EntryCount * sizeof(LookupEntry));
+            writeBlobRange(stream, sections[i].DataOffset, sources[i].second, sections[i].DataSize);
+        }
+
+        if (!stream) {
+            IG_LOG(L_ERROR) << "Could not write scene blob " << tmpPath << std::endl;
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec) {
+        IG_LOG(L_ERROR) << "Could not write scene blob " << path << ": " << ec.message() << std::endl;
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+
+    return true;
+}
+
+bool SceneBlob::load(const Path& path, const std::string& key, SceneDatabase& database, Content& content)
+{
+    if (!std::filesystem::exists(path))
+        return false;
+
+    auto file = std::make_shared<MappedFile>(path);
+    if (!file->isValid() || file->size() < sizeof(BlobHeader))
+        return false;
+
+    const auto* header = reinterpret_cast<const BlobHeader*>(file->data());
+    if (header->Magic != BlobMagic || header->Version != Version)
+        return false;
+
+    if (std::string(header->Key, strnlen(header->Key, BlobKeySize)) != key)
+        return false;
+
+    if (sizeof(BlobHeader) + header->SectionCount * sizeof(BlobSection) > file->size())
+        return false;
+
+    // Validate everything before touching the database
+    const auto* sections = reinterpret_cast<const BlobSection*>(file->data() + sizeof(BlobHeader));
+    for (size_t i = 0; i < header->SectionCount; ++i) {
+        const auto& section = sections[i];
+        if (section.DataOffset + section.DataSize > file->size())
+            return false;
+        if (section.Kind == BSK_DynTable && section.LookupOffset + section.EntryCount * sizeof(LookupEntry) > file->size())
+            return false;
+    }
+
+    content = Content{};
+    for (size_t i = 0; i < header->SectionCount; ++i) {
+        const auto& section    = sections[i];
+        const std::string name = std::string(section.Name, strnlen(section.Name, BlobNameSize));
+        const uint8* data      = file->data() + section.DataOffset;
+
+        switch (section.Kind) {
+        case BSK_DynTable:
+            database.DynTables[name] = DynTable::makeView(file, reinterpret_cast<const LookupEntry*>(file->data() + section.LookupOffset), section.EntryCount, data, section.DataSize);
+            content.DynTables.push_back(name);
+            break;
+        case BSK_FixTable:
+            database.FixTables[name] = FixTable::makeView(file, section.EntryCount, data, section.DataSize);
+            content.FixTables.push_back(name);
+            break;
+        case BSK_UserData:
+            content.UserData.assign(data, data + section.DataSize);
+            break;
+        default:
+            IG_LOG(L_WARNING) << "Unknown section in scene blob " << path << std::endl;
+            break;
+        }
+    }
+
+    return true;
+}
+} // namespace IG
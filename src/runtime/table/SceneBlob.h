@@ -0,0 +1,35 @@
+#pragma once
+
+#include "SceneDatabase.h"
+
+namespace IG {
+class MappedFile;
+
+/// Versioned on-disk image of tables of the scene database.
+/// All tables are stored exactly as the device expects them and aligned to memory pages.
+/// Loading maps the file into memory and installs the tables as views without any parsing or copying
+class IG_LIB SceneBlob {
+public:
+    /// Increase if the layout of the file or of any stored table changes
+    static constexpr uint32 Version = 1;
+
+    struct Content {
+        std::vector<std::string> DynTables;
+        std::vector<std::string> FixTables;
+        std::vector<uint8> UserData; // Opaque data for the loader, e.g., shape registries
+    };
+
+    /// @brief Write the given tables of the database to the file. The file is written atomically
+    /// @param path Path of the blob
+    /// @param key Identifies the input the tables were generated from, e.g., a hash of the scene description
+    /// @return True if successful
+    static bool save(const Path& path, const std::string& key, const SceneDatabase& database, const Content& content);
+
+    /// @brief Map the file into memory and install the stored tables as views into the database
+    /// @param path Path of the blob
+    /// @param key Has to match the key given while saving
+    /// @param content Names of the tables and user data found in the blob
+    /// @return False if the file does not exist, is invalid or was written for a different version or key. The database is not modified in that case
+    static bool load(const Path& path, const std::string& key, SceneDatabase& database, Content& content);
+};
+} // namespace IG
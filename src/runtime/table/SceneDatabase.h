@@ -10,13 +10,31 @@ struct SceneBVH {
     std::vector<uint8> Leaves;
 };
 
+/// @brief Entity as required to update it after the scene was loaded
+struct SceneEntity {
+    std::string_view Provider; // Identifier of the scene bvh containing the entity
+    BoundingBox ShapeBBox;     // Bounding box of the shape in local space
+    Transformf Transform;
+    uint32 ShapeID;
+    uint32 MaterialID;
+    int32 User1ID;
+    int32 User2ID;
+    uint32 Flags;
+    uint32 TransformID; // Only used with the compact entity layout
+    bool Emissive;      // The transform of emissive entities is embedded into the lights as well
+};
+
 struct SceneDatabase {
     std::unordered_map<std::string_view, SceneBVH> SceneBVHs;
     std::unordered_map<std::string, DynTable> DynTables;
     std::unordered_map<std::string, FixTable> FixTables;
 
+    std::vector<SceneEntity> Entities; // Indexed by entity id
+    std::unordered_map<std::string, uint32> EntityIDs;
+    std::vector<uint32> TransformUseCount; // Number of entities sharing a transform. Only used with the compact entity layout
+
     float SceneRadius;
     BoundingBox SceneBBox;
     size_t MaterialCount;
 };
-} // namespace IG
\ No newline at end of file
+} // namespace IG
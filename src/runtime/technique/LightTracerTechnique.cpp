@@ -73,7 +73,7 @@ void LightTracerTechnique::generateBody(const SerializationInput& input) const
     else
         input.Stream << "  let tech_clamp = registry::get_global_parameter_f32(\"__tech_clamp\", 0);" << std::endl;
 
-    input.Stream << "  let framebuffer = device.load_aov_image(\"\", spi);" << std::endl
+    input.Stream << "  let framebuffer = device.load_splat_aov_image(\"\", spi);" << std::endl
                  << "  let technique = make_lt_renderer(camera, framebuffer, tech_max_depth, tech_min_depth, tech_clamp);" << std::endl;
 }
 
@@ -1,4 +1,5 @@
 #include "PhotonMappingTechnique.h"
+#include "Logger.h"
 #include "loader/LoaderContext.h"
 #include "loader/LoaderLight.h"
 #include "loader/LoaderUtils.h"
@@ -12,6 +13,8 @@ PhotonMappingTechnique::PhotonMappingTechnique(SceneObject& obj)
     : Technique("ppm")
 {
     mPhotonCount    = (size_t)std::max(100, obj.property("photons").getInteger(1000000));
+    mPhotonSPI      = (size_t)std::max(1, obj.property("photon_spi").getInteger(1));
+    mPhotonPasses   = (size_t)std::max(1, obj.property("photon_passes").getInteger(1));
     mMaxCameraDepth = (size_t)obj.property("max_depth").isValid() ? obj.property("max_depth").getInteger(DefaultMaxRayDepth) : obj.property("max_camera_depth").getInteger(DefaultMaxRayDepth);
     mMinCameraDepth = (size_t)obj.property("min_depth").isValid() ? obj.property("min_depth").getInteger(DefaultMinRayDepth) : obj.property("min_camera_depth").getInteger(DefaultMinRayDepth);
     mMaxLightDepth  = (size_t)obj.property("max_light_depth").getInteger(8);
@@ -19,6 +22,17 @@ PhotonMappingTechnique::PhotonMappingTechnique(SceneObject& obj)
     mMergeRadius    = obj.property("radius").getNumber(0.01f);
     mClamp          = obj.property("clamp").getNumber(0.0f);
     mAOV            = obj.property("aov").getBool(false);
+
+    // The photons of a light pass are distributed over multiple samples per iteration, which keeps the launch size small
+    mPhotonCount = ((mPhotonCount + mPhotonSPI - 1) / mPhotonSPI) * mPhotonSPI;
+
+    // All light passes kept in the cache have to be addressable with 32 bit
+    constexpr size_t PhotonSize = 12;
+    const size_t maxPasses      = std::max<size_t>(1, (size_t)std::numeric_limits<int32>::max() / (mPhotonCount * PhotonSize + 4));
+    if (mPhotonPasses > maxPasses) {
+        IG_LOG(L_WARNING) << "Photon mapper can only keep " << maxPasses << " light passes of " << mPhotonCount << " photons. Reducing the number of passes from " << mPhotonPasses << std::endl;
+        mPhotonPasses = maxPasses;
+    }
 }
 
 static std::string ppm_light_camera_generator(LoaderContext& ctx, const std::string& light_selector)
@@ -43,7 +57,10 @@ static std::string ppm_before_iteration_generator(LoaderContext& ctx)
 
     stream << ShaderUtils::beginCallback(ctx) << std::endl
            << "  let tech_photons = registry::get_global_parameter_i32(\"__tech_photon_count\", 1000);" << std::endl
-           << "  ppm_handle_before_iteration(device, iter, " << ctx.CurrentTechniqueVariant << ", tech_photons, scene_bbox);" << std::endl
+           << "  let tech_photon_passes = registry::get_global_parameter_i32(\"__tech_photon_passes\", 1);" << std::endl
+           << "  let tech_radius = registry::get_global_parameter_f32(\"__tech_radius\", 0);" << std::endl
+           << "  let ppm_radius = ppm_compute_radius(tech_radius, settings.iter);" << std::endl
+           << "  ppm_handle_before_iteration(device, settings.iter, " << ctx.CurrentTechniqueVariant << ", tech_photons, tech_photon_passes, ppm_radius, scene_bbox);" << std::endl
            << ShaderUtils::endCallback() << std::endl;
 
     return stream.str();
@@ -71,9 +88,9 @@ TechniqueInfo PhotonMappingTechnique::getInfo(const LoaderContext&) const
     info.Variants[1].CallbackGenerators[(int)CallbackType::BeforeIteration] = ppm_before_iteration_generator; // Construct query structure
 
     // The LT works independent of the framebuffer and requires a different work size
-    info.Variants[0].OverrideWidth  = mPhotonCount; // Photon count
+    info.Variants[0].OverrideWidth  = mPhotonCount / mPhotonSPI; // Photon count per sample
     info.Variants[0].OverrideHeight = 1;
-    info.Variants[0].OverrideSPI    = 1; // The light tracer variant is always just one spi (Could be improved in the future though)
+    info.Variants[0].OverrideSPI    = mPhotonSPI;
 
     info.Variants[0].LockFramebuffer = true; // We do not change the framebuffer
 
@@ -94,11 +111,16 @@ void PhotonMappingTechnique::generateBody(const SerializationInput& input) const
     input.Context.GlobalRegistry.IntParameters["__tech_min_camera_depth"] = (int)mMinCameraDepth;
     input.Context.GlobalRegistry.IntParameters["__tech_max_light_depth"]  = (int)mMaxLightDepth;
     input.Context.GlobalRegistry.IntParameters["__tech_photon_count"]     = (int)mPhotonCount;
+    input.Context.GlobalRegistry.IntParameters["__tech_photon_passes"]    = (int)mPhotonPasses;
     input.Context.GlobalRegistry.FloatParameters["__tech_radius"]         = mMergeRadius * input.Context.SceneDiameter;
     input.Context.GlobalRegistry.FloatParameters["__tech_clamp"]          = mClamp;
 
     // Load registry information
     input.Stream << "  let tech_photons = registry::get_global_parameter_i32(\"__tech_photon_count\", 1000);" << std::endl;
+    if (mPhotonPasses < 2) // 1 can be an optimization
+        input.Stream << "  let tech_photon_passes = " << mPhotonPasses << ":i32;" << std::endl;
+    else
+        input.Stream << "  let tech_photon_passes = registry::get_global_parameter_i32(\"__tech_photon_passes\", 1);" << std::endl;
     if (!is_light_pass) {
         if (mMaxCameraDepth < 2) // 0 & 1 can be an optimization
             input.Stream << "  let tech_max_camera_depth = " << mMaxCameraDepth << ":i32;" << std::endl;
@@ -152,14 +174,16 @@ void PhotonMappingTechnique::generateBody(const SerializationInput& input) const
                      << "  };" << std::endl;
     }
 
-    input.Stream << "  let light_cache = make_ppm_lightcache(device, tech_photons, scene_bbox);" << std::endl;
-
     if (is_light_pass) {
-        input.Stream << "  let technique = make_ppm_light_renderer(tech_max_light_depth, aovs, light_cache);" << std::endl;
+        // The light pass only splats photons, therefore the grid is not required
+        input.Stream << "  let light_cache = make_ppm_lightcache(device, settings.iter, tech_photons, tech_photon_passes, 0, scene_bbox);" << std::endl
+                     << "  let technique = make_ppm_light_renderer(tech_max_light_depth, aovs, light_cache);" << std::endl;
     } else {
+        // The grid cell size depends on the merge radius and has to match the one used in the callback
         ShadingTree tree(input.Context);
         input.Stream << input.Context.Lights->generateLightSelector(mLightSelector, tree)
                      << "  let ppm_radius = ppm_compute_radius(tech_radius, settings.iter);" << std::endl
+                     << "  let light_cache = make_ppm_lightcache(device, settings.iter, tech_photons, tech_photon_passes, ppm_radius, scene_bbox);" << std::endl
                      << "  let technique = make_ppm_path_renderer(tech_max_camera_depth, tech_min_camera_depth, light_selector, ppm_radius, aovs, tech_clamp, light_cache);" << std::endl;
     }
 }
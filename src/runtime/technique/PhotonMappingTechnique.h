@@ -15,6 +15,8 @@ public:
 
 private:
     size_t mPhotonCount;
+    size_t mPhotonSPI;
+    size_t mPhotonPasses;
     size_t mMaxCameraDepth;
     size_t mMinCameraDepth;
     size_t mMaxLightDepth;
@@ -27,6 +27,7 @@ struct TechniqueVariantBase {
     ShaderOutput<T> RayGenerationShader;
     ShaderOutput<T> MissShader;
     std::vector<ShaderOutput<T>> HitShaders;
+    ShaderOutput<T> FallbackHitShader; // Generic material shader used while hit shaders are compiled on demand. Only available for lazy compilation
     std::vector<ShaderOutput<T>> AdvancedShadowHitShaders;
     std::vector<ShaderOutput<T>> AdvancedShadowMissShaders;
     std::array<ShaderOutput<T>, (size_t)CallbackType::_COUNT> CallbackShaders{};
@@ -1,3 +1,4 @@
+#include <cstdint>
 #include <iostream>
 
 #include "generated_test_interface.h"
@@ -19,6 +20,12 @@ void ignis_test_fail(unsigned char* msg)
     std::cout << "Expression failed: " << reinterpret_cast<const char*>(msg) << std::endl;
 }
 
+void ignis_test_bench(unsigned char* name, int size, int variant, int64_t time_a, int64_t time_b)
+{
+    std::cout << "Bench " << reinterpret_cast<const char*>(name) << " [size=" << size << ", variant=" << variant << "]: "
+              << time_a << "us vs. " << time_b << "us" << std::endl;
+}
+
 void ignis_dbg_echo_i32(int a)
 {
     std::cout << "Debug: " << a << std::endl;
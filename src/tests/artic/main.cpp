@@ -19,7 +19,21 @@ int main(int argc, char** argv)
     _mm_setcsr(_mm_getcsr() | (_MM_FLUSH_ZERO_ON | _MM_DENORMALS_ZERO_ON));
 #endif
 
-    bool no_gpu = argc > 1 && std::strcmp(argv[1], "--no-gpu") == 0;
+    bool no_gpu = false;
+    bool bench  = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--no-gpu") == 0)
+            no_gpu = true;
+        else if (std::strcmp(argv[i], "--bench") == 0)
+            bench = true;
+    }
+
+    // Benchmarks are not part of the regular test run
+    if (bench) {
+        bench_main();
+        return 0;
+    }
+
     int err = test_main(no_gpu);
 
     if (err != 0)
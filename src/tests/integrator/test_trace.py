@@ -0,0 +1,69 @@
+from common import load_api, create_flat_scene
+import json
+import numpy as np
+import pytest
+
+
+def create_lit_scene():
+    scene = create_flat_scene()
+    scene["lights"].append(
+        {"type": "point", "name": "_light", "position": [0, 0, -2], "intensity": [1, 1, 1]})
+    return json.dumps(scene)
+
+
+def load_tracer(ignis):
+    # trace() is only available in runtimes set up as tracer
+    return ignis.loadFromString(create_lit_scene(), ignis.RuntimeOptions.makeDefault(True))
+
+
+def create_rays(count):
+    # Every even ray hits the plane, every odd ray points away from it and misses
+    origins = np.zeros((count, 3), dtype=np.float32)
+    origins[:, 2] = -1
+    directions = np.zeros((count, 3), dtype=np.float32)
+    directions[:, 2] = np.where(np.arange(count) % 2 == 0, 1, -1)
+    return origins, directions
+
+
+def test_trace_arrays():
+    ignis = load_api()
+    with load_tracer(ignis) as runtime:
+        origins, directions = create_rays(64)
+        output = np.zeros((64, 3), dtype=np.float32)
+        assert runtime.trace(origins, directions, output)
+
+        assert np.all(output[0::2] > 0)
+        assert np.all(output[1::2] == 0)
+
+
+def test_trace_arrays_read_only():
+    ignis = load_api()
+    with load_tracer(ignis) as runtime:
+        origins, directions = create_rays(64)
+        origins.flags.writeable = False
+        directions.flags.writeable = False
+        output = np.zeros((64, 3), dtype=np.float32)
+        assert runtime.trace(origins, directions, output)
+        assert np.all(output[0::2] > 0)
+
+
+def test_trace_arrays_with_ranges():
+    ignis = load_api()
+    with load_tracer(ignis) as runtime:
+        origins, directions = create_rays(64)
+
+        # The plane is at distance one, which is outside the given range
+        ranges = np.zeros((64, 2), dtype=np.float32)
+        ranges[:, 1] = 0.5
+        output = np.ones((64, 3), dtype=np.float32)
+        assert runtime.trace(origins, directions, ranges, output)
+        assert np.all(output == 0)
+
+
+def test_trace_arrays_mismatch():
+    ignis = load_api()
+    with load_tracer(ignis) as runtime:
+        origins, directions = create_rays(64)
+        output = np.zeros((32, 3), dtype=np.float32)
+        with pytest.raises(BufferError):
+            runtime.trace(origins, directions, output)
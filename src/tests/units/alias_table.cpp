@@ -0,0 +1,55 @@
+#include "CDF.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+using namespace IG;
+// Reconstruct the probability of every entry from the alias table
+static std::vector<float> reconstruct(const std::vector<float>& table)
+{
+    const size_t count = table.size() / 4;
+    std::vector<float> pdf(count, 0.0f);
+    for (size_t i = 0; i < count; ++i) {
+        int32 alias;
+        std::memcpy(&alias, &table[4 * i + 1], sizeof(int32));
+
+        pdf[i] += table[4 * i + 0] / count;
+        pdf[alias] += (1 - table[4 * i + 0]) / count;
+    }
+    return pdf;
+}
+
+TEST_CASE("Check if the alias table reproduces the given distribution", "[CDF]")
+{
+    const std::vector<float> values = { 1, 0, 4, 2, 0.5f, 8, 0, 0.25f, 3 };
+
+    float sum = 0;
+    for (float v : values)
+        sum += v;
+
+    std::vector<float> table = { 42 }; // Table is appended
+    CDF::computeAliasForArray(values, table);
+    REQUIRE(table.size() == 1 + 4 * values.size());
+    CHECK(table.front() == 42);
+
+    const std::vector<float> entries(table.begin() + 1, table.end());
+    const auto pdf = reconstruct(entries);
+    for (size_t i = 0; i < values.size(); ++i) {
+        CHECK(std::abs(pdf[i] - values[i] / sum) <= 1e-5f);
+        CHECK(std::abs(entries[4 * i + 2] - values[i] / sum) <= 1e-5f);
+        CHECK(entries[4 * i + 0] >= 0);
+        CHECK(entries[4 * i + 0] <= 1);
+    }
+}
+
+TEST_CASE("Check if the alias table falls back to a uniform distribution", "[CDF]")
+{
+    std::vector<float> table;
+    CDF::computeAliasForArray({ 0, 0, 0, 0 }, table);
+    REQUIRE(table.size() == 16);
+
+    const auto pdf = reconstruct(table);
+    for (size_t i = 0; i < 4; ++i) {
+        CHECK(std::abs(pdf[i] - 0.25f) <= 1e-5f);
+        CHECK(table[4 * i + 2] == 0.25f);
+    }
+}
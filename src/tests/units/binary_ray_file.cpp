@@ -0,0 +1,166 @@
+#include "BinaryRayFile.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstring>
+#include <filesystem>
+
+using namespace IG;
+
+// The magic numbers are part of the file format
+constexpr uint32 InputMagic  = 0x49524749; // "IGRI"
+constexpr uint32 OutputMagic = 0x4F524749; // "IGRO"
+
+constexpr size_t RayCount = 5;
+
+// Component c of ray i
+static inline float rayComponent(size_t i, size_t c) { return float(i * 10 + c); }
+
+static Path writeInput(const std::string& name, BinaryRayLayout layout, uint32 magic, size_t count, size_t storedCount)
+{
+    const BinaryRayHeader header = { magic, 1, (uint16)layout, 0, 8, count };
+
+    std::vector<float> data(storedCount * 8);
+    for (size_t i = 0; i < storedCount; ++i) {
+        for (size_t c = 0; c < 8; ++c)
+            data[layout == BinaryRayLayout::AoS ? i * 8 + c : c * storedCount + i] = rayComponent(i, c);
+    }
+
+    const Path path = std::filesystem::temp_directory_path() / name;
+    std::ofstream stream(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    stream.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(float));
+    return path;
+}
+
+static std::vector<uint8> readFile(const Path& path)
+{
+    std::ifstream stream(path, std::ios::in | std::ios::binary);
+    return std::vector<uint8>(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+}
+
+static void checkBatch(const RayBatch& batch, size_t offset)
+{
+    for (size_t i = 0; i < batch.Count; ++i) {
+        const size_t k = i * batch.Stride;
+        const size_t r = i * batch.RangeStride;
+        CHECK(batch.OriginX[k] == rayComponent(offset + i, 0));
+        CHECK(batch.OriginY[k] == rayComponent(offset + i, 1));
+        CHECK(batch.OriginZ[k] == rayComponent(offset + i, 2));
+        CHECK(batch.DirectionX[k] == rayComponent(offset + i, 3));
+        CHECK(batch.DirectionY[k] == rayComponent(offset + i, 4));
+        CHECK(batch.DirectionZ[k] == rayComponent(offset + i, 5));
+        CHECK(batch.TMin[r] == rayComponent(offset + i, 6));
+        CHECK(batch.TMax[r] == rayComponent(offset + i, 7));
+    }
+}
+
+TEST_CASE("Check if binary ray input is read in chunks", "[BinaryRayFile]")
+{
+    for (auto layout : { BinaryRayLayout::AoS, BinaryRayLayout::SoA }) {
+        const Path path = writeInput("_ig_test_rays_in.bin", layout, InputMagic, RayCount, RayCount);
+        {
+            BinaryRayReader reader;
+            REQUIRE(reader.open(path));
+            CHECK(reader.header().Layout == (uint16)layout);
+            CHECK(reader.header().RecordSize == 8);
+            CHECK(reader.header().Count == RayCount);
+
+            RayBatch batch;
+            REQUIRE(reader.next(3, batch));
+            REQUIRE(batch.Count == 3);
+            checkBatch(batch, 0);
+
+            REQUIRE(reader.next(3, batch));
+            REQUIRE(batch.Count == 2);
+            checkBatch(batch, 3);
+
+            CHECK(reader.isFinished());
+            CHECK(!reader.next(3, batch));
+        }
+        std::filesystem::remove(path);
+    }
+}
+
+TEST_CASE("Check if truncated binary ray input is rejected", "[BinaryRayFile]")
+{
+    const Path path = writeInput("_ig_test_rays_truncated.bin", BinaryRayLayout::AoS, InputMagic, RayCount, RayCount - 1);
+    {
+        BinaryRayReader reader;
+        CHECK(!reader.open(path));
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Check if binary ray input with unknown magic number is rejected", "[BinaryRayFile]")
+{
+    // An output file is not a valid input
+    const Path path = writeInput("_ig_test_rays_magic.bin", BinaryRayLayout::AoS, OutputMagic, RayCount, RayCount);
+    {
+        BinaryRayReader reader;
+        CHECK(!reader.open(path));
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Check if binary ray output is written in the requested layout", "[BinaryRayFile]")
+{
+    constexpr uint32 Fields = BRF_Color | BRF_Distance | BRF_EntityID;
+    REQUIRE(BinaryRayWriter::recordSize(Fields) == 5);
+    CHECK(BinaryRayWriter::recordSize(BRF_Distance) == 1);
+
+    std::vector<float> color(RayCount * 3);
+    std::vector<float> distance(RayCount);
+    std::vector<int32> entityID(RayCount);
+    for (size_t i = 0; i < RayCount; ++i) {
+        for (size_t c = 0; c < 3; ++c)
+            color[3 * i + c] = float(i + c);
+        distance[i] = float(10 * i);
+        entityID[i] = i % 2 == 0 ? (int32)i : -1;
+    }
+
+    for (auto layout : { BinaryRayLayout::AoS, BinaryRayLayout::SoA }) {
+        const Path path = std::filesystem::temp_directory_path() / "_ig_test_rays_out.bin";
+        {
+            BinaryRayWriter writer;
+            REQUIRE(writer.open(path, layout, Fields, RayCount));
+
+            // Written in two chunks, colors are scaled
+            REQUIRE(writer.write(color.data(), distance.data(), entityID.data(), 3, 0.5f));
+            REQUIRE(writer.write(color.data() + 9, distance.data() + 3, entityID.data() + 3, 2, 0.5f));
+        }
+
+        const auto bytes = readFile(path);
+        std::filesystem::remove(path);
+        REQUIRE(bytes.size() == sizeof(BinaryRayHeader) + RayCount * 5 * sizeof(float));
+
+        BinaryRayHeader header;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        CHECK(header.Magic == OutputMagic);
+        CHECK(header.Version == 1);
+        CHECK(header.Layout == (uint16)layout);
+        CHECK(header.Fields == Fields);
+        CHECK(header.RecordSize == 5);
+        CHECK(header.Count == RayCount);
+
+        const auto component = [&](size_t i, size_t c) {
+            const size_t index = layout == BinaryRayLayout::AoS ? i * 5 + c : c * RayCount + i;
+            return bytes.data() + sizeof(BinaryRayHeader) + index * sizeof(float);
+        };
+
+        for (size_t i = 0; i < RayCount; ++i) {
+            for (size_t c = 0; c < 3; ++c) {
+                float value;
+                std::memcpy(&value, component(i, c), sizeof(float));
+                CHECK(value == 0.5f * color[3 * i + c]);
+            }
+
+            float dist;
+            int32 id;
+            std::memcpy(&dist, component(i, 3), sizeof(float));
+            std::memcpy(&id, component(i, 4), sizeof(int32));
+            CHECK(dist == distance[i]);
+            CHECK(id == entityID[i]);
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#include "Image.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+using namespace IG;
+static Image generateImage(size_t width, size_t height, size_t channels)
+{
+    Image img;
+    img.width    = width;
+    img.height   = height;
+    img.channels = channels;
+    img.pixels.reset(new float[width * height * channels]);
+    for (size_t i = 0; i < width * height * channels; ++i)
+        img.pixels[i] = float(i % 7);
+    return img;
+}
+
+TEST_CASE("Check if the mip level count covers all levels", "[Image]")
+{
+    CHECK(Image::computeMipLevelCount(1, 1) == 1);
+    CHECK(Image::computeMipLevelCount(2, 1) == 2);
+    CHECK(Image::computeMipLevelCount(512, 512) == 10);
+    CHECK(Image::computeMipLevelCount(513, 3) == 10);
+    CHECK(Image::computeMipLevelCount(3, 1024) == 11);
+}
+
+TEST_CASE("Check if downsampling halves the resolution", "[Image]")
+{
+    const auto img   = generateImage(7, 4, 4);
+    const auto level = img.downsample();
+    CHECK(level.width == 3);
+    CHECK(level.height == 2);
+    CHECK(level.channels == 4);
+
+    const auto last = generateImage(1, 5, 1).downsample();
+    CHECK(last.width == 1);
+    CHECK(last.height == 2);
+}
+
+TEST_CASE("Check if downsampling preserves the average of even resolutions", "[Image]")
+{
+    const auto img   = generateImage(16, 8, 1);
+    const auto level = img.downsample();
+
+    const Vector4f a = img.computeAverage();
+    const Vector4f b = level.computeAverage();
+    CHECK((a - b).cwiseAbs().maxCoeff() <= 1e-4f);
+}
+
+TEST_CASE("Check if downsampling keeps constant images", "[Image]")
+{
+    const auto img = Image::createSolidImage(Vector4f(0.25f, 0.5f, 0.75f, 1), 5, 3);
+
+    Image level = img.downsample();
+    while (level.width > 1 || level.height > 1)
+        level = level.downsample();
+
+    CHECK(level.eval(Vector2f(0.5f, 0.5f), Image::BorderMethod::Clamp, Image::FilterMethod::Nearest).isApprox(Vector4f(0.25f, 0.5f, 0.75f, 1)));
+}
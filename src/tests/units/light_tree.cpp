@@ -0,0 +1,112 @@
+#include "light/LightTree.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <random>
+
+using namespace IG;
+static std::vector<LightTree::Entry> generateEntries(size_t count, uint32 seed)
+{
+    std::mt19937 rnd(seed);
+    std::uniform_real_distribution<float> dist(-10, 10);
+
+    std::vector<LightTree::Entry> entries;
+    for (size_t i = 0; i < count; ++i) {
+        const Vector3f center = Vector3f(dist(rnd), dist(rnd), dist(rnd));
+        const Vector3f normal = Vector3f(dist(rnd), dist(rnd), dist(rnd)).normalized();
+        const float size      = std::abs(dist(rnd)) / 10;
+
+        const LightCone cone = (i % 3 == 0) ? LightCone::Sphere() : LightCone::Hemisphere(normal);
+        entries.push_back(LightTree::Entry{ BoundingBox(center - Vector3f::Constant(size), center + Vector3f::Constant(size)), cone, std::abs(dist(rnd)), (uint32)i });
+    }
+    return entries;
+}
+
+static bool isInside(const BoundingBox& inner, const BoundingBox& outer)
+{
+    return (inner.min.array() >= outer.min.array()).all() && (inner.max.array() <= outer.max.array()).all();
+}
+
+static bool isInside(const LightCone& inner, const LightCone& outer)
+{
+    constexpr float Eps = 1e-3f;
+    const float thetaD  = std::acos(std::clamp(inner.Axis.dot(outer.Axis), -1.0f, 1.0f));
+    return outer.ThetaO >= Pi - Eps || thetaD + inner.ThetaO <= outer.ThetaO + Eps;
+}
+
+TEST_CASE("Check if the light tree bounds all lights", "[LightTree]")
+{
+    auto entries = generateEntries(1000, 42);
+
+    LightTree tree;
+    tree.build(entries);
+
+    const auto& nodes = tree.nodes();
+    REQUIRE(nodes.size() == 2 * entries.size() - 1);
+    CHECK(tree.depth() <= LightTree::MaxDepth);
+
+    for (const auto& node : nodes) {
+        if (node.isLeaf())
+            continue;
+
+        const auto& left  = nodes.at(node.leftIndex());
+        const auto& right = nodes.at(node.rightIndex());
+        CHECK(std::abs(node.Flux - left.Flux - right.Flux) <= 1e-3f * node.Flux);
+        CHECK(isInside(left.BBox, node.BBox));
+        CHECK(isInside(right.BBox, node.BBox));
+        CHECK(isInside(left.Cone, node.Cone));
+        CHECK(isInside(right.Cone, node.Cone));
+    }
+}
+
+TEST_CASE("Check if the light tree codes lead to the respective leaf", "[LightTree]")
+{
+    auto entries = generateEntries(777, 1337);
+
+    LightTree tree;
+    tree.build(entries);
+
+    const auto& nodes = tree.nodes();
+    REQUIRE(tree.codes().size() == entries.size());
+    for (uint32 id = 0; id < entries.size(); ++id) {
+        uint32 code      = tree.codes()[id];
+        const auto* node = &nodes.front();
+        while (!node->isLeaf()) {
+            node = &nodes.at((code & 0x1) == 0 ? node->leftIndex() : node->rightIndex());
+            code >>= 1;
+        }
+        CHECK(node->Index == (int32)id);
+    }
+}
+
+TEST_CASE("Check if the light tree stays within the maximum depth for coincident lights", "[LightTree]")
+{
+    std::vector<LightTree::Entry> entries;
+    for (uint32 i = 0; i < 5000; ++i)
+        entries.push_back(LightTree::Entry{ BoundingBox(Vector3f::Ones()), LightCone::Sphere(), 1, i });
+
+    LightTree tree;
+    tree.build(entries);
+
+    CHECK(tree.nodes().size() == 2 * entries.size() - 1);
+    CHECK(tree.depth() <= 13);
+}
+
+TEST_CASE("Check if the light tree separates differently oriented clusters", "[LightTree]")
+{
+    std::vector<LightTree::Entry> entries;
+    for (uint32 i = 0; i < 16; ++i) {
+        const bool up         = i % 2 == 0;
+        const Vector3f center = Vector3f(float(i / 2), 0, up ? 0.0f : 0.5f);
+        const Vector3f normal = Vector3f(0, 0, up ? 1.0f : -1.0f);
+        entries.push_back(LightTree::Entry{ BoundingBox(center), LightCone::Hemisphere(normal), 1, i });
+    }
+
+    LightTree tree;
+    tree.build(entries);
+
+    const auto& root = tree.nodes().front();
+    REQUIRE(!root.isLeaf());
+    CHECK(tree.nodes().at(root.leftIndex()).Cone.ThetaO <= 1e-3f);
+    CHECK(tree.nodes().at(root.rightIndex()).Cone.ThetaO <= 1e-3f);
+}
@@ -0,0 +1,130 @@
+#include "device/MaterialQueue.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <thread>
+#include <vector>
+
+using namespace IG;
+
+constexpr size_t Capacity       = 16;
+constexpr size_t ComponentCount = 3;
+constexpr size_t PayloadCount   = 2;
+
+// Component c of ray i, the payload components are stored after the other components
+static inline float rayComponent(size_t i, size_t c) { return float(i * 10 + c); }
+
+static size_t streamIndex(size_t i, size_t c, bool soaPayload)
+{
+    if (c < ComponentCount || soaPayload)
+        return c * Capacity + i;
+    else
+        return ComponentCount * Capacity + i * PayloadCount + (c - ComponentCount);
+}
+
+static std::vector<float> createStream(bool soaPayload)
+{
+    std::vector<float> stream((ComponentCount + PayloadCount) * Capacity, -1.0f);
+    for (size_t i = 0; i < Capacity; ++i) {
+        for (size_t c = 0; c < ComponentCount + PayloadCount; ++c)
+            stream[streamIndex(i, c, soaPayload)] = rayComponent(i, c);
+    }
+    return stream;
+}
+
+TEST_CASE("Check if queued rays keep all components", "[MaterialQueue]")
+{
+    for (bool soaPayload : { true, false }) {
+        MaterialQueue queue;
+        queue.reset(2, 3, ComponentCount, PayloadCount, soaPayload);
+        REQUIRE(queue.recordSize() == ComponentCount + PayloadCount);
+
+        const auto stream = createStream(soaPayload);
+        queue.push(1, 2, stream.data(), Capacity, 4, 7);
+        CHECK(queue.queued(0) == 0);
+        CHECK(queue.queued(1) == 3);
+        CHECK(queue.queuedEntity(2) == 3);
+        CHECK(queue.total() == 3);
+
+        // Nothing queued for other entities
+        std::vector<float> target((ComponentCount + PayloadCount) * Capacity, -1.0f);
+        CHECK(queue.pull(1, 1, target.data(), Capacity, 0, Capacity) == 0);
+
+        REQUIRE(queue.pull(1, 2, target.data(), Capacity, 10, 6) == 3);
+        CHECK(queue.total() == 0);
+        CHECK(queue.queued(1) == 0);
+        CHECK(queue.queuedEntity(2) == 0);
+
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t c = 0; c < ComponentCount + PayloadCount; ++c)
+                CHECK(target[streamIndex(10 + i, c, soaPayload)] == rayComponent(4 + i, c));
+        }
+
+        // Entries outside the pulled range are untouched
+        for (size_t c = 0; c < ComponentCount + PayloadCount; ++c) {
+            CHECK(target[streamIndex(9, c, soaPayload)] == -1.0f);
+            CHECK(target[streamIndex(13, c, soaPayload)] == -1.0f);
+        }
+    }
+}
+
+TEST_CASE("Check if rays are pulled partially", "[MaterialQueue]")
+{
+    MaterialQueue queue;
+    queue.reset(1, 1, ComponentCount, PayloadCount, true);
+
+    const auto stream = createStream(true);
+    queue.push(0, 0, stream.data(), Capacity, 0, 5);
+    queue.push(0, 0, stream.data(), Capacity, 8, 10);
+    REQUIRE(queue.total() == 7);
+
+    std::vector<float> target((ComponentCount + PayloadCount) * Capacity, -1.0f);
+    CHECK(queue.pull(0, 0, target.data(), Capacity, 0, 4) == 4);
+    CHECK(queue.queued(0) == 3);
+    CHECK(queue.pull(0, 0, target.data(), Capacity, 4, 4) == 3);
+    CHECK(queue.total() == 0);
+
+    // Every ray is pulled exactly once
+    std::vector<int> seen(Capacity, 0);
+    for (size_t i = 0; i < 7; ++i)
+        ++seen[(size_t)target[streamIndex(i, 0, true)] / 10];
+    for (size_t i = 0; i < Capacity; ++i)
+        CHECK(seen[i] == ((i < 5 || i == 8 || i == 9) ? 1 : 0));
+
+    // Reset drops all rays
+    queue.push(0, 0, stream.data(), Capacity, 0, 5);
+    queue.reset(1, 1, ComponentCount, PayloadCount, true);
+    CHECK(queue.total() == 0);
+    CHECK(queue.pull(0, 0, target.data(), Capacity, 0, Capacity) == 0);
+}
+
+TEST_CASE("Check if no rays are lost with multiple threads", "[MaterialQueue]")
+{
+    constexpr size_t ThreadCount = 4;
+    constexpr size_t Rounds      = 1000;
+
+    MaterialQueue queue;
+    queue.reset(2, 4, ComponentCount, PayloadCount, false);
+
+    std::vector<size_t> pulled(ThreadCount, 0);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < ThreadCount; ++t) {
+        threads.emplace_back([&, t]() {
+            const auto stream = createStream(false);
+            std::vector<float> target((ComponentCount + PayloadCount) * Capacity);
+            for (size_t r = 0; r < Rounds; ++r) {
+                const size_t entity = (t + r) % 4;
+                queue.push(entity / 2, entity, stream.data(), Capacity, 0, 3);
+                pulled[t] += queue.pull(entity / 2, entity, target.data(), Capacity, 0, 2);
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    size_t total = 0;
+    for (size_t t = 0; t < ThreadCount; ++t)
+        total += pulled[t];
+    CHECK(total + queue.total() == ThreadCount * Rounds * 3);
+    CHECK(queue.queued(0) + queue.queued(1) == queue.total());
+}
@@ -0,0 +1,63 @@
+#include "RayBatchQueue.h"
+#include "RuntimeStructs.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+
+using namespace IG;
+TEST_CASE("Check if a ray batch references the given rays", "[RayBatch]")
+{
+    std::vector<Ray> rays;
+    for (int i = 0; i < 4; ++i)
+        rays.push_back(Ray{ Vector3f(i, 2 * i, 3 * i), Vector3f(-i, -2 * i, -3 * i), Vector2f(i, 10 * i) });
+
+    const RayBatch batch = RayBatch::fromRays(rays.data(), rays.size());
+    REQUIRE(batch.Count == rays.size());
+
+    for (size_t i = 0; i < rays.size(); ++i) {
+        const size_t k = i * batch.Stride;
+        const size_t r = i * batch.RangeStride;
+        CHECK(batch.OriginX[k] == rays[i].Origin.x());
+        CHECK(batch.OriginY[k] == rays[i].Origin.y());
+        CHECK(batch.OriginZ[k] == rays[i].Origin.z());
+        CHECK(batch.DirectionX[k] == rays[i].Direction.x());
+        CHECK(batch.DirectionY[k] == rays[i].Direction.y());
+        CHECK(batch.DirectionZ[k] == rays[i].Direction.z());
+        CHECK(batch.TMin[r] == rays[i].Range.x());
+        CHECK(batch.TMax[r] == rays[i].Range.y());
+    }
+
+    CHECK(RayBatch::fromRays(nullptr, 0).Count == 0);
+}
+
+TEST_CASE("Check if the ray batch queue runs jobs in submission order", "[RayBatch]")
+{
+    constexpr int JobCount = 64;
+
+    std::vector<int> order;
+    std::vector<std::future<bool>> futures;
+    {
+        RayBatchQueue queue;
+        for (int i = 0; i < JobCount; ++i)
+            futures.emplace_back(queue.submit([&order, i]() { order.push_back(i); return i % 2 == 0; }));
+
+        for (int i = 0; i < JobCount; ++i)
+            CHECK(futures[i].get() == (i % 2 == 0));
+    }
+
+    REQUIRE(order.size() == JobCount);
+    for (int i = 0; i < JobCount; ++i)
+        CHECK(order[i] == i);
+}
+
+TEST_CASE("Check if the ray batch queue finishes pending jobs on destruction", "[RayBatch]")
+{
+    std::atomic<int> count = 0;
+    {
+        RayBatchQueue queue;
+        for (int i = 0; i < 16; ++i)
+            (void)queue.submit([&count]() { ++count; return true; });
+    }
+    CHECK(count == 16);
+}
@@ -0,0 +1,154 @@
+#include "table/SceneBlob.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstring>
+#include <fstream>
+
+using namespace IG;
+
+constexpr const char* Key = "scene_hash";
+
+static SceneDatabase createDatabase()
+{
+    SceneDatabase database;
+
+    auto& dyn = database.DynTables["shapes"];
+    for (uint32 i = 0; i < 3; ++i) {
+        auto& data = dyn.addLookup(i, 2 * i, 16);
+        for (uint32 k = 0; k <= i; ++k)
+            data.push_back((uint8)(10 * i + k));
+    }
+
+    // Large enough to span multiple pages
+    auto& fix   = database.FixTables["entities"];
+    uint8* data = fix.addEntries(1000, 8);
+    for (size_t i = 0; i < 1000 * 8; ++i)
+        data[i] = (uint8)(i % 251);
+
+    return database;
+}
+
+static SceneBlob::Content createContent()
+{
+    SceneBlob::Content content;
+    content.DynTables = { "shapes" };
+    content.FixTables = { "entities" };
+    content.UserData  = { 1, 2, 3, 4, 5 };
+    return content;
+}
+
+static void checkTableData(const uint8* a, const uint8* b, size_t size)
+{
+    CHECK(std::memcmp(a, b, size) == 0);
+}
+
+static bool saveBlob(const Path& path)
+{
+    return SceneBlob::save(path, Key, createDatabase(), createContent());
+}
+
+TEST_CASE("Check if a scene blob is loaded as saved", "[SceneBlob]")
+{
+    const Path path = std::filesystem::temp_directory_path() / "_ig_test_scene_blob.bin";
+    REQUIRE(saveBlob(path));
+    CHECK(!std::filesystem::exists(Path(path).concat(".tmp")));
+
+    const SceneDatabase expected = createDatabase();
+    {
+        SceneDatabase database;
+        SceneBlob::Content content;
+        REQUIRE(SceneBlob::load(path, Key, database, content));
+
+        CHECK(content.DynTables == createContent().DynTables);
+        CHECK(content.FixTables == createContent().FixTables);
+        CHECK(content.UserData == createContent().UserData);
+
+        const auto& dyn         = database.DynTables.at("shapes");
+        const auto& expectedDyn = expected.DynTables.at("shapes");
+        CHECK(dyn.isView());
+        REQUIRE(dyn.entryCount() == 3);
+        REQUIRE(dyn.currentOffset() == expectedDyn.currentOffset());
+        for (size_t i = 0; i < 3; ++i) {
+            CHECK(dyn.lookups()[i].TypeID == expectedDyn.lookups()[i].TypeID);
+            CHECK(dyn.lookups()[i].Flags == expectedDyn.lookups()[i].Flags);
+            CHECK(dyn.lookups()[i].Offset == expectedDyn.lookups()[i].Offset);
+        }
+        checkTableData(dyn.data(), expectedDyn.data(), dyn.currentOffset());
+
+        const auto& fix         = database.FixTables.at("entities");
+        const auto& expectedFix = expected.FixTables.at("entities");
+        CHECK(fix.isView());
+        CHECK(fix.entryCount() == 1000);
+        REQUIRE(fix.currentOffset() == expectedFix.currentOffset());
+        checkTableData(fix.data(), expectedFix.data(), fix.currentOffset());
+
+        // The tables are mapped, therefore they are aligned to pages
+        CHECK((reinterpret_cast<uintptr_t>(fix.data()) % 4096) == 0);
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Check if a scene blob with a different key is rejected", "[SceneBlob]")
+{
+    const Path path = std::filesystem::temp_directory_path() / "_ig_test_scene_blob_key.bin";
+    REQUIRE(saveBlob(path));
+    {
+        SceneDatabase database;
+        SceneBlob::Content content;
+        CHECK(!SceneBlob::load(path, "other_hash", database, content));
+        CHECK(!SceneBlob::load(path, "scene_has", database, content));
+        CHECK(database.DynTables.empty());
+        CHECK(database.FixTables.empty());
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Check if a scene blob with a different version is rejected", "[SceneBlob]")
+{
+    const Path path = std::filesystem::temp_directory_path() / "_ig_test_scene_blob_version.bin";
+    REQUIRE(saveBlob(path));
+    {
+        // The version follows the magic number
+        std::fstream stream(path, std::ios::in | std::ios::out | std::ios::binary);
+        const uint32 version = SceneBlob::Version + 1;
+        stream.seekp(sizeof(uint32));
+        stream.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    }
+    {
+        SceneDatabase database;
+        SceneBlob::Content content;
+        CHECK(!SceneBlob::load(path, Key, database, content));
+        CHECK(database.DynTables.empty());
+        CHECK(database.FixTables.empty());
+    }
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Check if a truncated scene blob is rejected", "[SceneBlob]")
+{
+    const Path path = std::filesystem::temp_directory_path() / "_ig_test_scene_blob_truncated.bin";
+    REQUIRE(saveBlob(path));
+
+    const size_t size = std::filesystem::file_size(path);
+
+    // Cut off the user data at the end, the header and the section table are still intact
+    std::filesystem::resize_file(path, size - 100);
+    {
+        SceneDatabase database;
+        SceneBlob::Content content;
+        CHECK(!SceneBlob::load(path, Key, database, content));
+        CHECK(database.DynTables.empty());
+        CHECK(database.FixTables.empty());
+    }
+
+    // Not even the header is left
+    std::filesystem::resize_file(path, 8);
+    {
+        SceneDatabase database;
+        SceneBlob::Content content;
+        CHECK(!SceneBlob::load(path, Key, database, content));
+    }
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,171 @@
+#include "device/SplatFilm.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <numeric>
+#include <random>
+#include <vector>
+
+using namespace IG;
+
+// Not a multiple of the tile size to check the border tiles
+constexpr size_t Width  = 150;
+constexpr size_t Height = 70;
+
+static void splat_chunk(SplatFilm& film, size_t chunk, std::vector<float>* expected)
+{
+    for (size_t y = chunk % 3; y < Height; y += 3) {
+        for (size_t x = chunk % 7; x < Width; x += 7) {
+            // Values which do not sum up exactly in floating point arithmetic
+            const float rgb[3] = { 0.1f * float(x + chunk), 0.3f * float(y), 1.0f / float(chunk + 1) };
+            film.splat(chunk, x, y, rgb);
+            if (expected) {
+                for (size_t i = 0; i < 3; ++i)
+                    (*expected)[(y * Width + x) * 3 + i] += rgb[i];
+            }
+        }
+    }
+}
+
+TEST_CASE("Check if splats are merged into the film", "[SplatFilm]")
+{
+    SplatFilm film;
+    film.resize(Width, Height);
+    REQUIRE(film.tileCount() == 3 * 2);
+
+    film.beginPass({ 0, 1 });
+
+    std::vector<float> expected(Width * Height * 3, 1.0f);
+    std::vector<float> target(Width * Height * 3, 1.0f);
+    splat_chunk(film, 0, &expected);
+    film.finishChunk(0);
+    splat_chunk(film, 1, &expected);
+    film.endPass();
+
+    film.merge(target.data());
+    for (size_t i = 0; i < target.size(); ++i)
+        CHECK_THAT(target[i], Catch::Matchers::WithinRel(expected[i]));
+
+    // Merged splats are cleared
+    const std::vector<float> merged = target;
+    film.merge(target.data());
+    CHECK(target == merged);
+}
+
+TEST_CASE("Check if the result does not depend on the order the chunks are finished in", "[SplatFilm]")
+{
+    constexpr size_t ChunkCount = 8;
+
+    std::vector<int32> order(ChunkCount);
+    std::iota(order.begin(), order.end(), 0);
+
+    // All chunks touch all six tiles and many pixels repeatedly
+    SplatFilm a;
+    a.resize(Width, Height);
+    a.beginPass(order);
+    for (size_t c = 0; c < ChunkCount; ++c) {
+        splat_chunk(a, c, nullptr);
+        a.finishChunk(c);
+    }
+    a.endPass();
+
+    // Interleaved and finished in reverse, as it might happen with multiple threads
+    SplatFilm b;
+    b.resize(Width, Height);
+    b.beginPass(order);
+    for (size_t c = 0; c < ChunkCount; c += 2) {
+        splat_chunk(b, c + 1, nullptr);
+        splat_chunk(b, c, nullptr);
+    }
+    for (size_t c = ChunkCount; c > 0; --c)
+        b.finishChunk(c - 1);
+    b.endPass();
+
+    std::vector<float> filmA(Width * Height * 3, 0.0f);
+    std::vector<float> filmB(Width * Height * 3, 0.0f);
+    a.merge(filmA.data());
+    b.merge(filmB.data());
+    CHECK(filmA == filmB);
+}
+
+TEST_CASE("Check if unfinished chunks are committed at the end of the pass", "[SplatFilm]")
+{
+    SplatFilm film;
+    film.resize(128, 128);
+    film.beginPass({ 1, 0 });
+
+    const float rgb[3] = { 1.0f, 2.0f, 3.0f };
+    film.splat(0, 100, 10, rgb);
+    film.splat(1, 100, 10, rgb);
+
+    // Chunk 1 comes first, therefore nothing can be committed yet
+    film.finishChunk(0);
+    std::vector<float> target(128 * 128 * 3, 0.0f);
+    film.merge(target.data());
+    CHECK(target[(10 * 128 + 100) * 3 + 0] == 0.0f);
+
+    film.endPass();
+    film.merge(target.data());
+    CHECK(target[(10 * 128 + 100) * 3 + 0] == 2.0f);
+    CHECK(target[(10 * 128 + 100) * 3 + 1] == 4.0f);
+    CHECK(target[(10 * 128 + 100) * 3 + 2] == 6.0f);
+}
+
+TEST_CASE("Check if scattered splats only cost memory per touched pixel", "[SplatFilm]")
+{
+    constexpr size_t FilmWidth      = 1920;
+    constexpr size_t FilmHeight     = 1080;
+    constexpr size_t ChunkCount     = 8;
+    constexpr size_t SplatsPerChunk = 64 * 64 * 3;
+
+    std::vector<int32> order(ChunkCount);
+    std::iota(order.begin(), order.end(), 0);
+
+    SplatFilm film;
+    film.resize(FilmWidth, FilmHeight);
+    film.beginPass(order);
+
+    // Light tracer like splats to random pixels all over the film
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> pixelDist(0, FilmWidth * FilmHeight - 1);
+    std::vector<std::vector<std::pair<size_t, float>>> splats(ChunkCount);
+    for (size_t c = 0; c < ChunkCount; ++c) {
+        for (size_t i = 0; i < SplatsPerChunk; ++i)
+            splats[c].emplace_back(pixelDist(rng), float(i % 7 + c));
+    }
+
+    // The first chunk in order finishes last, therefore all other chunks have to wait
+    for (size_t c = ChunkCount; c > 0; --c) {
+        for (const auto& [pixel, value] : splats[c - 1]) {
+            const float rgb[3] = { value, 2 * value, 3 * value };
+            film.splat(c - 1, pixel, rgb);
+        }
+
+        if (c > 1)
+            film.finishChunk(c - 1);
+    }
+
+    // Only the touched pixels are kept, with a load factor of at least a quarter
+    const size_t pending = film.pendingBytes();
+    CHECK(pending > 0);
+    CHECK(pending <= ChunkCount * SplatsPerChunk * 4 * 16);
+
+    film.finishChunk(0);
+    CHECK(film.pendingBytes() == 0);
+    film.endPass();
+
+    std::vector<float> expected(FilmWidth * FilmHeight * 3, 0.0f);
+    for (size_t c = 0; c < ChunkCount; ++c) {
+        for (const auto& [pixel, value] : splats[c]) {
+            expected[pixel * 3 + 0] += value;
+            expected[pixel * 3 + 1] += 2 * value;
+            expected[pixel * 3 + 2] += 3 * value;
+        }
+    }
+
+    // All values are small integers, therefore the sums are exact
+    std::vector<float> target(FilmWidth * FilmHeight * 3, 0.0f);
+    film.merge(target.data());
+    CHECK(target == expected);
+}
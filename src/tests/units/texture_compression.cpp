@@ -0,0 +1,158 @@
+#include "TextureCompression.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <random>
+
+using namespace IG;
+static std::vector<uint8> generateGradient(size_t width, size_t height, size_t channels, bool opaque)
+{
+    std::vector<uint8> packed(width * height * channels);
+    for (size_t y = 0; y < height; ++y) {
+        for (size_t x = 0; x < width; ++x) {
+            uint8* texel = packed.data() + (y * width + x) * channels;
+            texel[0]     = (uint8)(255 * x / std::max<size_t>(1, width - 1));
+            if (channels == 4) {
+                texel[1] = (uint8)(255 * y / std::max<size_t>(1, height - 1));
+                texel[2] = (uint8)((x * 7 + y * 3) % 256);
+                texel[3] = opaque ? 255 : (uint8)(255 - texel[0]);
+            }
+        }
+    }
+    return packed;
+}
+
+static double computeRMSE(const std::vector<uint8>& a, const std::vector<uint8>& b)
+{
+    double sum = 0;
+    for (size_t i = 0; i < a.size(); ++i)
+        sum += ((double)a[i] - (double)b[i]) * ((double)a[i] - (double)b[i]);
+    return std::sqrt(sum / (double)a.size());
+}
+
+TEST_CASE("Check if the block format depends on the alpha channel", "[TextureCompression]")
+{
+    // The steep gradients of the small image would fail the quality check
+    std::vector<uint8> blocks;
+    CHECK(TextureCompression::compressBlocks(generateGradient(8, 8, 4, true).data(), 8, 8, 4, blocks, 0.0f) == TextureCompression::BlockFormat::BC1);
+    CHECK(blocks.size() == 4 * 8);
+    CHECK(TextureCompression::compressBlocks(generateGradient(8, 8, 4, false).data(), 8, 8, 4, blocks, 0.0f) == TextureCompression::BlockFormat::BC3);
+    CHECK(blocks.size() == 4 * 16);
+    CHECK(TextureCompression::compressBlocks(generateGradient(8, 8, 1, true).data(), 8, 8, 1, blocks) == TextureCompression::BlockFormat::BC4);
+    CHECK(blocks.size() == 4 * 8);
+}
+
+TEST_CASE("Check if block compression approximates the image", "[TextureCompression]")
+{
+    for (size_t channels : { 1, 4 }) {
+        for (bool opaque : { true, false }) {
+            const auto packed = generateGradient(37, 21, channels, opaque);
+
+            std::vector<uint8> blocks;
+            const auto format = TextureCompression::compressBlocks(packed.data(), 37, 21, channels, blocks, 0.0f);
+            CHECK(blocks.size() == 10 * 6 * TextureCompression::blockSize(format));
+
+            std::vector<uint8> decoded;
+            TextureCompression::decompressBlocks(blocks.data(), 37, 21, format, decoded);
+            REQUIRE(decoded.size() == packed.size());
+            CHECK(computeRMSE(packed, decoded) < 8);
+        }
+    }
+}
+
+TEST_CASE("Check if constant blocks are reproduced exactly", "[TextureCompression]")
+{
+    std::vector<uint8> packed(16 * 4);
+    for (size_t i = 0; i < 16; ++i) {
+        packed[4 * i + 0] = 255;
+        packed[4 * i + 1] = 0;
+        packed[4 * i + 2] = 255;
+        packed[4 * i + 3] = 255;
+    }
+
+    std::vector<uint8> blocks;
+    const auto format = TextureCompression::compressBlocks(packed.data(), 4, 4, 4, blocks);
+
+    std::vector<uint8> decoded;
+    TextureCompression::decompressBlocks(blocks.data(), 4, 4, format, decoded);
+    CHECK(decoded == packed);
+}
+
+TEST_CASE("Check if images without blue use two channel blocks", "[TextureCompression]")
+{
+    auto packed = generateGradient(37, 21, 4, true);
+    for (size_t i = 0; i < 37 * 21; ++i)
+        packed[4 * i + 2] = 0;
+
+    std::vector<uint8> blocks;
+    const auto format = TextureCompression::compressBlocks(packed.data(), 37, 21, 4, blocks);
+    REQUIRE(format == TextureCompression::BlockFormat::BC5);
+    CHECK(blocks.size() == 10 * 6 * 16);
+
+    std::vector<uint8> decoded;
+    TextureCompression::decompressBlocks(blocks.data(), 37, 21, format, decoded);
+    REQUIRE(decoded.size() == packed.size());
+    CHECK(computeRMSE(packed, decoded) < 2);
+    for (size_t i = 0; i < 37 * 21; ++i) {
+        CHECK(decoded[4 * i + 2] == 0);
+        CHECK(decoded[4 * i + 3] == 255);
+    }
+}
+
+TEST_CASE("Check if color blocks failing the quality check are stored uncompressed", "[TextureCompression]")
+{
+    // Uncorrelated noise is the worst case for the two endpoint palette
+    std::mt19937 rnd(42);
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::vector<uint8> packed(16 * 16 * 4);
+    for (size_t i = 0; i < 16 * 16; ++i) {
+        for (size_t c = 0; c < 3; ++c)
+            packed[4 * i + c] = (uint8)dist(rnd);
+        packed[4 * i + 3] = 255;
+    }
+
+    std::vector<uint8> blocks;
+    CHECK(TextureCompression::compressBlocks(packed.data(), 16, 16, 4, blocks, 0.0f) == TextureCompression::BlockFormat::BC1);
+    CHECK(TextureCompression::compressBlocks(generateGradient(256, 256, 4, true).data(), 256, 256, 4, blocks) == TextureCompression::BlockFormat::BC1);
+
+    const auto format = TextureCompression::compressBlocks(packed.data(), 16, 16, 4, blocks);
+    REQUIRE(format == TextureCompression::BlockFormat::RGBA8);
+    CHECK(blocks.size() == 4 * 4 * 64);
+
+    std::vector<uint8> decoded;
+    TextureCompression::decompressBlocks(blocks.data(), 16, 16, format, decoded);
+    CHECK(decoded == packed);
+}
+
+TEST_CASE("Check if half floats round trip", "[TextureCompression]")
+{
+    CHECK(TextureCompression::floatToHalf(0.0f) == 0x0000);
+    CHECK(TextureCompression::floatToHalf(1.0f) == 0x3C00);
+    CHECK(TextureCompression::floatToHalf(-2.0f) == 0xC000);
+    CHECK(TextureCompression::floatToHalf(TextureCompression::HalfMax) == 0x7BFF);
+    CHECK(TextureCompression::floatToHalf(1e6f) == 0x7BFF);
+    CHECK(TextureCompression::floatToHalf(std::ldexp(1.0f, -24)) == 0x0001);
+
+    std::mt19937 rnd(42);
+    std::uniform_real_distribution<float> dist(-100, 100);
+    for (size_t i = 0; i < 1000; ++i) {
+        const float value = dist(rnd);
+        const float half  = TextureCompression::halfToFloat(TextureCompression::floatToHalf(value));
+        CHECK(std::abs(half - value) <= std::abs(value) * 1e-3f);
+    }
+
+    for (uint32 bits = 0; bits < 0x7C00; ++bits)
+        CHECK(TextureCompression::floatToHalf(TextureCompression::halfToFloat((uint16)bits)) == bits);
+}
+
+TEST_CASE("Check if half conversion pads and counts clamped values", "[TextureCompression]")
+{
+    const std::vector<float> values = { 1, 1e5f, -1e5f };
+
+    std::vector<uint16> halfs;
+    CHECK(TextureCompression::convertToHalf(values.data(), values.size(), halfs) == 2);
+    CHECK(halfs.size() == 4);
+    CHECK(halfs[0] == 0x3C00);
+    CHECK(halfs[3] == 0);
+}
@@ -0,0 +1,174 @@
+#include "Image.h"
+#include "device/TexturePageCache.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <filesystem>
+#include <thread>
+
+using namespace IG;
+static Image generateImage(size_t width, size_t height, size_t channels)
+{
+    Image img;
+    img.width    = width;
+    img.height   = height;
+    img.channels = channels;
+    img.pixels.reset(new float[width * height * channels]);
+    for (size_t i = 0; i < width * height * channels; ++i)
+        img.pixels[i] = float(i);
+    return img;
+}
+
+static Path writeImage(const Image& img, const std::string& name, size_t tileSize)
+{
+    const Path path = std::filesystem::temp_directory_path() / name;
+    TexturePageCache::writeTiledImage(img, path, tileSize);
+    return path;
+}
+
+TEST_CASE("Check if tiles contain the pixels of the image", "[TexturePageCache]")
+{
+    const auto img  = generateImage(37, 21, 4);
+    const auto path = writeImage(img, "ig_test_tiled_rgba.bin", 8);
+
+    TexturePageCache cache(1024 * 1024);
+    const int32 handle = cache.registerImage(path);
+    REQUIRE(handle >= 0);
+
+    const auto& info = cache.info(handle);
+    CHECK(info.Width == 37);
+    CHECK(info.Height == 21);
+    CHECK(info.Channels == 4);
+    REQUIRE(info.tileCount() == 5 * 3);
+
+    for (size_t y = 0; y < img.height; ++y) {
+        for (size_t x = 0; x < img.width; ++x) {
+            TexturePageCache::Access access;
+            const float* tile = cache.request(handle, (y / 8) * info.tileCountX() + x / 8, access);
+            for (size_t c = 0; c < 4; ++c)
+                CHECK(tile[((y % 8) * 8 + x % 8) * 4 + c] == img.pixels[(y * img.width + x) * 4 + c]);
+        }
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Check if tiles are only read once", "[TexturePageCache]")
+{
+    const auto img  = generateImage(16, 16, 1);
+    const auto path = writeImage(img, "ig_test_tiled_mono.bin", 8);
+
+    TexturePageCache cache(1024 * 1024);
+    const int32 handle = cache.registerImage(path);
+    REQUIRE(handle >= 0);
+
+    TexturePageCache::Access access;
+    (void)cache.request(handle, 3, access);
+    CHECK(access == TexturePageCache::Access::Miss);
+    (void)cache.request(handle, 3, access);
+    CHECK(access == TexturePageCache::Access::Repeated);
+
+    // Only the first request in a frame is counted as hit
+    cache.beginFrame();
+    (void)cache.request(handle, 3, access);
+    CHECK(access == TexturePageCache::Access::Hit);
+    (void)cache.request(handle, 3, access);
+    CHECK(access == TexturePageCache::Access::Repeated);
+    CHECK(cache.residentBytes() == 8 * 8 * sizeof(float));
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Check if the budget is met in between frames", "[TexturePageCache]")
+{
+    const auto img  = generateImage(64, 64, 1);
+    const auto path = writeImage(img, "ig_test_tiled_budget.bin", 8);
+
+    constexpr size_t TileBytes = 8 * 8 * sizeof(float);
+    TexturePageCache cache(4 * TileBytes);
+    const int32 handle = cache.registerImage(path);
+    REQUIRE(handle >= 0);
+
+    // Tiles used in the current frame are not evicted, even if the budget is exceeded
+    TexturePageCache::Access access;
+    for (size_t i = 0; i < 8; ++i)
+        (void)cache.request(handle, i, access);
+    CHECK(cache.residentBytes() == 8 * TileBytes);
+    CHECK(cache.evictionCount() == 0);
+
+    // The least recently used tiles are evicted at the beginning of the next frame
+    cache.beginFrame();
+    CHECK(cache.residentBytes() == 4 * TileBytes);
+    CHECK(cache.evictionCount() == 4);
+
+    (void)cache.request(handle, 0, access);
+    CHECK(access == TexturePageCache::Access::Miss);
+    (void)cache.request(handle, 7, access);
+    CHECK(access == TexturePageCache::Access::Hit);
+
+    // Tiles not used in the current frame are evicted on demand
+    for (size_t i = 8; i < 12; ++i)
+        (void)cache.request(handle, i, access);
+    CHECK(cache.residentBytes() == 6 * TileBytes);
+    CHECK(cache.evictionCount() == 7);
+    CHECK(cache.peakBytes() == 8 * TileBytes);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("Check if resident images are not evicted", "[TexturePageCache]")
+{
+    const auto img = generateImage(20, 10, 4);
+
+    // No budget at all, every tile read from a file would be evicted
+    TexturePageCache cache(0);
+    const int32 handle = cache.registerResidentImage(img, 8);
+    REQUIRE(handle >= 0);
+    REQUIRE(cache.info(handle).tileCount() == 3 * 2);
+
+    TexturePageCache::Access access;
+    const float* tile = cache.request(handle, 5, access);
+    CHECK(access == TexturePageCache::Access::Hit);
+    CHECK(tile[0] == img.pixels[(8 * img.width + 16) * 4]);
+    CHECK(tile[(1 * 8 + 3) * 4 + 2] == img.pixels[(9 * img.width + 19) * 4 + 2]);
+    CHECK(tile[(1 * 8 + 4) * 4] == 0.0f); // Padding
+
+    cache.beginFrame();
+    cache.beginFrame();
+    (void)cache.request(handle, 5, access);
+    CHECK(access == TexturePageCache::Access::Hit);
+    CHECK(cache.residentBytes() == 0);
+}
+
+TEST_CASE("Check if concurrent requests return valid tiles", "[TexturePageCache]")
+{
+    const auto img  = generateImage(256, 256, 1);
+    const auto path = writeImage(img, "ig_test_tiled_concurrent.bin", 16);
+
+    TexturePageCache cache(8 * 16 * 16 * sizeof(float));
+    const int32 handle = cache.registerImage(path);
+    REQUIRE(handle >= 0);
+
+    std::atomic<size_t> errors{ 0 };
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t]() {
+            for (size_t i = 0; i < 256 * 256; ++i) {
+                const size_t x = (i * 7 + t * 13) % 256;
+                const size_t y = (i * 3 + t * 5) % 256;
+                TexturePageCache::Access access;
+                const float* tile = cache.request(handle, (y / 16) * 16 + x / 16, access);
+                if (tile[(y % 16) * 16 + x % 16] != img.pixels[y * 256 + x])
+                    ++errors;
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    CHECK(errors == 0);
+    cache.beginFrame();
+    CHECK(cache.residentBytes() <= cache.budget());
+
+    std::filesystem::remove(path);
+}